@@ -0,0 +1,27 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+#include <cstdint>
+
+// 堆分配检查钩子
+// 定义 UART_ALLOC_GUARD（Debug构建默认开启）时替换全局 operator new，
+// 统计当前线程在"布防"期间发生的堆分配次数，用于断言实时模式的稳态主循环不分配内存。
+// 未定义时所有接口都是空操作。
+namespace alloc_guard {
+
+// 是否编译了分配钩子
+bool available();
+
+// 开始/停止统计当前线程的分配
+void arm();
+void disarm();
+
+// 自上次 arm() 以来当前线程的分配次数
+uint64_t allocations();
+
+// 报告一次稳态分配违规（打印并在Debug构建中断言失败）
+void reportViolation(uint64_t count, uint64_t iteration);
+
+} // namespace alloc_guard
+
+#endif // ALLOC_GUARD_H
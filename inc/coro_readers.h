@@ -0,0 +1,22 @@
+#ifndef CORO_READERS_H
+#define CORO_READERS_H
+
+#include "coro_scheduler.h"
+
+class UartReader;
+class SerialScreenProtocol;
+
+// 协程版本的协议读取循环：每个串口一个协程，全部运行在同一个 Scheduler 线程上。
+// 读到的字节交给与阻塞主循环相同的解码路径（UartReader::feed / SerialScreenProtocol::feed），
+// 协程里不再单独寻找帧头。
+// 串口断开时协程负责调用 maintainConnection() 按退避时间重连，重连后继续读取。
+
+// 电流功率串口：到达的字节交给 UartReader 的多协议分流器解码
+Task<void> runCurrentPowerReader(Scheduler& scheduler, UartReader& reader);
+
+// 串口屏串口：到达的字节交给 SerialScreenProtocol::feed() 解码按键帧和波形透传应答；
+// 每次连接期间另起一个写协程，用 co_await port.write() 写出命令和波形点
+// （调用前需 setExternalTransmit(true)）
+Task<void> runSerialScreenReader(Scheduler& scheduler, SerialScreenProtocol& screen);
+
+#endif // CORO_READERS_H
@@ -0,0 +1,309 @@
+#ifndef CORO_SCHEDULER_H
+#define CORO_SCHEDULER_H
+
+#include <coroutine>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// 基于C++20协程的单线程异步I/O
+//
+// Task<T>      惰性协程任务，可以被 co_await，也可以交给 Scheduler::spawn 独立运行
+// Scheduler    单线程调度器：epoll 等待文件描述符就绪，最小堆管理超时，就绪队列恢复协程
+// AsyncPort    包装一个串口文件描述符，提供 co_await readExact / write
+//
+// 每个串口只是一个挂起的协程帧，不需要为每个串口创建线程。
+// ---------------------------------------------------------------------------
+
+class Scheduler;
+
+template<typename T>
+class Task;
+
+namespace coro_detail {
+
+// 协程结束时：有等待者则对称转移到等待者，否则挂起等待调度器回收
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+        auto continuation = h.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const noexcept { std::terminate(); }
+};
+
+template<typename T>
+struct TaskPromise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T v) { value = std::move(v); }
+    T result() { return std::move(*value); }
+};
+
+template<>
+struct TaskPromise<void> : PromiseBase {
+    Task<void> get_return_object();
+    void return_void() const noexcept {}
+    void result() const noexcept {}
+};
+
+} // namespace coro_detail
+
+template<typename T = void>
+class Task {
+public:
+    using promise_type = coro_detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(handle_type h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool done() const { return !handle || handle.done(); }
+
+    // co_await 子任务：启动子任务，完成后恢复当前协程
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            handle_type handle;
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle};
+    }
+
+private:
+    friend class Scheduler;
+    handle_type handle = nullptr;
+
+    handle_type release() { return std::exchange(handle, nullptr); }
+};
+
+namespace coro_detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace coro_detail
+
+// 可以挂在调度器定时器上的等待者
+struct TimerWaiter {
+    std::coroutine_handle<> handle;
+    uint64_t generation = 0;            // 每次完成或取消后递增，使旧的定时器条目失效
+    void (*on_timeout)(TimerWaiter*) = nullptr;
+    void* context = nullptr;
+};
+
+class AsyncPort;
+
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Scheduler();
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    bool isValid() const { return epoll_fd >= 0; }
+
+    // 独立运行一个任务，任务帧由调度器持有直到结束
+    void spawn(Task<void> task);
+
+    // 运行事件循环，直到 stop() 或所有任务结束
+    void run();
+    void stop() { running = false; }
+    bool isRunning() const { return running; }
+
+    // 处理一轮事件，最多等待 max_wait_ms（-1 为无限等待）
+    void runOnce(int max_wait_ms);
+
+    size_t taskCount() const { return tasks.size(); }
+
+    // co_await scheduler.sleep(ms)
+    auto sleep(int ms) {
+        struct SleepAwaiter {
+            Scheduler& scheduler;
+            int ms;
+            TimerWaiter waiter;
+            bool await_ready() const noexcept { return ms <= 0; }
+            void await_suspend(std::coroutine_handle<> h) {
+                waiter.handle = h;
+                waiter.on_timeout = &SleepAwaiter::onTimeout;
+                waiter.context = this;
+                scheduler.addTimer(Clock::now() + std::chrono::milliseconds(ms), &waiter);
+            }
+            void await_resume() const noexcept {}
+            static void onTimeout(TimerWaiter* w) {
+                auto* self = static_cast<SleepAwaiter*>(w->context);
+                self->scheduler.schedule(w->handle);
+            }
+        };
+        return SleepAwaiter{*this, ms, {}};
+    }
+
+    // 以下接口供 AsyncPort 等I/O原语使用
+    void schedule(std::coroutine_handle<> h);
+    void addTimer(Clock::time_point deadline, TimerWaiter* waiter);
+    void removeTimers(TimerWaiter* waiter);
+    bool watch(int fd, AsyncPort* port);
+    void unwatch(int fd);
+
+private:
+    struct TimerEntry {
+        Clock::time_point deadline;
+        TimerWaiter* waiter;
+        uint64_t generation;
+    };
+    struct TimerLater {
+        bool operator()(const TimerEntry& a, const TimerEntry& b) const { return a.deadline > b.deadline; }
+    };
+
+    int epoll_fd;
+    bool running;
+    std::vector<Task<void>::handle_type> tasks;
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> ready_swap;
+    std::vector<TimerEntry> timers;     // 最小堆
+
+    int nextTimeoutMs(int max_wait_ms) const;
+    void fireTimers();
+    void resumeReady();
+    void reapTasks();
+};
+
+// co_await port.readExact(...) 的等待体
+struct ReadOperation {
+    AsyncPort* port;
+    uint8_t* buffer;
+    size_t n;
+    int timeout_ms;
+    size_t got = 0;
+    std::coroutine_handle<> handle;
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> h);
+    int await_resume() const;
+};
+
+// co_await port.write(...) 的等待体
+struct WriteOperation {
+    AsyncPort* port;
+    const uint8_t* data;
+    size_t length;
+    size_t written = 0;
+    bool failed = false;
+    WriteOperation* next = nullptr;
+    std::coroutine_handle<> handle;
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> h);
+    int await_resume() const;
+};
+
+// 异步串口：readExact 在读满 n 字节、超时或出错时恢复协程；write 在全部写出或出错时恢复协程
+class AsyncPort {
+public:
+    // fd 由调用者（UartReader/SerialScreenProtocol）持有，AsyncPort 不负责关闭
+    AsyncPort(Scheduler& scheduler, int fd, size_t rx_capacity = 4096);
+    ~AsyncPort();
+
+    AsyncPort(const AsyncPort&) = delete;
+    AsyncPort& operator=(const AsyncPort&) = delete;
+
+    bool isValid() const { return registered; }
+    bool hasError() const { return error; }
+    int getFileDescriptor() const { return fd; }
+
+    // co_await port.readExact(buf, n, timeout_ms)
+    // 返回实际读到的字节数（超时时小于n），出错返回-1；timeout_ms<0 表示不超时，0 表示只取已到达的数据
+    ReadOperation readExact(uint8_t* buffer, size_t n, int timeout_ms) {
+        return ReadOperation{this, buffer, n, timeout_ms, 0, {}};
+    }
+
+    // co_await port.write(buf, len)：全部写出或出错后恢复，返回写出的字节数或-1
+    // 内核发送缓冲区满时挂起等待 EPOLLOUT；data 在恢复之前必须保持有效
+    WriteOperation write(const uint8_t* data, size_t length) {
+        return WriteOperation{this, data, length, 0, false, nullptr, {}};
+    }
+
+    // 连接结束（串口已被持有方关闭）时调用：挂起的读写操作以错误返回
+    void cancel();
+
+    // 由调度器在 epoll 事件到来时调用
+    void onReadable();
+    void onWritable();
+    void onError();
+
+private:
+    friend struct ReadOperation;
+    friend struct WriteOperation;
+
+    Scheduler& scheduler;
+    int fd;
+    bool registered;
+    bool error;
+
+    // 接收缓冲区：[rx_head, rx_tail) 为有效数据
+    std::vector<uint8_t> rx;
+    size_t rx_head;
+    size_t rx_tail;
+
+    // 当前挂起的读操作（同一时刻只允许一个读者）
+    ReadOperation* pending_read;
+    TimerWaiter read_waiter;
+
+    // 挂起的写操作队列（侵入式链表，保证写入顺序）
+    WriteOperation* write_head;
+    WriteOperation* write_tail;
+
+    void fillFromFd();
+    size_t take(uint8_t* buffer, size_t n);
+    size_t writeSome(const uint8_t* data, size_t length);
+    void tryCompleteRead();
+    void progressWrites();
+    static void onReadTimeout(TimerWaiter* waiter);
+};
+
+#endif // CORO_SCHEDULER_H
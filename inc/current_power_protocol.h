@@ -2,7 +2,8 @@
 #define CURRENT_POWER_PROTOCOL_H
 
 #include "protocol.h"
-#include <libserialport.h>
+#include "transport.h"
+#include "frame_sequence.h"
 #include <functional>
 
 // 电流功率协议类
@@ -12,6 +13,13 @@ private:
     
     // 回调函数类型
     std::function<void(float, float)> currentPowerCallback;
+    
+    // 保留字节解码（帧序号与设备时刻）
+    SequenceMode sequence_mode;
+    bool extended_active;               // AUTO 模式下是否已检测到扩展帧
+    FrameSequenceTracker sequence;
+    FrameSequenceTracker::Clock::time_point next_report;
+    bool verbose;                       // 是否打印每帧解析结果和帧序号统计
 
 public:
     CurrentPowerProtocol();
@@ -20,10 +28,27 @@ public:
     bool isValidFrame(const std::vector<uint8_t>& frame_data) override;
     size_t getFrameSize() const override;
     std::string getProtocolName() const override;
-    bool findFrameHeader(struct sp_port* port);
+    std::vector<FrameFormat> getFrameFormats() const override;
+    // 串口重连后回到配置的解码方式：AUTO 模式需要重新检测扩展帧
+    void reset() override;
+    bool findFrameHeader(Transport& transport);
     
     // 设置回调函数
     void setCurrentPowerCallback(std::function<void(float, float)> callback);
+    
+    // 保留字节解码方式；tick_hz 为设备时刻的计数频率
+    void setSequenceMode(SequenceMode mode, double tick_hz = 1000.0);
+    const FrameSequenceTracker& getSequenceTracker() const { return sequence; }
+    // 将 "legacy"/"extended"/"auto" 解析为解码方式
+    static bool parseSequenceMode(const std::string& name, SequenceMode& mode);
+    // 当前是否按扩展格式解码帧序号（回调中可读取 getSequenceTracker().getStats().last_sequence）
+    bool isExtendedActive() const { return extended_active; }
+    // 关闭后不再打印每帧解析结果和帧序号统计（嵌入其他程序时使用）
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+private:
+    static constexpr int SEQUENCE_REPORT_INTERVAL_S = 10;
+    void reportSequenceStats();
 };
 
 #endif // CURRENT_POWER_PROTOCOL_H 
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef FD_TRANSPORT_H
+#define FD_TRANSPORT_H
+
+#include "transport.h"
+#include <sys/types.h>
+
+// 基于文件描述符的传输层公共实现：poll + read，write/writev，
+// 每次读写只有必要的系统调用，没有 libserialport 的额外封装开销。
+class FdTransport : public Transport {
+protected:
+    std::string name;
+    SerialSettings settings;
+    int fd;
+    bool kernel_timed;  // VMIN/VTIME 生效：fd 为阻塞模式，poll 按 VMIN 唤醒，读操作仍受 timeout_ms 限制
+
+public:
+    FdTransport(const std::string& name, const SerialSettings& settings);
+    ~FdTransport() override;
+
+    void close() override;
+    bool isOpen() const override { return fd >= 0; }
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    int write(const uint8_t* data, size_t length) override;
+    int writev(const struct iovec* iov, int iovcnt) override;
+    bool drain() override;
+    bool flushInput() override;
+    int inputWaiting() override;
+
+    int getFileDescriptor() const override { return fd; }
+    std::string getName() const override { return name; }
+
+protected:
+    // 读取已缓冲的数据；VMIN/VTIME 生效时按 FIONREAD 限制读取长度，没有数据时返回-1且 errno 为 EAGAIN
+    ssize_t readAvailable(uint8_t* buffer, size_t n);
+};
+
+// 直接使用 termios 配置的真实串口
+class TermiosTransport : public FdTransport {
+public:
+    TermiosTransport(const std::string& port_name, const SerialSettings& settings);
+    bool open() override;
+
+private:
+    bool configure();
+    void setLowLatency();
+};
+
+// 伪终端主端：测试时由程序自己扮演设备，从端路径交给被测对象打开
+class PtyTransport : public FdTransport {
+private:
+    std::string slave_path;
+    int slave_fd;   // 保持从端打开，避免对端未连接时主端读到EIO
+
+public:
+    explicit PtyTransport(const SerialSettings& settings = SerialSettings());
+    ~PtyTransport() override;
+
+    bool open() override;
+    void close() override;
+    std::string getSlavePath() const { return slave_path; }
+};
+
+#endif // FD_TRANSPORT_H
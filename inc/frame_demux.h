@@ -0,0 +1,62 @@
+#ifndef FRAME_DEMUX_H
+#define FRAME_DEMUX_H
+
+#include "protocol.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// 多协议帧分流器
+// 同一串口（如共用一条RS-485总线的传感器和串口屏）上混合着多种协议的帧。分流器在同一字节流上并行运行
+// 所有已注册协议的帧格式：每个起始位置上帧头匹配的格式都是候选，候选的字节到齐后校验帧尾并交给协议的
+// isValidFrame() 做完整校验，通过的候选中取最长的一帧交给所属协议，整帧消耗；没有候选通过时只丢弃
+// 起始的一个字节再重新同步，被截断的帧不会吞掉紧随其后的其他协议帧。
+// 更长的候选还在等待字节时先不输出较短的候选，线路空闲时调用 flush() 按已到齐的字节裁决。
+// 接收窗口和每种格式的帧缓冲区在注册时分配，feed() 不分配内存。
+class FrameDemux {
+public:
+    struct Stats {
+        uint64_t frames = 0;            // 分发的帧数
+        uint64_t discarded_bytes = 0;   // 不属于任何帧被丢弃的字节
+        uint64_t rejected = 0;          // 帧头匹配但帧尾或完整校验失败的候选
+        uint64_t ambiguous = 0;         // 同一位置有多个候选通过校验
+    };
+
+    // 每种帧格式的分发统计
+    struct Route {
+        Protocol* owner = nullptr;
+        FrameFormat format;
+        std::vector<uint8_t> frame;     // 预分配的帧缓冲区
+        uint64_t frames = 0;
+        uint64_t rejected = 0;
+    };
+
+    explicit FrameDemux(size_t window_size = 8192);
+
+    // 注册协议的全部帧格式（协议由调用方持有，生命周期需长于分流器）
+    void addProtocol(Protocol& protocol);
+    // 输入收到的字节，返回分发的帧数
+    size_t feed(const uint8_t* data, size_t length);
+    // 线路空闲：还在等待字节的候选视为失败，裁决并分发窗口中已完整的帧
+    size_t flush();
+    // 丢弃窗口中的字节（串口重连后调用）
+    void reset();
+
+    // 已注册格式中最短的帧长（读取路径按此大小等待）
+    size_t getMinFrameSize() const { return min_frame_size; }
+    const Stats& getStats() const { return stats; }
+    const std::vector<Route>& getRoutes() const { return routes; }
+
+private:
+    std::vector<Route> routes;
+    std::vector<uint8_t> window;        // 未消耗的字节 [head, tail)
+    size_t head;
+    size_t tail;
+    size_t min_frame_size;
+    size_t max_frame_size;
+    Stats stats;
+
+    size_t scan(bool idle);
+};
+
+#endif // FRAME_DEMUX_H
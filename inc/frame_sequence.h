@@ -0,0 +1,76 @@
+#ifndef FRAME_SEQUENCE_H
+#define FRAME_SEQUENCE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+// 电流功率帧保留字节（10~17）的解码方式
+enum class SequenceMode {
+    LEGACY,     // 保留字节全为0，只做校验
+    EXTENDED,   // 字节10~13为帧序号，14~17为设备时刻（均为小端 uint32）
+    AUTO        // 遇到非零保留字节后切换为 EXTENDED
+};
+
+// 帧序号跟踪
+// 根据传感器固件写入的帧序号统计丢帧（序号跳变）和重复帧，用设备时刻与主机单调时钟的
+// 线性拟合估计传感器时钟漂移；按统计周期输出实时丢帧率，供吞吐调优参考。
+class FrameSequenceTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t frames = 0;        // 收到的帧数
+        uint64_t lost = 0;          // 根据序号跳变推算的丢失帧数
+        uint64_t gaps = 0;          // 序号跳变次数
+        uint64_t duplicates = 0;    // 重复序号
+        uint64_t resets = 0;        // 序号回退或大幅跳变（传感器重启）
+        uint32_t last_sequence = 0;
+        double drift_ppm = 0.0;     // 传感器时钟相对主机时钟的偏差，正值表示传感器偏快
+        bool drift_valid = false;   // 拟合跨度足够长时为真
+    };
+
+    // 一个统计周期内的增量
+    struct Window {
+        uint64_t frames = 0;
+        uint64_t lost = 0;
+        double seconds = 0.0;
+        double lossRate() const {
+            uint64_t expected = frames + lost;
+            return expected > 0 ? static_cast<double>(lost) / static_cast<double>(expected) : 0.0;
+        }
+    };
+
+    explicit FrameSequenceTracker(double tick_hz = 1000.0, uint32_t max_gap = 100000);
+
+    // 记录一帧；now 为主机收到该帧的时刻
+    void observe(uint32_t sequence, uint32_t tick, Clock::time_point now = Clock::now());
+
+    const Stats& getStats() const { return stats; }
+    // 累计丢帧率 = 丢失 / (收到 + 丢失)
+    double lossRate() const;
+    // 返回自上次调用以来的增量并开始新的统计周期
+    Window takeWindow(Clock::time_point now = Clock::now());
+    // 串口重连后调用：下一帧作为新的基准，不计为丢帧或序号重置
+    void reset();
+
+private:
+    double tick_hz;
+    uint32_t max_gap;
+    bool started;
+    Stats stats;
+
+    // 漂移拟合：x = 主机经过时间 (s)，y = 设备经过时间 - 主机经过时间 (s)
+    Clock::time_point host_base;
+    uint32_t last_tick;
+    uint64_t device_ticks;      // 展开回绕后的设备时刻（相对基准）
+    double sum_x, sum_y, sum_xx, sum_xy;
+    uint64_t fit_count;
+
+    Window window;
+    Clock::time_point window_start;
+
+    void restartFit(uint32_t tick, Clock::time_point now);
+};
+
+#endif // FRAME_SEQUENCE_H
@@ -0,0 +1,33 @@
+#ifndef LIBSERIALPORT_TRANSPORT_H
+#define LIBSERIALPORT_TRANSPORT_H
+
+#include "transport.h"
+#include <libserialport.h>
+
+// 基于 libserialport 的传输层
+class LibSerialPortTransport : public Transport {
+private:
+    std::string port_name;
+    SerialSettings settings;
+    struct sp_port* port;
+
+public:
+    LibSerialPortTransport(const std::string& port_name, const SerialSettings& settings);
+    ~LibSerialPortTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return port != nullptr; }
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    int write(const uint8_t* data, size_t length) override;
+    bool drain() override;
+    bool flushInput() override;
+    int inputWaiting() override;
+
+    int getFileDescriptor() const override;
+    std::string getName() const override { return port_name; }
+};
+
+#endif // LIBSERIALPORT_TRANSPORT_H
@@ -0,0 +1,119 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+// 低开销单调时钟：x86-64 上 TSC 恒定且不随休眠停止时使用 rdtsc（启动时对照 steady_clock 校准），
+// 否则退回 clock_gettime(CLOCK_MONOTONIC)
+class CycleClock {
+public:
+    static void calibrate();
+    static uint64_t now();
+    static double toNs(uint64_t ticks) { return static_cast<double>(ticks) * ns_per_tick; }
+    static bool usesTsc() { return use_tsc; }
+
+private:
+    static bool use_tsc;
+    static double ns_per_tick;
+};
+
+// 主循环卡顿分析器
+// 记录每次迭代中各任务的耗时（对数分桶直方图），以及任务内部的读、写、drain、控制台输出累计耗时；
+// 最近 N 次迭代保存在环形缓冲区中，某次迭代超过预算时把整个环形缓冲区复制为一份卡顿记录。
+// 收到 SIGUSR1 后由主循环（而不是信号处理函数）打印直方图和最近一次卡顿记录。
+// 所有缓冲区在构造时分配，记录过程不分配内存。
+class LoopProfiler {
+public:
+    enum Task { TASK_MAINTAIN, TASK_POWER_READ, TASK_SCREEN_POLL, TASK_PERIODIC_SEND, TASK_TELEMETRY, TASK_SLEEP,
+                TASK_COUNT };
+    // 任务内部的细分耗时（由 ProfiledTransport 和 TimedStreambuf 上报）
+    enum Span { SPAN_READ, SPAN_WRITE, SPAN_DRAIN, SPAN_LOG, SPAN_COUNT };
+
+    static constexpr size_t BUCKET_COUNT = 24;  // <1us, <2us, <4us ... <4s, >=4s
+
+    struct Histogram {
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+        uint32_t max_us = 0;
+        uint64_t buckets[BUCKET_COUNT] = {};
+        void record(uint32_t us);
+        // 分桶上界估计的分位数
+        uint32_t percentileUs(double p) const;
+    };
+
+    struct Iteration {
+        uint64_t index = 0;
+        double start_ms = 0.0;              // 相对分析器启动时刻
+        uint32_t total_us = 0;
+        uint32_t task_us[TASK_COUNT] = {};
+        uint32_t span_us[SPAN_COUNT] = {};
+    };
+
+    LoopProfiler(double budget_ms, size_t trace_length = 64);
+
+    void beginIteration();
+    // 结束当前任务并开始下一个任务（任务按顺序执行）
+    void beginTask(Task task);
+    void endIteration();
+    // 任务内部的细分耗时
+    void addSpan(Span span, uint64_t ticks);
+
+    // 信号处理函数中调用：只设置标志
+    void requestDump() { dump_requested.store(true, std::memory_order_relaxed); }
+    bool takeDumpRequest() { return dump_requested.exchange(false, std::memory_order_relaxed); }
+    void dump(std::ostream& out) const;
+
+    uint64_t getStallCount() const { return stalls; }
+
+    static const char* taskName(Task task);
+    static const char* spanName(Span span);
+
+private:
+    uint32_t budget_us;
+    uint64_t origin;                    // 启动时刻（时钟计数）
+    uint64_t iteration_start;
+    uint64_t task_start;
+    int current_task;
+    Iteration current;
+
+    Histogram total_hist;
+    Histogram task_hist[TASK_COUNT];
+    Histogram span_hist[SPAN_COUNT];
+
+    std::vector<Iteration> ring;        // 最近 N 次迭代
+    size_t ring_next;
+    uint64_t iterations;
+
+    std::vector<Iteration> stall_trace; // 最近一次卡顿时的环形缓冲区快照（按时间顺序）
+    size_t stall_trace_length;
+    uint64_t stalls;
+    Iteration worst;
+
+    std::atomic<bool> dump_requested;
+
+    void endTask(uint64_t now);
+    static uint32_t toUs(uint64_t ticks);
+    static void printHistogram(std::ostream& out, const char* name, const Histogram& hist);
+};
+
+// 控制台输出计时：包装 std::cout 的缓冲区，把写入和刷新的耗时计入 SPAN_LOG
+class TimedStreambuf : public std::streambuf {
+public:
+    TimedStreambuf(std::streambuf* target, LoopProfiler& profiler) : target(target), profiler(profiler) {}
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    std::streambuf* target;
+    LoopProfiler& profiler;
+};
+
+#endif // LOOP_PROFILER_H
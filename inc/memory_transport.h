@@ -0,0 +1,43 @@
+#ifndef MEMORY_TRANSPORT_H
+#define MEMORY_TRANSPORT_H
+
+#include "transport.h"
+#include <vector>
+
+// 内存传输层：测试时代替真实串口
+// injectRx() 注入的字节供协议读取，协议写出的字节可以通过 takeTx() 取出检查。
+class MemoryTransport : public Transport {
+private:
+    std::string name;
+    bool opened;
+    std::vector<uint8_t> rx;
+    size_t rx_offset;
+    std::vector<uint8_t> tx;
+    size_t tx_capacity;             // 模拟的内核发送缓冲区容量，写满后 write() 只接受部分字节
+
+public:
+    explicit MemoryTransport(const std::string& name = "memory");
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return opened; }
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    int write(const uint8_t* data, size_t length) override;
+    bool drain() override { return opened; }
+    bool flushInput() override;
+    int inputWaiting() override;
+
+    int getFileDescriptor() const override { return -1; }
+    std::string getName() const override { return name; }
+
+    // 测试接口
+    void injectRx(const uint8_t* data, size_t length);
+    // 取出已写入的字节（相当于设备已接收，发送缓冲区重新腾出空间）
+    std::vector<uint8_t> takeTx();
+    // 设置发送缓冲区容量（默认不限），用于模拟慢速设备
+    void setTxCapacity(size_t bytes) { tx_capacity = bytes; }
+};
+
+#endif // MEMORY_TRANSPORT_H
@@ -0,0 +1,35 @@
+#ifndef PROFILED_TRANSPORT_H
+#define PROFILED_TRANSPORT_H
+
+#include "transport.h"
+#include "loop_profiler.h"
+
+// 计时传输层
+// 包装任意传输层，把读、写和 drain 的耗时上报给 LoopProfiler，
+// 用于区分主循环卡顿来自阻塞读、发送等待还是其他处理。
+class ProfiledTransport : public Transport {
+private:
+    std::unique_ptr<Transport> inner;
+    LoopProfiler& profiler;
+
+public:
+    ProfiledTransport(std::unique_ptr<Transport> inner, LoopProfiler& profiler);
+
+    bool open() override { return inner->open(); }
+    void close() override { inner->close(); }
+    bool isOpen() const override { return inner->isOpen(); }
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    int write(const uint8_t* data, size_t length) override;
+    int writev(const struct iovec* iov, int iovcnt) override;
+    bool drain() override;
+    bool flushInput() override { return inner->flushInput(); }
+    int inputWaiting() override { return inner->inputWaiting(); }
+    long overrunCount() const override { return inner->overrunCount(); }
+
+    int getFileDescriptor() const override { return inner->getFileDescriptor(); }
+    std::string getName() const override { return inner->getName(); }
+};
+
+#endif // PROFILED_TRANSPORT_H
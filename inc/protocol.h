@@ -1,9 +1,17 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
+// 固定长度帧的格式：以固定帧头开始、固定帧尾结束（多协议分流器据此同步和仲裁）
+struct FrameFormat {
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> trailer;
+    size_t size = 0;
+};
+
 // 协议基类
 class Protocol {
 public:
@@ -12,6 +20,10 @@ public:
     virtual bool isValidFrame(const std::vector<uint8_t>& frame_data) = 0;
     virtual size_t getFrameSize() const = 0;
     virtual std::string getProtocolName() const = 0;
+    // 重置解码状态（串口重连后调用）
+    virtual void reset() {}
+    // 本协议在线路上可能出现的帧格式，isValidFrame() 需要接受其中每一种；默认不参与多协议分流
+    virtual std::vector<FrameFormat> getFrameFormats() const { return {}; }
 };
 
 #endif // PROTOCOL_H 
\ No newline at end of file
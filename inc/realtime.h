@@ -0,0 +1,53 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 实时模式配置
+struct RealtimeConfig {
+    int cpu = -1;                   // 绑定的CPU核心，-1 不绑定
+    int priority = 50;              // SCHED_FIFO 优先级 (1-99)，0 不切换调度策略
+    bool lock_memory = true;        // mlockall 锁定内存
+    size_t prefault_stack_kb = 512; // 预先触碰的栈空间
+    size_t prefault_heap_kb = 8192; // 预先触碰并保留的堆空间
+};
+
+// 实时模式实际生效情况（权限不足时各项可能单独失败）
+struct RealtimeStatus {
+    bool pinned = false;
+    bool fifo = false;
+    bool memory_locked = false;
+    bool prefaulted = false;
+};
+
+// 对当前线程（I/O线程）应用实时设置；任何一项失败都只打印警告并继续，不会退出
+RealtimeStatus applyRealtimeMode(const RealtimeConfig& config);
+
+// 主循环调度抖动统计
+// 记录每次 1ms 休眠的实际时长与期望时长之差（即唤醒延迟），按对数分桶统计。
+class LoopJitterStats {
+public:
+    static const size_t BUCKET_COUNT = 8;
+
+    LoopJitterStats();
+
+    void record(int64_t latency_us);
+    void reset();
+    void print() const;
+
+    uint64_t count() const { return samples; }
+    int64_t minUs() const { return min_us; }
+    int64_t maxUs() const { return max_us; }
+    // 第 index 个分桶的样本数（分桶边界见 buckets 的注释）
+    uint64_t bucket(size_t index) const { return index < BUCKET_COUNT ? buckets[index] : 0; }
+
+private:
+    uint64_t samples;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t sum_us;
+    uint64_t buckets[BUCKET_COUNT]; // <50us, <100us, <250us, <500us, <1ms, <2ms, <5ms, >=5ms
+};
+
+#endif // REALTIME_H
@@ -0,0 +1,56 @@
+#ifndef RECONNECT_POLICY_H
+#define RECONNECT_POLICY_H
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// 串口断线重连策略
+// 记录连接状态，按指数退避安排重连时间，并统计断线恢复耗时。
+// 本身不做任何阻塞操作，由主循环在每次迭代中询问是否该重试。
+class ReconnectPolicy {
+public:
+    struct Stats {
+        uint64_t disconnects = 0;       // 断线次数
+        uint64_t reconnects = 0;        // 成功重连次数
+        uint64_t failed_attempts = 0;   // 重连失败次数
+        double last_recovery_ms = 0.0;  // 最近一次恢复耗时
+        double max_recovery_ms = 0.0;   // 最长恢复耗时
+        double total_recovery_ms = 0.0; // 累计恢复耗时
+    };
+
+    ReconnectPolicy(int initial_delay_ms = 100, int max_delay_ms = 5000);
+
+    // 打开成功时调用；如果之前处于断线状态则记录恢复耗时，返回true表示这是一次重连
+    bool markConnected();
+    // 检测到断线（或首次打开失败）时调用
+    void markDisconnected();
+    // 一次重连尝试失败，退避时间翻倍
+    void attemptFailed();
+
+    bool isConnected() const { return connected; }
+    // 处于断线状态且已到达下一次重试时间
+    bool shouldAttempt() const;
+    // 限制设备节点存在性检查的频率（每秒最多一次）
+    bool shouldCheckPresence();
+
+    const Stats& getStats() const { return stats; }
+
+    // 设备节点是否存在（USB转串口拔出后节点会消失）
+    static bool devicePresent(const std::string& path);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int initial_delay_ms;
+    int max_delay_ms;
+    int current_delay_ms;
+    bool connected;
+    bool ever_connected;
+    Clock::time_point disconnected_since;
+    Clock::time_point next_attempt;
+    Clock::time_point last_presence_check;
+    Stats stats;
+};
+
+#endif // RECONNECT_POLICY_H
@@ -0,0 +1,94 @@
+#ifndef SAMPLE_PIPELINE_H
+#define SAMPLE_PIPELINE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+
+// 滤波器类型
+enum class FilterType {
+    NONE,            // 不滤波，输出最新样本
+    MOVING_AVERAGE,  // 滑动平均
+    MEDIAN,          // N点中值
+    EMA              // 指数滑动平均
+};
+
+// 线性标定: y = gain * x + offset
+struct Calibration {
+    float gain = 1.0f;
+    float offset = 0.0f;
+};
+
+// 处理管线配置
+struct SamplePipelineConfig {
+    static constexpr size_t MAX_WINDOW = 4096;  // 窗口长度上限（中值滤波每次输出都要排序整个窗口）
+
+    FilterType filter = FilterType::MOVING_AVERAGE;
+    size_t window = 8;          // 滑动平均/中值窗口长度
+    float ema_alpha = 0.2f;     // EMA系数 (0, 1]
+    size_t batch_size = 64;     // 攒满该数量的样本后批量处理
+    Calibration current_cal;    // 电流标定
+    Calibration power_cal;      // 功率标定
+};
+
+// 样本处理管线
+// 位于电流功率回调与串口屏显示之间：样本先进入批量缓冲区，批量做标定和滤波，
+// 然后在 flush() 时按显示速率抽取输出一次。最大功率峰值保持看到的是标定后的
+// 原始样本（不经过滤波），避免被平均掉。
+class SamplePipeline {
+public:
+    explicit SamplePipeline(const SamplePipelineConfig& config);
+
+    // 输入一个原始样本（只写缓冲区，攒满一批才计算）
+    void push(float current, float power);
+
+    // 处理剩余样本，若自上次输出以来有新样本则输出一次滤波结果
+    bool flush();
+
+    // 输出回调：滤波后的电流、功率（按显示速率调用）
+    void setOutputCallback(std::function<void(float, float)> callback);
+    // 峰值回调：每批标定后原始功率的最大值
+    void setPeakCallback(std::function<void(float)> callback);
+    // 批量样本回调：每批标定后的原始功率样本（不经过滤波，用于波形显示）
+    void setBatchCallback(std::function<void(const float*, size_t)> callback);
+
+    const SamplePipelineConfig& getConfig() const { return config; }
+
+    // 将 "none"/"ma"/"median"/"ema" 解析为滤波器类型
+    static bool parseFilterType(const std::string& name, FilterType& type);
+    // 将 "gain,offset" 解析为标定参数
+    static bool parseCalibration(const std::string& text, Calibration& cal);
+
+private:
+    // 单个通道的状态（结构体数组形式，便于向量化）
+    struct Channel {
+        Calibration cal;
+        std::vector<float> history;     // 最近 window 个标定后样本（环形）
+        size_t history_pos = 0;
+        size_t history_count = 0;
+        float ema = 0.0f;
+        bool ema_valid = false;
+        float last = 0.0f;
+    };
+
+    SamplePipelineConfig config;
+    std::vector<float> current_batch;   // 原始样本批量缓冲区
+    std::vector<float> power_batch;
+    size_t batch_count;
+    bool has_new_output;
+
+    Channel current_channel;
+    Channel power_channel;
+    std::vector<float> median_scratch;  // 中值计算的预分配临时空间
+
+    std::function<void(float, float)> outputCallback;
+    std::function<void(float)> peakCallback;
+    std::function<void(const float*, size_t)> batchCallback;
+
+    void processBatch();
+    void processChannel(Channel& channel, float* samples, size_t count);
+    float filteredValue(Channel& channel);
+};
+
+#endif // SAMPLE_PIPELINE_H
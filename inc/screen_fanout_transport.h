@@ -0,0 +1,93 @@
+#ifndef SCREEN_FANOUT_TRANSPORT_H
+#define SCREEN_FANOUT_TRANSPORT_H
+
+#include "transport.h"
+#include "reconnect_policy.h"
+#include <vector>
+#include <functional>
+
+// 多串口屏广播传输层
+// SerialScreenProtocol 把命令格式化一次、写入一次，本传输层把同一份字节放进共享发送缓冲区，
+// 再由各串口按自己的写游标非阻塞地写出；慢速串口只拖慢自己，积压超过缓冲区容量时跳到最新位置并请求全量刷新。
+// 各串口收到的按键帧按到达顺序合并成一个事件流，整帧交给协议读取，不同屏幕的帧不会交错。
+// 单个串口断开时在后台独立重连，只有全部串口都断开时才向协议报告读取错误。
+class ScreenFanoutTransport : public Transport {
+public:
+    struct PortStats {
+        uint64_t bytes_written = 0;
+        uint64_t bytes_dropped = 0;     // 积压溢出时跳过的字节
+        uint64_t overflows = 0;         // 积压溢出次数
+        uint64_t events = 0;            // 收到的按键帧数
+        size_t backlog = 0;             // 当前积压字节数
+        bool connected = false;
+    };
+
+    ScreenFanoutTransport(std::vector<std::unique_ptr<Transport>> ports, size_t buffer_capacity = 8192);
+    ~ScreenFanoutTransport() override;
+
+    // 串口（重新）连上或积压溢出后需要重新发送全部数据时调用
+    void setRefreshCallback(std::function<void()> callback) { refresh_callback = std::move(callback); }
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return opened; }
+
+    // 从合并后的事件流读取；所有串口都断开时返回-1
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    // 追加到共享发送缓冲区并立即推进各串口的写游标
+    int write(const uint8_t* data, size_t length) override;
+    int writev(const struct iovec* iov, int iovcnt) override;
+    // 各串口独立推进，不等待任何一个串口发送完毕
+    bool drain() override;
+    bool flushInput() override;
+    int inputWaiting() override { return static_cast<int>(events.size() - events_head); }
+
+    int getFileDescriptor() const override { return -1; }
+    std::string getName() const override;
+
+    size_t getPortCount() const { return ports.size(); }
+    PortStats getPortStats(size_t index) const;
+    // 最近一次从事件流读出的帧来自哪个屏幕
+    size_t getLastEventSource() const { return last_event_source; }
+
+private:
+    static constexpr size_t FRAME_SIZE = 7;   // 0x65 页面 控件 事件 FF FF FF
+
+    struct Port {
+        std::unique_ptr<Transport> transport;
+        ReconnectPolicy reconnect;
+        size_t cursor = 0;              // 共享缓冲区中的绝对写位置
+        std::vector<uint8_t> rx_frame;  // 正在组装的按键帧
+        PortStats stats;
+    };
+
+    std::vector<Port> ports;
+    bool opened;
+
+    // 共享发送缓冲区：buffer[0] 对应绝对位置 base
+    std::vector<uint8_t> buffer;
+    size_t buffer_capacity;
+    size_t base;
+
+    // 合并后的事件流（整帧追加）及每帧的来源屏幕
+    std::vector<uint8_t> events;
+    size_t events_head;
+    std::vector<size_t> event_sources;
+    size_t last_event_source;
+
+    std::function<void()> refresh_callback;
+
+    size_t end() const { return base + buffer.size(); }
+    bool anyConnected() const;
+    bool openPort(size_t index);
+    void portDown(size_t index, const char* reason);
+    void maintainPorts();
+    void pollInput();
+    void pump();
+    void compact();
+    void requestRefresh();
+    bool append(const struct iovec* iov, int iovcnt);
+};
+
+#endif // SCREEN_FANOUT_TRANSPORT_H
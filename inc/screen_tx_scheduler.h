@@ -0,0 +1,92 @@
+#ifndef SCREEN_TX_SCHEDULER_H
+#define SCREEN_TX_SCHEDULER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <string_view>
+
+// 串口屏发送调度器
+// 9600波特率下链路每秒只能发送约960字节，而每条 tN.txt="x.xxx" 命令连同结束符约17字节，
+// 每50ms发送三条数值就已占满链路。调度器用令牌桶按链路字节预算决定何时发送哪条命令：
+//   - 交互类（start按键应答的距离、边长）严格优先，立即发送，不等待令牌但计入预算；
+//   - 周期类（电流、功率、最大功率）只在令牌足够时发送，按入队先后轮流发送；同一控件的新值覆盖
+//     仍在排队的旧值，预算不足时过期数值被丢弃、刷新间隔自动拉长。
+// 每条命令从入队到取出发送的排队延迟按优先级分别统计。命令槽在构造时分配，运行中不分配内存。
+class ScreenTxScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Priority { PRIORITY_INTERACTIVE, PRIORITY_PERIODIC, PRIORITY_COUNT };
+
+    static constexpr size_t SLOT_COUNT = 16;        // 同时排队的命令数（每个控件最多一条）
+    static constexpr size_t MAX_KEY_SIZE = 16;
+    static constexpr size_t MAX_COMMAND_SIZE = 64;
+    static constexpr size_t TERMINATOR_SIZE = 3;    // 结束符 FF FF FF
+
+    struct ClassStats {
+        uint64_t queued = 0;        // 入队次数
+        uint64_t sent = 0;          // 取出发送的命令数
+        uint64_t superseded = 0;    // 排队期间被同一控件的新值覆盖
+        uint64_t dropped = 0;       // 命令槽已满丢弃
+        uint64_t bytes = 0;         // 发送字节数（含结束符）
+        double delay_sum_ms = 0.0;  // 排队延迟
+        double delay_max_ms = 0.0;
+        double averageDelayMs() const { return sent > 0 ? delay_sum_ms / static_cast<double>(sent) : 0.0; }
+    };
+
+    // 一个统计周期内的增量
+    struct Window {
+        ClassStats classes[PRIORITY_COUNT];
+        double seconds = 0.0;
+    };
+
+    explicit ScreenTxScheduler(double budget_bytes_per_s = 960.0);
+
+    // 设置链路字节预算（字节/秒），8N1 下约为 波特率/10
+    void setBudget(double bytes_per_s);
+    double getBudget() const { return budget_bytes_per_s; }
+
+    // 入队一条命令（不含结束符）；key 为控件名，同一优先级中相同控件的待发命令被新值替换
+    void enqueue(Priority priority, std::string_view key, std::string_view command,
+                 Clock::time_point now = Clock::now());
+    // 取出下一条可以发送的命令：先交互类，再按入队先后取周期类（令牌不足时返回假）
+    // 返回的命令在下一次 enqueue/clear 之前有效
+    bool next(std::string_view& command, Clock::time_point now = Clock::now());
+    bool hasPending(Priority priority) const;
+    // 断线时丢弃排队的命令（重连后会重新发送全部数据）
+    void clear();
+
+    const ClassStats& getStats(Priority priority) const { return stats[priority]; }
+    // 返回自上次调用以来的增量并开始新的统计周期
+    Window takeWindow(Clock::time_point now = Clock::now());
+
+    static const char* priorityName(Priority priority);
+
+private:
+    struct Slot {
+        bool pending = false;
+        Priority priority = PRIORITY_PERIODIC;
+        char key[MAX_KEY_SIZE] = {};
+        size_t key_length = 0;
+        char command[MAX_COMMAND_SIZE] = {};
+        size_t command_length = 0;
+        Clock::time_point queued_at;
+    };
+
+    double budget_bytes_per_s;
+    double capacity;                    // 令牌桶容量（允许的突发字节数）
+    double tokens;
+    Clock::time_point last_refill;
+
+    Slot slots[SLOT_COUNT];
+    ClassStats stats[PRIORITY_COUNT];
+    Window window;
+    Clock::time_point window_start;
+
+    void refill(Clock::time_point now);
+    Slot* oldestPending(Priority priority);
+    void record(ClassStats& target, size_t bytes, double delay_ms);
+};
+
+#endif // SCREEN_TX_SCHEDULER_H
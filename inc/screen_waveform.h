@@ -0,0 +1,90 @@
+#ifndef SCREEN_WAVEFORM_H
+#define SCREEN_WAVEFORM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+
+// 波形控件配置
+struct WaveformConfig {
+    int component_id = 1;               // 曲线/波形控件ID
+    int channel = 0;                    // 通道号
+    float full_scale = 100.0f;          // 对应控件顶部的功率 (W)
+    int height = 255;                   // 控件高度（像素，最大255）
+    size_t batch_points = 10;           // 每条 addt 命令携带的点数
+    size_t decimation = 1;              // 每 N 个样本取平均作为一个点
+    double budget_bytes_per_s = 192.0;  // 波形可占用的发送带宽（9600波特率约为20%）
+    int handshake_timeout_ms = 200;     // 等待 0xFE/0xFD 应答的超时
+};
+
+// 功率波形流
+// 样本经抽取后缩放为 0~height 的单字节点，攒满一批后通过透传命令 addt 一次发送：
+//   addt 控件,通道,点数 FF FF FF  ->  屏幕应答 FE FF FF FF  ->  原始点数据  ->  屏幕应答 FD FF FF FF
+// 每点只占1字节（加上每批约14字节命令开销），而文本命令每个数值约18字节。
+// 发送受令牌桶限制，只使用配置的带宽份额，数值控件的刷新不会被波形挤占。
+// 本类只负责缓冲、预算和握手状态，实际读写由 SerialScreenProtocol 完成。
+class WaveformStream {
+public:
+    struct Stats {
+        uint64_t samples = 0;           // 输入样本数
+        uint64_t points_sent = 0;       // 已确认发送的点数
+        uint64_t points_dropped = 0;    // 缓冲区满或传输失败丢弃的点数
+        uint64_t transfers = 0;         // 完成的透传次数
+        uint64_t timeouts = 0;          // 握手超时次数
+        uint64_t bytes_sent = 0;        // 命令和点数据的总字节数
+    };
+
+    explicit WaveformStream(const WaveformConfig& config, size_t max_pending = 256);
+
+    // 输入一个功率样本（抽取后入队）
+    void push(float power);
+
+    // 空闲、点数够一批且预算允许时返回真
+    bool readyToSend();
+    // 生成 addt 命令并取出一批点，进入等待应答状态；返回命令长度
+    size_t beginTransfer(char* cmd, size_t capacity);
+    // 收到 0xFE：返回待发送的点数据，进入等待完成状态；不在等待 0xFE 时返回空缓冲区
+    const std::vector<uint8_t>& onReady();
+    // 收到 0xFD：本批发送完成
+    void onDone();
+    // 握手超时则放弃本批；返回是否发生超时
+    bool checkTimeout();
+    // 透传进行中（从发出 addt 到收到 0xFD），期间不能发送其他命令
+    bool busy() const { return state != State::IDLE; }
+    // 断线重连时丢弃进行中的传输和积压的点
+    void reset();
+
+    const WaveformConfig& getConfig() const { return config; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    enum class State { IDLE, WAIT_READY, WAIT_DONE };
+
+    WaveformConfig config;
+    State state;
+    Clock::time_point deadline;
+
+    // 待发送点的环形缓冲区
+    std::vector<uint8_t> pending;
+    size_t pending_head;
+    size_t pending_count;
+    std::vector<uint8_t> inflight;      // 正在透传的一批点
+    const std::vector<uint8_t> no_points;
+
+    // 抽取累加
+    float decimation_sum;
+    size_t decimation_count;
+
+    // 令牌桶（字节）
+    double tokens;
+    Clock::time_point last_refill;
+
+    Stats stats;
+
+    uint8_t scale(float power) const;
+    void refill();
+};
+
+#endif // SCREEN_WAVEFORM_H
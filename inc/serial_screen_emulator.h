@@ -0,0 +1,105 @@
+#ifndef SERIAL_SCREEN_EMULATOR_H
+#define SERIAL_SCREEN_EMULATOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+// 按键脚本中的一步：等待 delay_ms 后注入一个按键帧 0x65 page control event FF FF FF
+struct ScreenScriptStep {
+    int delay_ms = 1000;
+    uint8_t page = 0x01;
+    uint8_t control = 0x02;
+    uint8_t event = 0x01;
+    std::string expect_widget;  // 期望的响应控件名（如 t0.txt），用于测量按键响应延迟
+};
+
+// 串口屏模拟器
+// 持有伪终端(pty)的主端，被测程序把从端当作串口屏串口打开。
+// 解析 name="value" + FF FF FF 命令流到虚拟控件表，按脚本注入按键帧，
+// 并统计命令速率、字节速率、格式错误数和按键到响应的延迟。
+// 支持 addt 透传：应答 FE FF FF FF 后把随后的N个字节作为波形点接收，收满后应答 FD FF FF FF。
+class SerialScreenEmulator {
+public:
+    struct Stats {
+        uint64_t bytes = 0;             // 收到的字节数
+        uint64_t commands = 0;          // 赋值命令数 (name=value)
+        uint64_t instructions = 0;      // 其他指令数 (如 page 0、addt ...)
+        uint64_t malformed = 0;         // 格式错误的命令数
+        uint64_t events_injected = 0;   // 注入的按键帧数
+        uint64_t responses = 0;         // 收到期望响应的次数
+        uint64_t response_timeouts = 0; // 等待响应超时次数
+        uint64_t waveform_transfers = 0;// 完成的 addt 透传次数
+        uint64_t waveform_points = 0;   // 透传收到的波形点数
+        uint64_t waveform_bytes = 0;    // addt 命令及点数据的字节数
+        double latency_min_ms = 0.0;
+        double latency_max_ms = 0.0;
+        double latency_sum_ms = 0.0;
+    };
+
+    SerialScreenEmulator();
+    ~SerialScreenEmulator();
+
+    SerialScreenEmulator(const SerialScreenEmulator&) = delete;
+    SerialScreenEmulator& operator=(const SerialScreenEmulator&) = delete;
+
+    // 创建伪终端；link_path 非空时创建指向从端的符号链接
+    bool open(const std::string& link_path = "");
+    void close();
+    std::string getSlavePath() const { return slave_path; }
+
+    // 设置按键脚本，repeat 为真时循环执行
+    void setScript(const std::vector<ScreenScriptStep>& steps, bool repeat);
+    static bool loadScript(const std::string& path, std::vector<ScreenScriptStep>& steps);
+
+    // 处理输入、执行脚本，最多等待 timeout_ms
+    void poll(int timeout_ms);
+
+    // 直接向被测程序注入一个按键帧
+    bool injectEvent(uint8_t page, uint8_t control, uint8_t event);
+
+    // 直接向被测程序发送任意字节（用于模拟屏幕的返回数据）
+    bool injectBytes(const uint8_t* data, size_t length);
+
+    // 直接喂入字节（不经过pty，便于离线解析抓包数据）
+    void feed(const uint8_t* data, size_t length);
+
+    const Stats& getStats() const { return stats; }
+    const std::unordered_map<std::string, std::string>& getWidgets() const { return widgets; }
+    void printReport(double elapsed_s) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int master_fd;
+    int slave_fd;                   // 保持从端打开，避免被测程序未连接时主端读到EIO
+    std::string slave_path;
+    std::string link_path;
+
+    std::vector<uint8_t> pending;   // 尚未遇到结束符的字节
+    size_t transparent_remaining;   // addt 透传中尚未收到的点数
+    int last_waveform_point;
+    std::unordered_map<std::string, std::string> widgets;
+    Stats stats;
+
+    std::vector<ScreenScriptStep> script;
+    bool script_repeat;
+    size_t script_index;
+    Clock::time_point next_step_time;
+
+    // 等待中的响应
+    std::string waiting_widget;
+    Clock::time_point waiting_since;
+    bool waiting;
+
+    static constexpr size_t MAX_COMMAND_LENGTH = 1024;
+    static constexpr int RESPONSE_TIMEOUT_MS = 2000;
+
+    void runScript();
+    void handleCommand(const uint8_t* data, size_t length);
+};
+
+#endif // SERIAL_SCREEN_EMULATOR_H
@@ -2,13 +2,19 @@
 #define SERIAL_SCREEN_PROTOCOL_H
 
 #include "protocol.h"
-#include <libserialport.h>
+#include "reconnect_policy.h"
+#include "transport.h"
+#include "screen_waveform.h"
+#include "screen_tx_scheduler.h"
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include <unordered_map>
+#include <chrono>
 
 // 串口屏按键事件枚举
 enum class SerialScreenEvent {
@@ -46,10 +52,15 @@ enum class SerialScreenEvent {
 // 串口屏协议类
 class SerialScreenProtocol : public Protocol {
 private:
+    static constexpr int TX_REPORT_INTERVAL_S = 10;
+    
     std::string port_name;
-    int baud_rate;
-    struct sp_port* port;
+    std::unique_ptr<Transport> transport;
     std::mutex data_mutex;
+    ReconnectPolicy reconnect;
+    std::vector<uint8_t> rx_frame;      // 预分配的接收帧缓冲区
+    char last_cmd[64];                  // 上一次打印的命令，用于减少重复输出
+    size_t last_cmd_length;
     
     // 数据变量
     float distance_D;
@@ -59,41 +70,102 @@ private:
     float max_power;
     
     // 控制标志
-    bool start_received;
     bool data_updated;
+    bool refresh_requested;            // 下一次定期发送时重新发送全部数据
+    bool external_receive;             // 与传感器共用串口时由 UartReader 的分流器接收
+    bool external_transmit;            // 协程模式下由写协程经 AsyncPort 写出 tx_pending
+    
+    // 发送调度：按链路字节预算发送，交互类命令优先
+    // 命令非阻塞地写入内核发送缓冲区，不等待发送完毕；缓冲区满时没写出的部分留在 tx_pending，
+    // 写完之前不再从调度器取新命令
+    ScreenTxScheduler tx;
+    std::vector<uint8_t> tx_pending;    // 预分配的未写出字节
+    size_t tx_pending_head;
+    double link_bytes_per_s;            // 链路总带宽，扣除波形预算后作为数值命令的预算
+    std::chrono::steady_clock::time_point next_tx_report;
+    
+    // 功率波形（可选）
+    std::unique_ptr<WaveformStream> waveform;
     
     // 回调函数
     std::function<void()> startButtonCallback;
     
     // 通用事件回调注册表
     std::unordered_map<SerialScreenEvent, std::function<void()>> eventCallbacks;
+    
+    // 事件观察者（接收所有事件及原始字节，用于遥测等）
+    std::function<void(uint8_t, uint8_t, uint8_t, SerialScreenEvent)> eventObserver;
 
 public:
-    SerialScreenProtocol(const std::string& port_name, int baud_rate = 9600);
+    SerialScreenProtocol(const std::string& port_name, int baud_rate = 9600,
+                         TransportType transport_type = TransportType::LIBSERIALPORT);
+    // 使用外部创建的传输层（如测试用的内存/伪终端传输层）；baud_rate 决定默认的链路字节预算
+    explicit SerialScreenProtocol(std::unique_ptr<Transport> transport, int baud_rate = 9600);
     ~SerialScreenProtocol();
     
     bool parseFrame(const std::vector<uint8_t>& frame_data) override;
     bool isValidFrame(const std::vector<uint8_t>& frame_data) override;
     size_t getFrameSize() const override;
     std::string getProtocolName() const override;
-    bool findFrameHeader(struct sp_port* port);
+    // 按键事件帧和透传应答帧（共用一个串口时由分流器分发给 parseFrame）
+    std::vector<FrameFormat> getFrameFormats() const override;
+    bool findFrameHeader(Transport& transport);
     
     // 串口屏发送功能
     bool open();
     void close();
     void sendFloat(const std::string& name, float value);
-    void sendCmd(const std::string& cmd);
+    void sendCmd(std::string_view cmd);
+    
+    // 链路字节预算（字节/秒），默认 波特率/10
+    void setLinkBudget(double bytes_per_s);
+    const ScreenTxScheduler& getTxScheduler() const { return tx; }
+    // 内核发送缓冲区已满、尚未写出的字节数
+    size_t getTxPendingBytes() const { return tx_pending.size() - tx_pending_head; }
+    
+    // 断线检测与后台重连：主循环每次迭代调用，到达退避时间才尝试重新打开，不会阻塞
+    void maintainConnection();
+    bool isConnected() const { return reconnect.isConnected(); }
+    const ReconnectPolicy::Stats& getReconnectStats() const { return reconnect.getStats(); }
+    void handleDisconnect(const char* reason);
+    // 读超时后调用：定期确认设备节点仍然存在，消失则按断线处理
+    void checkDevicePresent();
+    // 底层文件描述符（供协程I/O使用），未打开时返回-1
+    int getFileDescriptor() const { return transport->getFileDescriptor(); }
+    Transport& getTransport() { return *transport; }
     
     // 数据更新接口
     void updateCurrentPower(float current, float power);
     void updateMaxPower(float max_power);
+    void updateDisplayedCurrentPower(float current, float power); // 只更新显示值，不影响最大功率
+    void updatePeakPower(float power);                            // 仅当更大时更新最大功率
     
     // 立即发送接口
     void sendDistanceAndSideLengthImmediately();
     
     // 单线程支持接口
     void checkForSerialScreenData();
+    // 与传感器共用一个串口：接收由 UartReader 完成，checkForSerialScreenData() 不再读串口
+    void setExternalReceive(bool enabled) { external_receive = enabled; }
+    // 推送式解码：由 io_uring 完成事件直接喂入收到的字节
+    void feed(const uint8_t* data, size_t length);
+    // 发送由外部完成：命令只进入 tx_pending，不直接写串口，由 takeTxPending() 取走后写出
+    void setExternalTransmit(bool enabled) { external_transmit = enabled; }
+    // 取出最多 max_bytes 个待写字节；发送缓冲区已空时先从调度器取出下一条命令
+    size_t takeTxPending(uint8_t* buffer, size_t max_bytes);
     void sendPeriodicData();
+    // 请求在下一次定期发送时重新发送全部数据（如多屏广播中某个屏幕重新连上）
+    void requestFullRefresh() { refresh_requested = true; }
+    
+    // 功率波形：样本经抽取后用 addt 透传命令批量发送到曲线控件
+    void enableWaveform(const WaveformConfig& config);
+    void pushWaveformSamples(const float* power, size_t count);
+    const WaveformStream* getWaveform() const { return waveform.get(); }
+    // 屏幕应答帧（FE/FD FF FF FF）的长度
+    static constexpr size_t RESPONSE_SIZE = 4;
+    static bool isTransferResponse(uint8_t code) { return code == 0xFE || code == 0xFD; }
+    // 处理透传应答：0xFE 发送点数据，0xFD 本批完成
+    void handleTransferResponse(uint8_t code);
     
     // 回调设置接口
     void setStartButtonCallback(std::function<void()> callback);
@@ -104,11 +176,26 @@ public:
     void unregisterEventCallback(SerialScreenEvent event);
     void clearAllEventCallbacks();
     
+    // 事件观察者接口：参数为 页面、控件、事件、解析后的事件类型
+    void setEventObserver(std::function<void(uint8_t, uint8_t, uint8_t, SerialScreenEvent)> observer);
+    
 private:
+    void initDebugValues();
+    bool openPort();
     void sendAllData();
-    void sendDistanceAndSideLength();
+    void sendDistanceAndSideLength(ScreenTxScheduler::Priority priority);
     void sendCurrentAndPower();
     void sendMaxPower();
+    void serviceWaveform();
+    // 数值命令入队，由 pumpTx() 按预算和优先级写出
+    void queueFloat(ScreenTxScheduler::Priority priority, const char* name, float value);
+    void pumpTx();
+    // 写出命令或点数据，写不完的部分排在 tx_pending 之后；写入错误按断线处理并返回假
+    bool writeFrame(const struct iovec* iov, int iovcnt);
+    // 继续写出 tx_pending，全部写完时返回真
+    bool flushTxPending();
+    void applyTxBudget();
+    void reportTxStats();
     
     // 内部辅助方法
     SerialScreenEvent parseEvent(uint8_t page, uint8_t control, uint8_t event);
@@ -0,0 +1,38 @@
+#ifndef SHARED_PORT_TRANSPORT_H
+#define SHARED_PORT_TRANSPORT_H
+
+#include "transport.h"
+
+// 共用串口传输层
+// 传感器和串口屏接在同一条总线（同一个串口）上时，串口由 SerialScreenProtocol 以读写方式持有，
+// UartReader 通过本类借用同一个传输层读取全部字节（再由分流器分发给两个协议），不会重复打开串口。
+// 串口只由持有方关闭：借用方断线时不关闭串口，而是通知持有方走它自己的断线处理（见 UartReader::setDisconnectCallback）。
+class SharedPortTransport : public Transport {
+private:
+    Transport& target;
+
+public:
+    explicit SharedPortTransport(Transport& target) : target(target) {}
+
+    // 已由另一方打开时直接复用
+    bool open() override;
+    // 借用的串口由持有方关闭和重连，这里什么也不做
+    void close() override {}
+    bool isOpen() const override { return target.isOpen(); }
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override {
+        return target.read(buffer, n, timeout_ms);
+    }
+    int readNonblocking(uint8_t* buffer, size_t n) override { return target.readNonblocking(buffer, n); }
+    int write(const uint8_t* data, size_t length) override { return target.write(data, length); }
+    int writev(const struct iovec* iov, int iovcnt) override { return target.writev(iov, iovcnt); }
+    bool drain() override { return target.drain(); }
+    bool flushInput() override { return target.flushInput(); }
+    int inputWaiting() override { return target.inputWaiting(); }
+    long overrunCount() const override { return target.overrunCount(); }
+
+    int getFileDescriptor() const override { return target.getFileDescriptor(); }
+    std::string getName() const override { return target.getName(); }
+};
+
+#endif // SHARED_PORT_TRANSPORT_H
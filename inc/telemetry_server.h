@@ -0,0 +1,104 @@
+#ifndef TELEMETRY_SERVER_H
+#define TELEMETRY_SERVER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 遥测帧格式（小端）:
+//   [uint32 payload_len][uint16 record_count][record * record_count]
+// 每条记录固定 TELEMETRY_RECORD_SIZE 字节:
+//   [uint8 type][uint8 a][uint8 b][uint8 c][uint64 timestamp_ns][8字节数据]
+//   type=TELEMETRY_SAMPLE: 数据为 float current + float power
+//   type=TELEMETRY_SCREEN_EVENT: a/b/c 为 页面/控件/事件, 数据前4字节为事件枚举值
+enum TelemetryRecordType : uint8_t {
+    TELEMETRY_SAMPLE = 1,
+    TELEMETRY_SCREEN_EVENT = 2
+};
+
+static const size_t TELEMETRY_RECORD_SIZE = 20;
+static const size_t TELEMETRY_FRAME_HEADER_SIZE = 6;
+
+// 遥测服务器配置
+struct TelemetryServerConfig {
+    std::string unix_path;          // Unix域套接字路径，空则不监听
+    int tcp_port = 0;               // 回环TCP端口，0则不监听
+    size_t queue_capacity = 4096;   // 每个订阅者的队列容量（记录数）
+    size_t max_batch = 256;         // 每次写入最多打包的记录数
+    int stall_timeout_ms = 2000;    // 订阅者持续无法写入超过该时间则断开
+    size_t max_clients = 16;        // 最大订阅者数量
+};
+
+// 本地遥测流服务器
+// 单线程非阻塞设计：publish* 只写入各订阅者的有界队列，不做任何I/O；
+// poll() 由主循环调用，负责接受连接和批量发送。慢速订阅者只会丢数据或被断开，
+// 不会阻塞 UartReader 的接收路径。
+class TelemetryServer {
+public:
+    struct Stats {
+        uint64_t published = 0;     // 发布的记录总数
+        uint64_t dropped = 0;       // 因队列满丢弃的记录总数
+        uint64_t frames_sent = 0;   // 发送的批量帧数
+        uint64_t bytes_sent = 0;    // 发送的字节数
+        uint64_t clients_dropped = 0; // 因过慢被断开的订阅者数
+        size_t clients = 0;         // 当前订阅者数
+    };
+
+    explicit TelemetryServer(const TelemetryServerConfig& config);
+    ~TelemetryServer();
+
+    TelemetryServer(const TelemetryServer&) = delete;
+    TelemetryServer& operator=(const TelemetryServer&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return unix_fd >= 0 || tcp_fd >= 0; }
+
+    // 发布接口（不阻塞，不做系统调用）
+    void publishSample(float current, float power);
+    void publishScreenEvent(uint8_t page, uint8_t control, uint8_t event, int event_id);
+
+    // 主循环调用：接受新连接、发送批量帧、清理断开的订阅者
+    void poll();
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Record {
+        uint8_t type;
+        uint8_t a, b, c;
+        uint64_t timestamp_ns;
+        uint8_t data[8];
+    };
+
+    // 订阅者槽位在构造时全部预分配，连接/断开只改变 fd，运行期间不分配内存
+    struct Client {
+        int fd = -1;
+        std::vector<Record> queue;      // 预分配的环形队列
+        size_t head = 0;
+        size_t count = 0;
+        std::vector<uint8_t> out;       // 正在发送的批量帧
+        size_t out_offset = 0;
+        uint64_t dropped = 0;
+        uint64_t last_progress_ns = 0;  // 最近一次成功写入（或队列为空）的时间
+    };
+
+    TelemetryServerConfig config;
+    int unix_fd;
+    int tcp_fd;
+    bool unix_bound;                    // 套接字文件由本服务创建，停止时删除
+    std::vector<Client> clients;
+    size_t active_clients;
+    Stats stats;
+
+    void enqueue(const Record& record);
+    void acceptClients(int listen_fd);
+    bool flushClient(Client& client, uint64_t now_ns);
+    void buildBatch(Client& client);
+    void closeClient(Client& client);
+
+    static uint64_t nowNs();
+};
+
+#endif // TELEMETRY_SERVER_H
@@ -0,0 +1,69 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <sys/uio.h>
+
+// 串口参数（所有传输层共用）
+struct SerialSettings {
+    int baud_rate = 9600;
+    int data_bits = 8;
+    int stop_bits = 1;
+    bool read_write = true;     // false 为只读打开
+    // 以下仅 termios 后端使用（UART_VMIN/UART_VTIME），读操作总是受调用方的超时限制
+    int vmin = 0;               // VMIN：VTIME=0 时内核缓冲满 VMIN 字节才唤醒等待者，减少高帧率下的唤醒次数
+    int vtime = 0;              // VTIME：字节间超时，单位0.1秒；>0 时收到第一个字节即唤醒
+    bool low_latency = true;    // 设置 Linux ASYNC_LOW_LATENCY 标志（USB转串口可降低延迟）
+};
+
+// 可在运行时选择的传输层类型
+// 测试用的 MemoryTransport/PtyTransport 不对应真实串口，由调用方直接创建后传给协议类的构造函数
+enum class TransportType {
+    LIBSERIALPORT,  // libserialport（默认）
+    TERMIOS         // 直接使用 termios/文件描述符
+};
+
+// 传输层抽象
+// UartReader 和 SerialScreenProtocol 只通过该接口读写串口，串口参数配置集中在各实现的 open() 中。
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    // 读取 n 字节，最多等待 timeout_ms；返回读到的字节数（超时可能小于n），出错返回-1
+    virtual int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) = 0;
+    // 只读取已到达的数据，不等待；出错返回-1
+    virtual int readNonblocking(uint8_t* buffer, size_t n) = 0;
+    // 非阻塞写入，返回写入的字节数，出错返回-1
+    virtual int write(const uint8_t* data, size_t length) = 0;
+    // 聚集写：默认逐段调用 write()，fd 后端用一次 writev 系统调用完成
+    virtual int writev(const struct iovec* iov, int iovcnt);
+    // 等待发送缓冲区中的数据全部发出
+    virtual bool drain() = 0;
+    // 丢弃接收缓冲区
+    virtual bool flushInput() = 0;
+    // 接收缓冲区中等待读取的字节数，出错返回-1
+    virtual int inputWaiting() = 0;
+    // 内核统计的接收溢出次数（硬件FIFO溢出 + tty缓冲区溢出），驱动不支持时返回-1
+    // 默认对文件描述符调用 TIOCGICOUNT
+    virtual long overrunCount() const;
+
+    // 底层文件描述符（供 epoll/协程使用），没有时返回-1
+    virtual int getFileDescriptor() const = 0;
+    virtual std::string getName() const = 0;
+};
+
+// 按类型创建传输层
+std::unique_ptr<Transport> createTransport(TransportType type, const std::string& name,
+                                           const SerialSettings& settings);
+
+// 将 "libserialport"/"termios" 解析为传输层类型
+bool parseTransportType(const std::string& name, TransportType& type);
+
+#endif // TRANSPORT_H
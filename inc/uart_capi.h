@@ -0,0 +1,105 @@
+#ifndef UART_CAPI_H
+#define UART_CAPI_H
+
+/*
+ * libuart C 接口
+ * 供宿主程序（包括通过 ctypes 调用的 Python 工具）打开电流功率传感器串口并批量取回样本。
+ * 所有结构体只在末尾追加字段；uart_config 用 struct_size 区分版本，新增字段对旧调用方取默认值。
+ * 每个句柄只能在一个线程中使用；解码在 uart_read_samples() 的调用线程中进行，库内不创建线程。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define UART_API __attribute__((visibility("default")))
+#else
+#define UART_API
+#endif
+
+#define UART_ABI_VERSION 1
+
+/* 返回码 */
+#define UART_OK 0
+#define UART_ERR_INVALID (-1)       /* 参数无效 */
+#define UART_ERR_DISCONNECTED (-2)  /* 串口已断开且未取到样本（库会在后续调用中自动重连） */
+
+/* 传输层 */
+#define UART_TRANSPORT_LIBSERIALPORT 0
+#define UART_TRANSPORT_TERMIOS 1
+
+/* 保留字节解码方式 */
+#define UART_SEQ_LEGACY 0
+#define UART_SEQ_EXTENDED 1
+#define UART_SEQ_AUTO 2
+
+/* 样本标志 */
+#define UART_SAMPLE_HAS_SEQUENCE 0x1u  /* sequence 字段有效（扩展帧） */
+
+typedef struct uart_handle uart_handle;
+
+typedef struct uart_config {
+    uint32_t struct_size;       /* sizeof(uart_config)，由 uart_config_init() 填写 */
+    const char* port;           /* 串口设备路径 */
+    int32_t baud_rate;          /* 默认 9600 */
+    int32_t transport;          /* UART_TRANSPORT_*，默认 libserialport */
+    int32_t sequence_mode;      /* UART_SEQ_*，默认 UART_SEQ_AUTO */
+    double tick_hz;             /* 设备时刻的计数频率，默认 1000 */
+    uint32_t queue_capacity;    /* 未取走样本的队列容量，默认 4096，队列满时丢弃最旧样本 */
+} uart_config;
+
+typedef struct uart_sample {
+    uint64_t timestamp_ns;      /* 解码时刻，CLOCK_MONOTONIC 纳秒 */
+    float current;              /* 电流 (A) */
+    float power;                /* 功率 (W) */
+    uint32_t sequence;          /* 帧序号（UART_SAMPLE_HAS_SEQUENCE 时有效） */
+    uint32_t flags;             /* UART_SAMPLE_* */
+} uart_sample;
+
+typedef struct uart_stats {
+    uint64_t frames;            /* 解码的帧数 */
+    uint64_t samples_dropped;   /* 队列满丢弃的样本数 */
+    uint64_t lost_frames;       /* 根据帧序号推算的丢帧数（扩展帧） */
+    uint64_t bytes;             /* 接收字节数 */
+    uint64_t reconnects;        /* 断线重连次数 */
+    int64_t overruns;           /* 内核报告的接收溢出次数，不支持时为 -1 */
+    int32_t connected;          /* 当前是否在线 */
+    int32_t reserved;
+} uart_stats;
+
+/* 库的 ABI 版本（UART_ABI_VERSION），宿主加载后可用于检查兼容性 */
+UART_API int uart_abi_version(void);
+
+/* 填写默认配置 */
+UART_API void uart_config_init(uart_config* config);
+
+/* 打开传感器串口；失败返回 NULL，原因见 uart_last_error() */
+UART_API uart_handle* uart_open(const uart_config* config);
+
+/*
+ * 取回样本，写入调用方提供的数组 samples[0..max)，返回写入的样本数。
+ * 队列中的样本不足 max 时继续读取串口，直到取满 max 个或超过 timeout_ms：
+ * timeout_ms 为 0 时只处理调用时已到达的字节、不等待；小于 0 时一直等到取满。
+ * max 超过 INT_MAX 时按 INT_MAX 处理。
+ * 超时未取到样本且串口已断开时返回 UART_ERR_DISCONNECTED。
+ */
+UART_API int uart_read_samples(uart_handle* handle, uart_sample* samples, size_t max, int timeout_ms);
+
+/* 读取统计，成功返回 UART_OK */
+UART_API int uart_get_stats(uart_handle* handle, uart_stats* stats);
+
+/* 关闭串口并释放句柄 */
+UART_API void uart_close(uart_handle* handle);
+
+/* 当前线程最近一次失败的原因 */
+UART_API const char* uart_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_CAPI_H */
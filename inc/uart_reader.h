@@ -2,30 +2,120 @@
 #define UART_READER_H
 
 #include "protocol.h"
-#include <libserialport.h>
+#include "frame_demux.h"
+#include "reconnect_policy.h"
+#include "transport.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <functional>
 
 // 串口读取器类
+// 阻塞主循环的读取路径先查询内核接收缓冲区中的积压字节数：空闲时阻塞等待第一个字节，
+// 积压不足一帧时按帧大小读取，积压较多时一次读完全部积压，再交给 feed() 由多协议分流器解码。
+// 同时记录积压高水位，积压超过告警阈值或内核报告接收溢出时发出告警。
 class UartReader {
+public:
+    struct ReadStats {
+        uint64_t reads = 0;             // 返回数据的读取次数
+        uint64_t bytes = 0;
+        uint64_t frames = 0;            // 解码出的帧数
+        uint64_t drain_reads = 0;       // 一次读完多帧积压的次数
+        size_t last_backlog = 0;        // 最近一次读取前的积压字节数
+        size_t backlog_high_water = 0;  // 积压高水位
+        uint64_t backlog_alarms = 0;    // 积压超过告警阈值的次数
+        long overruns = -1;             // 内核报告的接收溢出累计次数，不支持时为-1
+        uint64_t overrun_alarms = 0;    // 检测到新溢出的次数
+    };
+
 private:
+    static constexpr size_t RX_BUFFER_SIZE = 4096;          // 与 N_TTY 接收缓冲区相同
+    static constexpr unsigned int IDLE_READ_TIMEOUT_MS = 100;
+    static constexpr unsigned int FRAME_READ_TIMEOUT_MS = 100;
+    static constexpr int READ_REPORT_INTERVAL_S = 10;
+
     std::string port_name;
-    int baud_rate;
-    struct sp_port* port;
+    std::unique_ptr<Transport> transport;
     std::vector<std::unique_ptr<Protocol>> protocols;
+    ReconnectPolicy reconnect;
+    std::function<void(const char*)> disconnect_callback;
+    FrameDemux demux;                   // 同一字节流上并行解码所有已注册协议的帧
+    
+    // 自适应读取
+    std::vector<uint8_t> rx_buffer;     // 预分配的读取缓冲区（容纳内核tty缓冲区的全部积压）
+    size_t min_frame_size;              // 已注册协议中最小的帧长
+    size_t backlog_alarm_bytes;
+    bool backlog_alarmed;               // 已告警，积压降到阈值一半以下后重新允许告警
+    unsigned int idle_read_timeout_ms;  // 空闲时等待第一个字节的最长时间
+    bool verbose;                       // 是否定期打印接收统计
+    ReadStats read_stats;
+    ReadStats last_report;
+    std::chrono::steady_clock::time_point next_overrun_check;
+    std::chrono::steady_clock::time_point next_report;
 
-    bool tryReadCurrentPowerFrame(uint8_t first_byte, uint8_t second_byte);
-    bool tryReadSerialScreenFrame(uint8_t first_byte);
+    bool openPort();
+    void closePort();
+    void initReadPath();
+    void recordBacklog(size_t backlog);
+    size_t decodeRead(size_t bytes_read);
+    void checkOverruns();
+    void reportReadStats();
 
 public:
-    UartReader(const std::string& port_name, int baud_rate = 9600);
+    UartReader(const std::string& port_name, int baud_rate = 9600,
+               TransportType transport_type = TransportType::LIBSERIALPORT);
+    // 使用外部创建的传输层（如测试用的内存/伪终端传输层）
+    explicit UartReader(std::unique_ptr<Transport> transport);
     ~UartReader();
 
     void addProtocol(std::unique_ptr<Protocol> protocol);
+    // 注册由外部持有的协议（如共用一个串口的串口屏协议），其帧同样由分流器分发
+    void attachProtocol(Protocol& protocol);
     bool open();
+    // 读取并解码当前可用的数据，解码出至少一帧时返回真
     bool readAndParseFrame();
+    // 同上，但空闲时最多阻塞 idle_timeout_ms（只影响本次调用，不改变 setIdleReadTimeout() 的设置）
+    bool readAndParseFrame(unsigned int idle_timeout_ms);
+    // 非阻塞地读取并解码最多 max_bytes 字节的积压，返回读到的字节数；读取错误按断线处理并返回-1
+    int readPending(size_t max_bytes);
+    // 推送式解码：交给多协议分流器，返回解码出的帧数（io_uring 完成事件也直接调用）
+    size_t feed(const uint8_t* data, size_t length);
+    
+    // 积压告警阈值（字节），默认为内核tty缓冲区(4096)的一半
+    void setBacklogAlarm(size_t bytes) { backlog_alarm_bytes = bytes; }
+    // 空闲时 readAndParseFrame() 最多阻塞的时间（默认100ms，必须大于0）
+    void setIdleReadTimeout(unsigned int ms) { idle_read_timeout_ms = ms > 0 ? ms : 1; }
+    // 关闭后不再定期打印接收统计（嵌入其他程序时使用），告警照常输出
+    void setVerbose(bool enabled) { verbose = enabled; }
+    const ReadStats& getReadStats() const { return read_stats; }
+    const FrameDemux& getDemux() const { return demux; }
     std::string getPortName() const { return port_name; }
+
+    // 断线检测与后台重连：主循环每次迭代调用，到达退避时间才尝试重新打开，不会阻塞
+    void maintainConnection();
+    bool isConnected() const { return reconnect.isConnected(); }
+    const ReconnectPolicy::Stats& getReconnectStats() const { return reconnect.getStats(); }
+    void handleDisconnect(const char* reason);
+    // 断线时通知串口的持有方（与串口屏共用串口时，由串口屏协议关闭串口并在重连后重新发送全部数据）
+    void setDisconnectCallback(std::function<void(const char*)> callback) { disconnect_callback = std::move(callback); }
+    // 读超时后调用：定期确认设备节点仍然存在，消失则按断线处理
+    void checkDevicePresent();
+
+    // 底层文件描述符（供协程I/O使用），未打开时返回-1
+    int getFileDescriptor() const { return transport->getFileDescriptor(); }
+    Transport& getTransport() { return *transport; }
+
+    // 按类型查找已注册的协议
+    template<typename T>
+    T* getProtocol() {
+        for (auto& protocol : protocols) {
+            if (auto p = dynamic_cast<T*>(protocol.get())) {
+                return p;
+            }
+        }
+        return nullptr;
+    }
 };
 
 #endif // UART_READER_H 
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef URING_LOOP_H
+#define URING_LOOP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// io_uring 事件循环（直接使用系统调用，不依赖 liburing）
+//
+// 每个端口始终挂着一个读请求，读入预先注册的固定缓冲区(READ_FIXED)；
+// 完成事件直接把数据交给端口的处理函数（协议解码器），然后立即重新投递读请求。
+// 写入先复制到端口的发送缓冲区，runOnce() 时与重新投递的读请求一起批量提交，
+// 一次 io_uring_enter 同时完成提交和等待，多串口时系统调用次数与端口数量无关。
+//
+// 内核不支持 io_uring（或被 seccomp 禁用）时 isValid() 返回 false，由调用者改用 epoll。
+class UringLoop {
+public:
+    using DataHandler = std::function<void(const uint8_t*, size_t)>;
+    using ErrorHandler = std::function<void()>;
+
+    struct Stats {
+        uint64_t enters = 0;            // io_uring_enter 系统调用次数
+        uint64_t read_completions = 0;  // 带数据的读完成事件数
+        uint64_t bytes_read = 0;
+        uint64_t writes_submitted = 0;  // 提交的写请求数（每个可能包含多条命令）
+        uint64_t bytes_written = 0;
+        uint64_t errors = 0;
+    };
+
+    UringLoop(size_t max_ports = 8, size_t buffer_size = 4096, unsigned entries = 64);
+    ~UringLoop();
+
+    UringLoop(const UringLoop&) = delete;
+    UringLoop& operator=(const UringLoop&) = delete;
+
+    bool isValid() const { return ring_fd >= 0; }
+    bool usesFixedBuffers() const { return fixed_buffers; }
+
+    // 注册端口并投递第一个读请求，返回端口号，失败返回-1
+    // 端口会被切换为阻塞模式且 VMIN=1，读请求由内核在数据到达时完成，不会空转
+    int addPort(int fd, DataHandler on_data, ErrorHandler on_error);
+    // 取消端口上未完成的请求；槽位在所有请求完成后才会被复用
+    void removePort(int port_id);
+
+    // 复制到端口发送缓冲区，返回接受的字节数（缓冲区满时小于 length）
+    size_t queueWrite(int port_id, const uint8_t* data, size_t length);
+    size_t pendingWrite(int port_id) const;
+
+    // 提交所有待发请求并等待完成事件（最多 timeout_ms），然后分发；返回处理的完成事件数
+    int runOnce(int timeout_ms);
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Port {
+        int fd = -1;
+        bool in_use = false;
+        bool failed = false;
+        bool read_inflight = false;
+        bool write_inflight = false;
+        size_t tx_length = 0;           // 发送缓冲区中的有效字节
+        size_t tx_inflight = 0;         // 正在写出的字节（发送缓冲区开头部分）
+        DataHandler on_data;
+        ErrorHandler on_error;
+    };
+
+    int ring_fd;
+    bool fixed_buffers;
+    size_t buffer_size;
+    unsigned sq_entries;
+    unsigned cq_entries;
+    unsigned pending_submit;
+
+    // 映射的环形队列
+    void* sq_map;
+    size_t sq_map_size;
+    void* cq_map;
+    size_t cq_map_size;
+    void* sqe_map;
+    size_t sqe_map_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+
+    std::vector<Port> ports;
+    std::vector<uint8_t> buffers;       // 每个端口一个接收区和一个发送区，整体注册给内核
+    Stats stats;
+
+    bool setupRing(unsigned entries);
+    void closeRing();
+    struct io_uring_sqe* getSqe();
+    bool submitRead(int port_id);
+    bool submitWrite(int port_id);
+    void submitCancel(int port_id, uint8_t op);
+    int enter(unsigned min_complete, int timeout_ms);
+    void handleCompletion(uint64_t user_data, int32_t res);
+    void failPort(int port_id);
+
+    uint8_t* rxBuffer(int port_id) { return buffers.data() + static_cast<size_t>(port_id) * 2 * buffer_size; }
+    uint8_t* txBuffer(int port_id) { return rxBuffer(port_id) + buffer_size; }
+};
+
+#endif // URING_LOOP_H
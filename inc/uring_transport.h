@@ -0,0 +1,45 @@
+#ifndef URING_TRANSPORT_H
+#define URING_TRANSPORT_H
+
+#include "transport.h"
+#include "uring_loop.h"
+
+// io_uring 传输层
+// 打开和串口参数配置交给内部传输层（libserialport 或 termios），读写改由 UringLoop 完成：
+// 接收数据在完成事件中推送给 setReceiver() 设置的处理函数（协议解码器），read() 不再返回数据；
+// write() 只把数据放入发送缓冲区，由主循环的下一次 runOnce() 批量提交。
+class UringTransport : public Transport {
+private:
+    UringLoop& loop;
+    std::unique_ptr<Transport> inner;
+    int port_id;
+    bool failed;
+    UringLoop::DataHandler receiver;
+    UringLoop::ErrorHandler error_handler;
+
+public:
+    UringTransport(UringLoop& loop, std::unique_ptr<Transport> inner);
+    ~UringTransport() override;
+
+    // 必须在 open() 之前设置：接收数据的处理函数和读写出错时的处理函数（通常触发断线重连）
+    void setReceiver(UringLoop::DataHandler handler) { receiver = std::move(handler); }
+    void setErrorHandler(UringLoop::ErrorHandler handler) { error_handler = std::move(handler); }
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return port_id >= 0; }
+
+    // 接收数据通过完成事件推送；返回-1表示端口已出错，需要重连
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override;
+    int readNonblocking(uint8_t* buffer, size_t n) override;
+    int write(const uint8_t* data, size_t length) override;
+    // 发送由事件循环批量提交，这里不等待（等待 tcdrain 会抵消批量提交的收益）
+    bool drain() override { return port_id >= 0; }
+    bool flushInput() override { return inner->flushInput(); }
+    int inputWaiting() override { return 0; }
+
+    int getFileDescriptor() const override { return inner->getFileDescriptor(); }
+    std::string getName() const override { return inner->getName(); }
+};
+
+#endif // URING_TRANSPORT_H
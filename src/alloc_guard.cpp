@@ -0,0 +1,114 @@
+#include "alloc_guard.h"
+#include <cassert>
+#include <cstdio>
+
+#ifdef UART_ALLOC_GUARD
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local bool armed = false;
+thread_local uint64_t armed_allocations = 0;
+
+void* countedAlloc(std::size_t size) {
+    if (armed) {
+        ++armed_allocations;
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+} // namespace
+
+// 替换全局分配函数（默认的 operator delete 使用 free，与这里的 malloc 配对）
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace alloc_guard {
+
+bool available() {
+    return true;
+}
+
+void arm() {
+    armed_allocations = 0;
+    armed = true;
+}
+
+void disarm() {
+    armed = false;
+}
+
+uint64_t allocations() {
+    return armed_allocations;
+}
+
+} // namespace alloc_guard
+
+#else
+
+namespace alloc_guard {
+
+bool available() {
+    return false;
+}
+
+void arm() {}
+
+void disarm() {}
+
+uint64_t allocations() {
+    return 0;
+}
+
+} // namespace alloc_guard
+
+#endif // UART_ALLOC_GUARD
+
+namespace alloc_guard {
+
+void reportViolation(uint64_t count, uint64_t iteration) {
+    // 使用stdio避免在报告时再次触发分配
+    std::fprintf(stderr, "分配检查失败: 稳态主循环第%llu次迭代发生了%llu次堆分配\n",
+                 static_cast<unsigned long long>(iteration), static_cast<unsigned long long>(count));
+    assert(count == 0 && "实时模式稳态主循环不应发生堆分配");
+}
+
+} // namespace alloc_guard
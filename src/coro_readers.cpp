@@ -0,0 +1,110 @@
+#include "coro_readers.h"
+#include "uart_reader.h"
+#include "serial_screen_protocol.h"
+#include <vector>
+
+namespace {
+
+const int RECONNECT_POLL_MS = 50;      // 断线时检查重连的间隔
+const int IDLE_TIMEOUT_MS = 1000;      // 无数据时检查设备节点的间隔
+const int TX_POLL_MS = 5;              // 没有待写命令时写协程的检查间隔
+const size_t READ_CHUNK = 4096;        // 每次最多取走的已到达字节数
+const size_t WRITE_CHUNK = 256;        // 每次最多写出的字节数
+
+// 一次串口屏连接期间读写协程共用的状态，位于读协程的帧中
+struct ScreenLink {
+    AsyncPort& port;
+    bool writer_done = false;
+};
+
+// 串口屏写协程：从协议取出待写字节并等待 AsyncPort 写完，内核缓冲区满时挂起而不阻塞线程
+Task<void> runSerialScreenWriter(Scheduler& scheduler, SerialScreenProtocol& screen, ScreenLink& link) {
+    std::vector<uint8_t> chunk(WRITE_CHUNK);
+    while (scheduler.isRunning() && !link.port.hasError()) {
+        size_t n = screen.takeTxPending(chunk.data(), chunk.size());
+        if (n == 0) {
+            co_await scheduler.sleep(TX_POLL_MS);
+            continue;
+        }
+        if (co_await link.port.write(chunk.data(), n) < 0) {
+            break; // 写入错误由读协程按断线处理
+        }
+    }
+    link.writer_done = true;
+}
+
+} // namespace
+
+Task<void> runCurrentPowerReader(Scheduler& scheduler, UartReader& reader) {
+    std::vector<uint8_t> buffer(READ_CHUNK);
+
+    while (scheduler.isRunning()) {
+        if (!reader.isConnected()) {
+            reader.maintainConnection();
+            co_await scheduler.sleep(RECONNECT_POLL_MS);
+            continue;
+        }
+
+        AsyncPort port(scheduler, reader.getFileDescriptor());
+        while (scheduler.isRunning() && !port.hasError()) {
+            // 等待第一个字节，然后取走已到达的全部字节
+            int n = co_await port.readExact(buffer.data(), 1, IDLE_TIMEOUT_MS);
+            if (n == 0) {
+                reader.checkDevicePresent();
+                if (!reader.isConnected()) {
+                    break;
+                }
+                continue;
+            }
+            if (n > 0) {
+                int more = co_await port.readExact(buffer.data() + 1, buffer.size() - 1, 0);
+                reader.feed(buffer.data(), more > 0 ? 1 + static_cast<size_t>(more) : 1);
+            }
+        }
+
+        if (port.hasError() && reader.isConnected()) {
+            reader.handleDisconnect("读取错误");
+        }
+    }
+}
+
+Task<void> runSerialScreenReader(Scheduler& scheduler, SerialScreenProtocol& screen) {
+    std::vector<uint8_t> buffer(READ_CHUNK);
+
+    while (scheduler.isRunning()) {
+        if (!screen.isConnected()) {
+            screen.maintainConnection();
+            co_await scheduler.sleep(RECONNECT_POLL_MS);
+            continue;
+        }
+
+        AsyncPort port(scheduler, screen.getFileDescriptor());
+        ScreenLink link{port};
+        scheduler.spawn(runSerialScreenWriter(scheduler, screen, link));
+        while (scheduler.isRunning() && !port.hasError()) {
+            // 等待第一个字节，然后取走已到达的全部字节
+            int n = co_await port.readExact(buffer.data(), 1, IDLE_TIMEOUT_MS);
+            if (n == 0) {
+                screen.checkDevicePresent();
+                if (!screen.isConnected()) {
+                    break;
+                }
+                continue;
+            }
+            if (n > 0) {
+                int more = co_await port.readExact(buffer.data() + 1, buffer.size() - 1, 0);
+                screen.feed(buffer.data(), more > 0 ? 1 + static_cast<size_t>(more) : 1);
+            }
+        }
+
+        bool write_error = port.hasError();
+        // 唤醒挂起在 write 上的写协程，等它结束后再销毁 AsyncPort
+        port.cancel();
+        while (!link.writer_done) {
+            co_await scheduler.sleep(1);
+        }
+        if (write_error && screen.isConnected()) {
+            screen.handleDisconnect("读写错误");
+        }
+    }
+}
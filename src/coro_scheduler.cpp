@@ -0,0 +1,360 @@
+#include "coro_scheduler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// ============================== Scheduler ==============================
+
+Scheduler::Scheduler() : epoll_fd(epoll_create1(EPOLL_CLOEXEC)), running(true) {
+    if (epoll_fd < 0) {
+        std::cerr << "无法创建epoll: " << std::strerror(errno) << std::endl;
+    }
+    ready.reserve(64);
+    ready_swap.reserve(64);
+    timers.reserve(64);
+}
+
+Scheduler::~Scheduler() {
+    // 先清空定时器，再销毁仍在挂起中的任务帧
+    timers.clear();
+    ready.clear();
+    for (auto& handle : tasks) {
+        handle.destroy();
+    }
+    tasks.clear();
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+void Scheduler::spawn(Task<void> task) {
+    auto handle = task.release();
+    if (!handle) {
+        return;
+    }
+    tasks.push_back(handle);
+    schedule(handle);
+}
+
+void Scheduler::schedule(std::coroutine_handle<> h) {
+    ready.push_back(h);
+}
+
+void Scheduler::addTimer(Clock::time_point deadline, TimerWaiter* waiter) {
+    timers.push_back(TimerEntry{deadline, waiter, waiter->generation});
+    std::push_heap(timers.begin(), timers.end(), TimerLater());
+}
+
+void Scheduler::removeTimers(TimerWaiter* waiter) {
+    // 只在端口销毁时调用，线性扫描即可
+    auto it = std::remove_if(timers.begin(), timers.end(),
+                             [waiter](const TimerEntry& e) { return e.waiter == waiter; });
+    if (it != timers.end()) {
+        timers.erase(it, timers.end());
+        std::make_heap(timers.begin(), timers.end(), TimerLater());
+    }
+}
+
+bool Scheduler::watch(int fd, AsyncPort* port) {
+    // 边沿触发：AsyncPort 每次发起读写前都会先主动尝试，不依赖事件补发
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+    ev.data.ptr = port;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        std::cerr << "无法将串口加入epoll: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Scheduler::unwatch(int fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int Scheduler::nextTimeoutMs(int max_wait_ms) const {
+    if (!ready.empty()) {
+        return 0;
+    }
+    if (timers.empty()) {
+        return max_wait_ms;
+    }
+    auto until = std::chrono::duration_cast<std::chrono::milliseconds>(
+        timers.front().deadline - Clock::now()).count();
+    // 向上取整，避免在到期前反复空转
+    int ms = until <= 0 ? 0 : static_cast<int>(until) + 1;
+    return (max_wait_ms < 0 || ms < max_wait_ms) ? ms : max_wait_ms;
+}
+
+void Scheduler::fireTimers() {
+    auto now = Clock::now();
+    while (!timers.empty() && timers.front().deadline <= now) {
+        std::pop_heap(timers.begin(), timers.end(), TimerLater());
+        TimerEntry entry = timers.back();
+        timers.pop_back();
+        // 代数不一致说明该等待者已经完成或被取消
+        if (entry.waiter->generation == entry.generation && entry.waiter->on_timeout) {
+            ++entry.waiter->generation;
+            entry.waiter->on_timeout(entry.waiter);
+        }
+    }
+}
+
+void Scheduler::resumeReady() {
+    // 恢复过程中可能产生新的就绪协程，交换缓冲区避免迭代失效
+    while (!ready.empty()) {
+        ready_swap.swap(ready);
+        for (auto handle : ready_swap) {
+            handle.resume();
+        }
+        ready_swap.clear();
+    }
+}
+
+void Scheduler::reapTasks() {
+    for (size_t i = 0; i < tasks.size();) {
+        if (tasks[i].done()) {
+            tasks[i].destroy();
+            tasks[i] = tasks.back();
+            tasks.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Scheduler::runOnce(int max_wait_ms) {
+    resumeReady();
+
+    struct epoll_event events[64];
+    int n = epoll_wait(epoll_fd, events, 64, nextTimeoutMs(max_wait_ms));
+    for (int i = 0; i < n; ++i) {
+        auto* port = static_cast<AsyncPort*>(events[i].data.ptr);
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            port->onError();
+            continue;
+        }
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+            port->onReadable();
+        }
+        if (events[i].events & EPOLLOUT) {
+            port->onWritable();
+        }
+    }
+
+    fireTimers();
+    resumeReady();
+    reapTasks();
+}
+
+void Scheduler::run() {
+    running = true;
+    while (running && !tasks.empty()) {
+        runOnce(-1);
+    }
+}
+
+// ============================== 等待体 ==============================
+
+bool ReadOperation::await_ready() {
+    port->fillFromFd();
+    got = port->take(buffer, n);
+    return got == n || port->error || timeout_ms == 0;
+}
+
+void ReadOperation::await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    port->pending_read = this;
+    port->read_waiter.handle = h;
+    if (timeout_ms > 0) {
+        port->scheduler.addTimer(Scheduler::Clock::now() + std::chrono::milliseconds(timeout_ms),
+                                 &port->read_waiter);
+    }
+}
+
+int ReadOperation::await_resume() const {
+    if (port->error && got < n) {
+        return -1;
+    }
+    return static_cast<int>(got);
+}
+
+bool WriteOperation::await_ready() {
+    if (port->write_head) {
+        return false; // 前面还有等待中的写操作，排队保证顺序
+    }
+    written = port->writeSome(data, length);
+    failed = port->error && written < length;
+    return written == length || port->error;
+}
+
+void WriteOperation::await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    if (port->write_tail) {
+        port->write_tail->next = this;
+    } else {
+        port->write_head = this;
+    }
+    port->write_tail = this;
+}
+
+int WriteOperation::await_resume() const {
+    // 不访问 port：取消后恢复时 AsyncPort 可能已经销毁
+    return failed ? -1 : static_cast<int>(written);
+}
+
+// ============================== AsyncPort ==============================
+
+AsyncPort::AsyncPort(Scheduler& scheduler, int fd, size_t rx_capacity)
+    : scheduler(scheduler), fd(fd), registered(false), error(false),
+      rx(rx_capacity), rx_head(0), rx_tail(0),
+      pending_read(nullptr), write_head(nullptr), write_tail(nullptr) {
+    read_waiter.on_timeout = &AsyncPort::onReadTimeout;
+    read_waiter.context = this;
+
+    if (fd < 0) {
+        error = true;
+        return;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+    registered = scheduler.watch(fd, this);
+    if (!registered) {
+        error = true;
+    }
+}
+
+AsyncPort::~AsyncPort() {
+    scheduler.removeTimers(&read_waiter);
+    if (registered) {
+        scheduler.unwatch(fd);
+    }
+}
+
+void AsyncPort::fillFromFd() {
+    if (error) {
+        return;
+    }
+    // 压缩缓冲区，为新数据腾出空间
+    if (rx_head > 0 && rx_head == rx_tail) {
+        rx_head = rx_tail = 0;
+    } else if (rx_head > rx.size() / 2) {
+        std::memmove(rx.data(), rx.data() + rx_head, rx_tail - rx_head);
+        rx_tail -= rx_head;
+        rx_head = 0;
+    }
+
+    while (rx_tail < rx.size()) {
+        ssize_t n = ::read(fd, rx.data() + rx_tail, rx.size() - rx_tail);
+        if (n > 0) {
+            rx_tail += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            // VMIN=VTIME=0 的 tty 没有数据时返回0而不是EAGAIN；真正的挂断由 EPOLLHUP 经 onError() 报告
+            return;
+        }
+        error = true; // 读取出错：设备已断开
+        return;
+    }
+}
+
+size_t AsyncPort::take(uint8_t* buffer, size_t n) {
+    size_t available = rx_tail - rx_head;
+    size_t count = available < n ? available : n;
+    std::memcpy(buffer, rx.data() + rx_head, count);
+    rx_head += count;
+    return count;
+}
+
+size_t AsyncPort::writeSome(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && !error) {
+        ssize_t n = ::write(fd, data + written, length - written);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            error = true;
+        }
+    }
+    return written;
+}
+
+void AsyncPort::tryCompleteRead() {
+    if (!pending_read) {
+        return;
+    }
+    ReadOperation* op = pending_read;
+    op->got += take(op->buffer + op->got, op->n - op->got);
+    if (op->got == op->n || error) {
+        pending_read = nullptr;
+        ++read_waiter.generation; // 使超时定时器失效
+        scheduler.schedule(op->handle);
+    }
+}
+
+void AsyncPort::progressWrites() {
+    while (write_head) {
+        WriteOperation* op = write_head;
+        if (!error) {
+            op->written += writeSome(op->data + op->written, op->length - op->written);
+            if (op->written < op->length && !error) {
+                return; // 内核缓冲区已满，等待 EPOLLOUT
+            }
+        }
+        op->failed = error && op->written < op->length;
+        write_head = op->next;
+        if (!write_head) {
+            write_tail = nullptr;
+        }
+        scheduler.schedule(op->handle);
+    }
+}
+
+void AsyncPort::onReadable() {
+    fillFromFd();
+    tryCompleteRead();
+}
+
+void AsyncPort::onWritable() {
+    progressWrites();
+}
+
+void AsyncPort::cancel() {
+    error = true;
+    tryCompleteRead();
+    progressWrites();
+}
+
+void AsyncPort::onError() {
+    fillFromFd(); // 取走断开前残留的数据
+    error = true;
+    tryCompleteRead();
+    progressWrites();
+}
+
+void AsyncPort::onReadTimeout(TimerWaiter* waiter) {
+    auto* self = static_cast<AsyncPort*>(waiter->context);
+    ReadOperation* op = self->pending_read;
+    if (!op) {
+        return;
+    }
+    self->pending_read = nullptr;
+    self->scheduler.schedule(op->handle);
+}
@@ -3,12 +3,41 @@
 #include <iomanip>
 #include <cstring>
 
-CurrentPowerProtocol::CurrentPowerProtocol() : currentPowerCallback(nullptr) {}
+CurrentPowerProtocol::CurrentPowerProtocol()
+    : currentPowerCallback(nullptr), sequence_mode(SequenceMode::LEGACY), extended_active(false),
+      next_report(FrameSequenceTracker::Clock::now()), verbose(true) {}
 
 void CurrentPowerProtocol::setCurrentPowerCallback(std::function<void(float, float)> callback) {
     currentPowerCallback = callback;
 }
 
+void CurrentPowerProtocol::setSequenceMode(SequenceMode mode, double tick_hz) {
+    sequence_mode = mode;
+    extended_active = (mode == SequenceMode::EXTENDED);
+    sequence = FrameSequenceTracker(tick_hz);
+    next_report = FrameSequenceTracker::Clock::now() + std::chrono::seconds(SEQUENCE_REPORT_INTERVAL_S);
+}
+
+void CurrentPowerProtocol::reset() {
+    // 重连后接上的可能是换过固件的传感器，不沿用断线前检测到的帧格式
+    extended_active = (sequence_mode == SequenceMode::EXTENDED);
+    sequence.reset();
+    next_report = FrameSequenceTracker::Clock::now() + std::chrono::seconds(SEQUENCE_REPORT_INTERVAL_S);
+}
+
+bool CurrentPowerProtocol::parseSequenceMode(const std::string& name, SequenceMode& mode) {
+    if (name == "legacy") {
+        mode = SequenceMode::LEGACY;
+    } else if (name == "extended") {
+        mode = SequenceMode::EXTENDED;
+    } else if (name == "auto") {
+        mode = SequenceMode::AUTO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 bool CurrentPowerProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
     if (!isValidFrame(frame_data)) {
         return false;
@@ -31,29 +60,76 @@ bool CurrentPowerProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
         }
     }
 
-    // 打印结果
-    std::cout << "\n=== 电流功率协议数据帧解析结果 ===" << std::endl;
-    std::cout << "电流 I: " << std::fixed << std::setprecision(3) << current << " A" << std::endl;
-    std::cout << "功率 W: " << std::fixed << std::setprecision(3) << power << " W" << std::endl;
-    std::cout << "剩余字节验证: " << (remaining_zeros ? "通过" : "失败") << std::endl;
-    
-    // 打印原始数据
-    std::cout << "原始数据: ";
-    for (size_t i = 0; i < frame_data.size(); ++i) {
-        std::cout << std::hex << std::setfill('0') << std::setw(2) 
-                  << static_cast<int>(frame_data[i]) << " ";
+    // 新固件在保留字节中写入帧序号和设备时刻（AUTO 模式遇到第一个非零帧后切换）
+    if (sequence_mode == SequenceMode::AUTO && !extended_active && !remaining_zeros) {
+        extended_active = true;
+        if (verbose) {
+            std::cout << "*** 检测到扩展帧格式，启用帧序号统计 ***" << std::endl;
+        }
+    }
+    uint32_t frame_sequence = 0;
+    uint32_t device_tick = 0;
+    if (extended_active) {
+        // 小端 uint32，与浮点字段相同的字节序
+        for (int i = 3; i >= 0; --i) {
+            frame_sequence = (frame_sequence << 8) | frame_data[10 + i];
+            device_tick = (device_tick << 8) | frame_data[14 + i];
+        }
+        sequence.observe(frame_sequence, device_tick);
+    }
+
+    if (verbose) {
+        // 打印结果
+        std::cout << "\n=== 电流功率协议数据帧解析结果 ===" << std::endl;
+        std::cout << "电流 I: " << std::fixed << std::setprecision(3) << current << " A" << std::endl;
+        std::cout << "功率 W: " << std::fixed << std::setprecision(3) << power << " W" << std::endl;
+        if (extended_active) {
+            std::cout << "帧序号: " << frame_sequence << " 设备时刻: " << device_tick << std::endl;
+        } else {
+            std::cout << "剩余字节验证: " << (remaining_zeros ? "通过" : "失败") << std::endl;
+        }
+        
+        // 打印原始数据
+        std::cout << "原始数据: ";
+        for (size_t i = 0; i < frame_data.size(); ++i) {
+            std::cout << std::hex << std::setfill('0') << std::setw(2) 
+                      << static_cast<int>(frame_data[i]) << " ";
+        }
+        std::cout << std::dec << std::endl;
+        std::cout << "=====================================\n" << std::endl;
     }
-    std::cout << std::dec << std::endl;
-    std::cout << "=====================================\n" << std::endl;
     
     // 调用回调函数通知串口屏协议
     if (currentPowerCallback) {
         currentPowerCallback(current, power);
     }
     
+    if (verbose && extended_active && FrameSequenceTracker::Clock::now() >= next_report) {
+        reportSequenceStats();
+    }
+    
     return true;
 }
 
+void CurrentPowerProtocol::reportSequenceStats() {
+    auto now = FrameSequenceTracker::Clock::now();
+    next_report = now + std::chrono::seconds(SEQUENCE_REPORT_INTERVAL_S);
+    FrameSequenceTracker::Window window = sequence.takeWindow(now);
+    const auto& stats = sequence.getStats();
+
+    std::cout << "\n=== 帧序号统计 ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "最近 " << window.seconds << " s: 收到 " << window.frames << " 帧, 丢失 " << window.lost
+              << " 帧, 丢帧率 " << window.lossRate() * 100.0 << " %" << std::endl;
+    std::cout << "累计: 收到 " << stats.frames << " 帧, 丢失 " << stats.lost << " 帧 (" << stats.gaps
+              << " 处跳变), 重复 " << stats.duplicates << ", 序号重置 " << stats.resets
+              << ", 丢帧率 " << sequence.lossRate() * 100.0 << " %" << std::endl;
+    if (stats.drift_valid) {
+        std::cout << "传感器时钟漂移: " << std::setprecision(1) << stats.drift_ppm << " ppm" << std::endl;
+    }
+    std::cout << "==================\n" << std::endl;
+}
+
 bool CurrentPowerProtocol::isValidFrame(const std::vector<uint8_t>& frame_data) {
     if (frame_data.size() != FRAME_SIZE) {
         return false;
@@ -80,19 +156,24 @@ std::string CurrentPowerProtocol::getProtocolName() const {
     return "电流功率协议";
 }
 
-bool CurrentPowerProtocol::findFrameHeader(struct sp_port* port) {
+std::vector<FrameFormat> CurrentPowerProtocol::getFrameFormats() const {
+    // AA AA + 16字节数据 + FF FF
+    return {FrameFormat{{0xAA, 0xAA}, {0xFF, 0xFF}, FRAME_SIZE}};
+}
+
+bool CurrentPowerProtocol::findFrameHeader(Transport& transport) {
     uint8_t buffer[2];
-    size_t bytes_read;
+    int bytes_read;
     
     do {
-        bytes_read = sp_blocking_read(port, buffer, 1, 10); // 减少超时时间到10ms
-        if (bytes_read == 0) {
+        bytes_read = transport.read(buffer, 1, 10); // 减少超时时间到10ms
+        if (bytes_read <= 0) {
             return false; // 超时
         }
     } while (buffer[0] != 0xAA);
 
-    bytes_read = sp_blocking_read(port, buffer + 1, 1, 10); // 减少超时时间到10ms
-    if (bytes_read == 0 || buffer[1] != 0xAA) {
+    bytes_read = transport.read(buffer + 1, 1, 10); // 减少超时时间到10ms
+    if (bytes_read <= 0 || buffer[1] != 0xAA) {
         return false;
     }
 
@@ -0,0 +1,327 @@
+#include "fd_transport.h"
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+namespace {
+
+speed_t toSpeed(int baud_rate) {
+    switch (baud_rate) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return 0;
+    }
+}
+
+} // namespace
+
+// ============================== FdTransport ==============================
+
+FdTransport::FdTransport(const std::string& name, const SerialSettings& settings)
+    : name(name), settings(settings), fd(-1), kernel_timed(false) {}
+
+FdTransport::~FdTransport() {
+    FdTransport::close();
+}
+
+void FdTransport::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int FdTransport::read(uint8_t* buffer, size_t n, unsigned int timeout_ms) {
+    if (fd < 0) {
+        return -1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+    size_t got = 0;
+
+    while (got < n) {
+        if (kernel_timed) {
+            // 已缓冲但不足 VMIN 的字节 poll 不会报告可读，先直接取走
+            ssize_t r = readAvailable(buffer + got, n - got);
+            if (r > 0) {
+                got += static_cast<size_t>(r);
+                continue;
+            }
+            if (r < 0 && errno != EAGAIN && errno != EINTR) {
+                return -1;
+            }
+        }
+
+        // 等待可读再读取：VMIN 生效时内核攒够 VMIN 字节才唤醒，总等待时间不超过 timeout_ms
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left < 0) {
+            left = 0;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, static_cast<int>(left));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (ready == 0) {
+            break; // 超时
+        }
+        if (!(pfd.revents & POLLIN)) {
+            return -1; // POLLERR/POLLHUP：设备断开
+        }
+
+        ssize_t r = readAvailable(buffer + got, n - got);
+        if (r > 0) {
+            got += static_cast<size_t>(r);
+            continue;
+        }
+        if (r < 0 && (errno == EAGAIN || errno == EINTR)) {
+            continue;
+        }
+        return -1; // 可读却读到0字节或出错：设备断开
+    }
+    return static_cast<int>(got);
+}
+
+int FdTransport::readNonblocking(uint8_t* buffer, size_t n) {
+    if (fd < 0) {
+        return -1;
+    }
+    if (kernel_timed) {
+        // 阻塞fd：poll 只用来发现断线，是否有数据以 FIONREAD 为准（不足 VMIN 时 poll 不报告可读）
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) < 0) {
+            return errno == EINTR ? 0 : -1;
+        }
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            return -1;
+        }
+    }
+    // VMIN=VTIME=0 的 tty 没有数据时返回0而不是EAGAIN，断线由 EIO 或设备节点检查发现
+    ssize_t r = readAvailable(buffer, n);
+    if (r < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    return static_cast<int>(r);
+}
+
+ssize_t FdTransport::readAvailable(uint8_t* buffer, size_t n) {
+    if (kernel_timed) {
+        // 阻塞fd：只请求已缓冲的字节数，读操作不会再等待 VMIN 个字节或 VTIME 间隔
+        int waiting = 0;
+        if (::ioctl(fd, FIONREAD, &waiting) != 0) {
+            return -1;
+        }
+        if (waiting <= 0) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (static_cast<size_t>(waiting) < n) {
+            n = static_cast<size_t>(waiting);
+        }
+    }
+    return ::read(fd, buffer, n);
+}
+
+int FdTransport::write(const uint8_t* data, size_t length) {
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t r = ::write(fd, data, length);
+    if (r < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    return static_cast<int>(r);
+}
+
+int FdTransport::writev(const struct iovec* iov, int iovcnt) {
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t r = ::writev(fd, iov, iovcnt);
+    if (r < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    return static_cast<int>(r);
+}
+
+bool FdTransport::drain() {
+    if (fd < 0) {
+        return false;
+    }
+    // 伪终端等非tty设备不支持 tcdrain，视为已发送
+    return ::tcdrain(fd) == 0 || errno == ENOTTY || errno == EINVAL;
+}
+
+bool FdTransport::flushInput() {
+    if (fd < 0) {
+        return false;
+    }
+    return ::tcflush(fd, TCIFLUSH) == 0 || errno == ENOTTY;
+}
+
+int FdTransport::inputWaiting() {
+    if (fd < 0) {
+        return -1;
+    }
+    int waiting = 0;
+    if (::ioctl(fd, FIONREAD, &waiting) != 0) {
+        return -1;
+    }
+    return waiting;
+}
+
+// ============================== TermiosTransport ==============================
+
+TermiosTransport::TermiosTransport(const std::string& port_name, const SerialSettings& settings)
+    : FdTransport(port_name, settings) {}
+
+bool TermiosTransport::open() {
+    int flags = (settings.read_write ? O_RDWR : O_RDONLY) | O_NOCTTY | O_NONBLOCK | O_CLOEXEC;
+    fd = ::open(name.c_str(), flags);
+    if (fd < 0) {
+        std::cerr << "无法打开串口: " << name << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    if (!configure()) {
+        close();
+        return false;
+    }
+
+    // 配置了 VMIN/VTIME 时切换回阻塞模式，让内核在凑够字节或超时后才唤醒
+    kernel_timed = settings.vmin > 0 || settings.vtime > 0;
+    if (kernel_timed) {
+        int fl = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, fl & ~O_NONBLOCK);
+    }
+
+    if (settings.low_latency) {
+        setLowLatency();
+    }
+
+    std::cout << "成功打开串口(termios): " << name << " 波特率: " << settings.baud_rate
+              << " 数据位: " << settings.data_bits << " 停止位: " << settings.stop_bits
+              << " VMIN: " << settings.vmin << " VTIME: " << settings.vtime << std::endl;
+    return true;
+}
+
+bool TermiosTransport::configure() {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        std::cerr << "无法读取串口参数: " << name << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    cfmakeraw(&tio);
+
+    speed_t speed = toSpeed(settings.baud_rate);
+    if (speed == 0) {
+        std::cerr << "不支持的波特率: " << settings.baud_rate << std::endl;
+        return false;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    // 数据位
+    tio.c_cflag &= ~CSIZE;
+    switch (settings.data_bits) {
+        case 5: tio.c_cflag |= CS5; break;
+        case 6: tio.c_cflag |= CS6; break;
+        case 7: tio.c_cflag |= CS7; break;
+        default: tio.c_cflag |= CS8; break;
+    }
+
+    // 停止位、无校验、无流控制
+    if (settings.stop_bits == 2) {
+        tio.c_cflag |= CSTOPB;
+    } else {
+        tio.c_cflag &= ~CSTOPB;
+    }
+    tio.c_cflag &= ~(PARENB | CRTSCTS);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+    tio.c_cc[VMIN] = static_cast<cc_t>(settings.vmin);
+    tio.c_cc[VTIME] = static_cast<cc_t>(settings.vtime);
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        std::cerr << "无法设置串口参数: " << name << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TermiosTransport::setLowLatency() {
+    // USB转串口驱动默认会攒数据再上报，ASYNC_LOW_LATENCY 让驱动尽快交付；不支持时忽略
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+}
+
+// ============================== PtyTransport ==============================
+
+PtyTransport::PtyTransport(const SerialSettings& settings)
+    : FdTransport("pty", settings), slave_fd(-1) {}
+
+PtyTransport::~PtyTransport() {
+    PtyTransport::close();
+}
+
+bool PtyTransport::open() {
+    fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        std::cerr << "无法创建伪终端: " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    const char* path = ptsname(fd);
+    if (!path) {
+        close();
+        return false;
+    }
+    slave_path = path;
+    name = slave_path;
+
+    // 从端设为原始模式，保证所有字节原样传输
+    slave_fd = ::open(slave_path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave_fd >= 0) {
+        struct termios tio;
+        if (tcgetattr(slave_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(slave_fd, TCSANOW, &tio);
+        }
+    }
+    return true;
+}
+
+void PtyTransport::close() {
+    if (slave_fd >= 0) {
+        ::close(slave_fd);
+        slave_fd = -1;
+    }
+    FdTransport::close();
+}
@@ -0,0 +1,146 @@
+#include "frame_demux.h"
+#include <iostream>
+#include <cstring>
+
+namespace {
+// 候选拒绝记录用位掩码，最多支持的帧格式数
+const size_t MAX_ROUTES = 32;
+}
+
+FrameDemux::FrameDemux(size_t window_size)
+    : window(window_size), head(0), tail(0), min_frame_size(0), max_frame_size(0) {}
+
+void FrameDemux::addProtocol(Protocol& protocol) {
+    for (const FrameFormat& format : protocol.getFrameFormats()) {
+        if (format.header.empty() || format.header.size() + format.trailer.size() > format.size) {
+            std::cerr << "忽略无效的帧格式: " << protocol.getProtocolName() << std::endl;
+            continue;
+        }
+        if (routes.size() >= MAX_ROUTES) {
+            std::cerr << "帧格式过多，忽略: " << protocol.getProtocolName() << std::endl;
+            break;
+        }
+        Route route;
+        route.owner = &protocol;
+        route.format = format;
+        route.frame.reserve(format.size);
+        routes.push_back(std::move(route));
+
+        if (min_frame_size == 0 || format.size < min_frame_size) {
+            min_frame_size = format.size;
+        }
+        if (format.size > max_frame_size) {
+            max_frame_size = format.size;
+        }
+    }
+    // 窗口至少容纳两帧，保证压缩后总有空间接收新字节
+    if (window.size() < 2 * max_frame_size) {
+        window.resize(2 * max_frame_size);
+    }
+}
+
+void FrameDemux::reset() {
+    head = 0;
+    tail = 0;
+}
+
+size_t FrameDemux::feed(const uint8_t* data, size_t length) {
+    size_t frames = 0;
+    while (length > 0) {
+        if (tail == window.size()) {
+            // 窗口尾部已满：未消耗的字节（不足一帧）移到开头
+            std::memmove(window.data(), window.data() + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+        size_t n = window.size() - tail;
+        if (n > length) {
+            n = length;
+        }
+        std::memcpy(window.data() + tail, data, n);
+        tail += n;
+        data += n;
+        length -= n;
+        frames += scan(false);
+    }
+    return frames;
+}
+
+size_t FrameDemux::flush() {
+    return scan(true);
+}
+
+size_t FrameDemux::scan(bool idle) {
+    size_t frames = 0;
+    while (head < tail) {
+        const uint8_t* p = window.data() + head;
+        size_t available = tail - head;
+        Route* best = nullptr;
+        size_t valid = 0;
+        size_t pending_size = 0;        // 帧头匹配但字节尚未到齐的最长候选
+        uint32_t rejected_mask = 0;
+
+        for (size_t i = 0; i < routes.size(); ++i) {
+            Route& route = routes[i];
+            const FrameFormat& format = route.format;
+            size_t check = format.header.size() < available ? format.header.size() : available;
+            if (std::memcmp(p, format.header.data(), check) != 0) {
+                continue;
+            }
+            if (available < format.size) {
+                if (format.size > pending_size) {
+                    pending_size = format.size;
+                }
+                continue;
+            }
+            bool ok = std::memcmp(p + format.size - format.trailer.size(), format.trailer.data(),
+                                  format.trailer.size()) == 0;
+            if (ok) {
+                route.frame.assign(p, p + format.size);
+                ok = route.owner->isValidFrame(route.frame);
+            }
+            if (!ok) {
+                rejected_mask |= 1u << i;
+                continue;
+            }
+            ++valid;
+            // 多个候选同时通过时取最长的一帧（校验过的字节最多）
+            if (!best || format.size > best->format.size) {
+                best = &route;
+            }
+        }
+
+        // 完整的候选都比等待中的候选短：等更长的候选到齐后再裁决
+        if (pending_size > 0 && !idle) {
+            break;
+        }
+
+        for (size_t i = 0; i < routes.size(); ++i) {
+            if (rejected_mask & (1u << i)) {
+                ++routes[i].rejected;
+                ++stats.rejected;
+            }
+        }
+
+        if (best) {
+            if (valid > 1) {
+                ++stats.ambiguous;
+            }
+            head += best->format.size;
+            if (best->owner->parseFrame(best->frame)) {
+                ++best->frames;
+                ++stats.frames;
+                ++frames;
+            }
+        } else {
+            // 当前位置不是任何帧的开始：只丢弃一个字节，后面的字节可能属于其他协议的帧
+            ++head;
+            ++stats.discarded_bytes;
+        }
+    }
+    if (head == tail) {
+        head = 0;
+        tail = 0;
+    }
+    return frames;
+}
@@ -0,0 +1,91 @@
+#include "frame_sequence.h"
+
+namespace {
+// 拟合跨度至少这么长才输出漂移，避免主机接收抖动主导结果
+const double MIN_DRIFT_SPAN_S = 2.0;
+}
+
+FrameSequenceTracker::FrameSequenceTracker(double tick_hz, uint32_t max_gap)
+    : tick_hz(tick_hz > 0.0 ? tick_hz : 1000.0), max_gap(max_gap), started(false), last_tick(0), device_ticks(0),
+      sum_x(0.0), sum_y(0.0), sum_xx(0.0), sum_xy(0.0), fit_count(0), window_start(Clock::now()) {}
+
+void FrameSequenceTracker::reset() {
+    // 下一帧重新建立序号和时钟基准；断线期间的丢帧无法从序号推算，累计统计保留
+    started = false;
+    fit_count = 0;
+    stats.drift_valid = false;
+}
+
+void FrameSequenceTracker::restartFit(uint32_t tick, Clock::time_point now) {
+    host_base = now;
+    last_tick = tick;
+    device_ticks = 0;
+    sum_x = sum_y = sum_xx = sum_xy = 0.0;
+    fit_count = 0;
+    stats.drift_valid = false;
+}
+
+void FrameSequenceTracker::observe(uint32_t sequence, uint32_t tick, Clock::time_point now) {
+    ++stats.frames;
+    ++window.frames;
+
+    if (!started) {
+        started = true;
+        stats.last_sequence = sequence;
+        restartFit(tick, now);
+        return;
+    }
+
+    // 无符号差值自动处理32位回绕
+    uint32_t delta = sequence - stats.last_sequence;
+    if (delta == 0) {
+        ++stats.duplicates;
+        return; // 重复帧不参与漂移拟合
+    }
+    if (delta > max_gap) {
+        // 序号回退或跳变过大：传感器重启，重新建立基准
+        ++stats.resets;
+        stats.last_sequence = sequence;
+        restartFit(tick, now);
+        return;
+    }
+    if (delta > 1) {
+        ++stats.gaps;
+        stats.lost += delta - 1;
+        window.lost += delta - 1;
+    }
+    stats.last_sequence = sequence;
+
+    // 设备时刻同样按无符号差值展开回绕
+    device_ticks += static_cast<uint32_t>(tick - last_tick);
+    last_tick = tick;
+
+    double x = std::chrono::duration<double>(now - host_base).count();
+    double y = static_cast<double>(device_ticks) / tick_hz - x;
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+    ++fit_count;
+
+    double n = static_cast<double>(fit_count);
+    double denom = n * sum_xx - sum_x * sum_x;
+    if (fit_count >= 2 && x >= MIN_DRIFT_SPAN_S && denom > 0.0) {
+        double slope = (n * sum_xy - sum_x * sum_y) / denom;
+        stats.drift_ppm = slope * 1e6;
+        stats.drift_valid = true;
+    }
+}
+
+double FrameSequenceTracker::lossRate() const {
+    uint64_t expected = stats.frames + stats.lost;
+    return expected > 0 ? static_cast<double>(stats.lost) / static_cast<double>(expected) : 0.0;
+}
+
+FrameSequenceTracker::Window FrameSequenceTracker::takeWindow(Clock::time_point now) {
+    Window result = window;
+    result.seconds = std::chrono::duration<double>(now - window_start).count();
+    window = Window();
+    window_start = now;
+    return result;
+}
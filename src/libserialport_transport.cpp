@@ -0,0 +1,126 @@
+#include "libserialport_transport.h"
+#include <iostream>
+
+LibSerialPortTransport::LibSerialPortTransport(const std::string& port_name, const SerialSettings& settings)
+    : port_name(port_name), settings(settings), port(nullptr) {}
+
+LibSerialPortTransport::~LibSerialPortTransport() {
+    close();
+}
+
+bool LibSerialPortTransport::open() {
+    int result = sp_get_port_by_name(port_name.c_str(), &port);
+    if (result != SP_OK) {
+        std::cerr << "无法打开串口: " << port_name << std::endl;
+        port = nullptr;
+        return false;
+    }
+
+    result = sp_open(port, settings.read_write ? SP_MODE_READ_WRITE : SP_MODE_READ);
+    if (result != SP_OK) {
+        std::cerr << "无法打开串口进行" << (settings.read_write ? "读写" : "读取") << ": " << port_name << std::endl;
+        close();
+        return false;
+    }
+
+    // 设置完整的串口参数，与系统配置保持一致
+    result = sp_set_baudrate(port, settings.baud_rate);
+    if (result != SP_OK) {
+        std::cerr << "无法设置波特率: " << settings.baud_rate << std::endl;
+        close();
+        return false;
+    }
+
+    // 设置数据位
+    result = sp_set_bits(port, settings.data_bits);
+    if (result != SP_OK) {
+        std::cerr << "无法设置数据位" << std::endl;
+        close();
+        return false;
+    }
+
+    // 设置停止位
+    result = sp_set_stopbits(port, settings.stop_bits);
+    if (result != SP_OK) {
+        std::cerr << "无法设置停止位" << std::endl;
+        close();
+        return false;
+    }
+
+    // 设置无校验位
+    result = sp_set_parity(port, SP_PARITY_NONE);
+    if (result != SP_OK) {
+        std::cerr << "无法设置校验位" << std::endl;
+        close();
+        return false;
+    }
+
+    // 设置无流控制
+    result = sp_set_flowcontrol(port, SP_FLOWCONTROL_NONE);
+    if (result != SP_OK) {
+        std::cerr << "无法设置流控制" << std::endl;
+        close();
+        return false;
+    }
+
+    std::cout << "成功打开串口: " << port_name << " 波特率: " << settings.baud_rate
+              << " 数据位: " << settings.data_bits << " 停止位: " << settings.stop_bits
+              << " 校验位: 无 流控制: 无" << (settings.read_write ? " (读写模式)" : "") << std::endl;
+    return true;
+}
+
+void LibSerialPortTransport::close() {
+    if (port) {
+        sp_close(port);
+        sp_free_port(port);
+        port = nullptr;
+    }
+}
+
+int LibSerialPortTransport::read(uint8_t* buffer, size_t n, unsigned int timeout_ms) {
+    if (!port) {
+        return -1;
+    }
+    int result = sp_blocking_read(port, buffer, n, timeout_ms);
+    return result < 0 ? -1 : result;
+}
+
+int LibSerialPortTransport::readNonblocking(uint8_t* buffer, size_t n) {
+    if (!port) {
+        return -1;
+    }
+    int result = sp_nonblocking_read(port, buffer, n);
+    return result < 0 ? -1 : result;
+}
+
+int LibSerialPortTransport::write(const uint8_t* data, size_t length) {
+    if (!port) {
+        return -1;
+    }
+    int result = sp_nonblocking_write(port, data, length);
+    return result < 0 ? -1 : result;
+}
+
+bool LibSerialPortTransport::drain() {
+    return port && sp_drain(port) == SP_OK;
+}
+
+bool LibSerialPortTransport::flushInput() {
+    return port && sp_flush(port, SP_BUF_INPUT) == SP_OK;
+}
+
+int LibSerialPortTransport::inputWaiting() {
+    if (!port) {
+        return -1;
+    }
+    int result = sp_input_waiting(port);
+    return result < 0 ? -1 : result;
+}
+
+int LibSerialPortTransport::getFileDescriptor() const {
+    int fd = -1;
+    if (!port || sp_get_port_handle(port, &fd) != SP_OK) {
+        return -1;
+    }
+    return fd;
+}
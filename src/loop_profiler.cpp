@@ -0,0 +1,245 @@
+#include "loop_profiler.h"
+#include <chrono>
+#include <iomanip>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define UART_HAVE_RDTSC 1
+#endif
+
+bool CycleClock::use_tsc = false;
+double CycleClock::ns_per_tick = 1.0;
+
+void CycleClock::calibrate() {
+#ifdef UART_HAVE_RDTSC
+    // CPUID 0x80000007 EDX bit 8：恒定TSC（频率不随调频变化、休眠时不停止）
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        use_tsc = false;
+        ns_per_tick = 1.0;
+        return;
+    }
+    // 忙等20ms对照 steady_clock 计算每个计数对应的纳秒数
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    std::chrono::steady_clock::time_point t1;
+    do {
+        t1 = std::chrono::steady_clock::now();
+    } while (t1 - t0 < std::chrono::milliseconds(20));
+    uint64_t c1 = __rdtsc();
+    if (c1 > c0) {
+        ns_per_tick = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(c1 - c0);
+        use_tsc = true;
+    }
+#endif
+}
+
+uint64_t CycleClock::now() {
+#ifdef UART_HAVE_RDTSC
+    if (use_tsc) {
+        return __rdtsc();
+    }
+#endif
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// ============================== LoopProfiler ==============================
+
+void LoopProfiler::Histogram::record(uint32_t us) {
+    ++count;
+    sum_us += us;
+    if (us > max_us) {
+        max_us = us;
+    }
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKET_COUNT && us >= (1u << bucket)) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+}
+
+uint32_t LoopProfiler::Histogram::percentileUs(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            uint32_t upper = i + 1 < BUCKET_COUNT ? (1u << i) : max_us;
+            return upper < max_us ? upper : max_us;
+        }
+    }
+    return max_us;
+}
+
+LoopProfiler::LoopProfiler(double budget_ms, size_t trace_length)
+    : budget_us(static_cast<uint32_t>(budget_ms * 1000.0)), origin(CycleClock::now()), iteration_start(origin),
+      task_start(origin), current_task(-1), ring(trace_length > 0 ? trace_length : 1), ring_next(0), iterations(0),
+      stall_trace(ring.size()), stall_trace_length(0), stalls(0), dump_requested(false) {}
+
+uint32_t LoopProfiler::toUs(uint64_t ticks) {
+    double us = CycleClock::toNs(ticks) / 1000.0;
+    return us >= 4294967295.0 ? 0xFFFFFFFFu : static_cast<uint32_t>(us);
+}
+
+void LoopProfiler::beginIteration() {
+    iteration_start = CycleClock::now();
+    task_start = iteration_start;
+    current_task = -1;
+    current = Iteration();
+    current.index = iterations;
+    current.start_ms = CycleClock::toNs(iteration_start - origin) / 1e6;
+}
+
+void LoopProfiler::endTask(uint64_t now) {
+    if (current_task >= 0) {
+        uint32_t us = toUs(now - task_start);
+        current.task_us[current_task] += us;
+        task_hist[current_task].record(us);
+    }
+}
+
+void LoopProfiler::beginTask(Task task) {
+    uint64_t now = CycleClock::now();
+    endTask(now);
+    current_task = task;
+    task_start = now;
+}
+
+void LoopProfiler::addSpan(Span span, uint64_t ticks) {
+    current.span_us[span] += toUs(ticks);
+}
+
+void LoopProfiler::endIteration() {
+    uint64_t now = CycleClock::now();
+    endTask(now);
+    current_task = -1;
+    current.total_us = toUs(now - iteration_start);
+
+    total_hist.record(current.total_us);
+    for (size_t i = 0; i < SPAN_COUNT; ++i) {
+        if (current.span_us[i] > 0) {
+            span_hist[i].record(current.span_us[i]);
+        }
+    }
+
+    ring[ring_next] = current;
+    ring_next = (ring_next + 1) % ring.size();
+    ++iterations;
+
+    if (current.total_us > worst.total_us) {
+        worst = current;
+    }
+    if (budget_us > 0 && current.total_us > budget_us) {
+        // 超过预算：按时间顺序复制最近 N 次迭代（含本次）
+        ++stalls;
+        stall_trace_length = iterations < ring.size() ? static_cast<size_t>(iterations) : ring.size();
+        size_t first = (ring_next + ring.size() - stall_trace_length) % ring.size();
+        for (size_t i = 0; i < stall_trace_length; ++i) {
+            stall_trace[i] = ring[(first + i) % ring.size()];
+        }
+    }
+}
+
+const char* LoopProfiler::taskName(Task task) {
+    switch (task) {
+        case TASK_MAINTAIN: return "重连维护";
+        case TASK_POWER_READ: return "电流功率读取";
+        case TASK_SCREEN_POLL: return "串口屏接收";
+        case TASK_PERIODIC_SEND: return "定期发送";
+        case TASK_TELEMETRY: return "遥测推送";
+        case TASK_SLEEP: return "休眠";
+        default: return "未知";
+    }
+}
+
+const char* LoopProfiler::spanName(Span span) {
+    switch (span) {
+        case SPAN_READ: return "串口读取";
+        case SPAN_WRITE: return "串口写入";
+        case SPAN_DRAIN: return "等待发送完成(drain)";
+        case SPAN_LOG: return "控制台输出";
+        default: return "未知";
+    }
+}
+
+void LoopProfiler::printHistogram(std::ostream& out, const char* name, const Histogram& hist) {
+    out << "  " << std::left << std::setw(24) << name << std::right;
+    if (hist.count == 0) {
+        out << " 无数据" << std::endl;
+        return;
+    }
+    out << " 次数 " << std::setw(8) << hist.count << " 平均 " << std::setw(7)
+        << static_cast<double>(hist.sum_us) / static_cast<double>(hist.count) << " us  p50 <" << std::setw(7)
+        << hist.percentileUs(0.50) << " us  p99 <" << std::setw(7) << hist.percentileUs(0.99) << " us  最大 "
+        << hist.max_us << " us" << std::endl;
+}
+
+void LoopProfiler::dump(std::ostream& out) const {
+    out << "\n=== 主循环卡顿分析 ===" << std::endl;
+    out << std::fixed << std::setprecision(1);
+    out << "时钟: " << (CycleClock::usesTsc() ? "rdtsc" : "clock_gettime") << "  迭代 " << iterations
+        << " 次  预算 " << budget_us / 1000.0 << " ms  超预算 " << stalls << " 次" << std::endl;
+    out << "各任务耗时:" << std::endl;
+    printHistogram(out, "整次迭代", total_hist);
+    for (size_t i = 0; i < TASK_COUNT; ++i) {
+        printHistogram(out, taskName(static_cast<Task>(i)), task_hist[i]);
+    }
+    out << "任务内部细分（每次迭代累计）:" << std::endl;
+    for (size_t i = 0; i < SPAN_COUNT; ++i) {
+        printHistogram(out, spanName(static_cast<Span>(i)), span_hist[i]);
+    }
+
+    auto printIteration = [&out](const Iteration& it) {
+        out << "  #" << it.index << " @" << it.start_ms << "ms 总计 " << it.total_us << "us |";
+        for (size_t t = 0; t < TASK_COUNT; ++t) {
+            out << " " << taskName(static_cast<Task>(t)) << "=" << it.task_us[t];
+        }
+        out << " |";
+        for (size_t s = 0; s < SPAN_COUNT; ++s) {
+            out << " " << spanName(static_cast<Span>(s)) << "=" << it.span_us[s];
+        }
+        out << std::endl;
+    };
+
+    if (worst.total_us > 0) {
+        out << "最慢迭代 (us):" << std::endl;
+        printIteration(worst);
+    }
+    if (stall_trace_length > 0) {
+        out << "最近一次超预算为止的 " << stall_trace_length << " 次迭代 (us):" << std::endl;
+        for (size_t i = 0; i < stall_trace_length; ++i) {
+            printIteration(stall_trace[i]);
+        }
+    }
+    out << "======================\n" << std::endl;
+}
+
+// ============================== TimedStreambuf ==============================
+
+TimedStreambuf::int_type TimedStreambuf::overflow(int_type ch) {
+    uint64_t start = CycleClock::now();
+    int_type result = traits_type::eq_int_type(ch, traits_type::eof()) ? traits_type::not_eof(ch)
+                                                                       : target->sputc(traits_type::to_char_type(ch));
+    profiler.addSpan(LoopProfiler::SPAN_LOG, CycleClock::now() - start);
+    return result;
+}
+
+std::streamsize TimedStreambuf::xsputn(const char* s, std::streamsize n) {
+    uint64_t start = CycleClock::now();
+    std::streamsize result = target->sputn(s, n);
+    profiler.addSpan(LoopProfiler::SPAN_LOG, CycleClock::now() - start);
+    return result;
+}
+
+int TimedStreambuf::sync() {
+    uint64_t start = CycleClock::now();
+    int result = target->pubsync();
+    profiler.addSpan(LoopProfiler::SPAN_LOG, CycleClock::now() - start);
+    return result;
+}
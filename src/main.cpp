@@ -1,9 +1,28 @@
 #include "uart_reader.h"
 #include "current_power_protocol.h"
 #include "serial_screen_protocol.h"
+#include "telemetry_server.h"
+#include "sample_pipeline.h"
+#include "coro_scheduler.h"
+#include "coro_readers.h"
+#include "realtime.h"
+#include "alloc_guard.h"
+#include "uring_loop.h"
+#include "uring_transport.h"
+#include "screen_fanout_transport.h"
+#include "loop_profiler.h"
+#include "profiled_transport.h"
+#include "shared_port_transport.h"
+#include <libserialport.h>
 #include <iostream>
 #include <chrono>
 #include <atomic>
+#include <cstdlib>
+#include <cerrno>
+#include <sstream>
+#include <csignal>
+#include <unistd.h>
+#include <sched.h>
 
 void listAvailablePorts() {
     struct sp_port **ports;
@@ -20,49 +39,379 @@ void listAvailablePorts() {
     sp_free_port_list(ports);
 }
 
+// 读取环境变量，未设置时返回默认值
+std::string getEnvOr(const char* name, const std::string& default_value) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::string(value) : default_value;
+}
+
+// 读取整数环境变量：未设置时返回默认值，不是整数或超出 [min_value, max_value] 时报错并返回默认值
+long getEnvLongInRange(const char* name, long default_value, long min_value, long max_value) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return default_value;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || parsed < min_value || parsed > max_value) {
+        std::cerr << "环境变量 " << name << " 无效: " << value << "（应为 " << min_value << "~" << max_value
+                  << " 的整数），使用默认值 " << default_value << std::endl;
+        return default_value;
+    }
+    return parsed;
+}
+
+// 读取浮点环境变量：未设置时返回默认值，不是数字或超出 [min_value, max_value] 时报错并返回默认值
+double getEnvDoubleInRange(const char* name, double default_value, double min_value, double max_value) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return default_value;
+    }
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(value, &end);
+    if (errno != 0 || end == value || *end != '\0' || !(parsed >= min_value && parsed <= max_value)) {
+        std::cerr << "环境变量 " << name << " 无效: " << value << "（应为 " << min_value << "~" << max_value
+                  << " 的数），使用默认值 " << default_value << std::endl;
+        return default_value;
+    }
+    return parsed;
+}
+
+// 卡顿分析器（UART_PROFILE=1 时创建），SIGUSR1 只设置打印标志，由主循环打印
+static LoopProfiler* activeProfiler = nullptr;
+
+static void onProfileDumpSignal(int) {
+    if (activeProfiler) {
+        activeProfiler->requestDump();
+    }
+}
+
 // 单线程主循环函数
-void mainLoop(UartReader& currentPowerReader, std::shared_ptr<SerialScreenProtocol> screenProtocol) {
+void mainLoop(UartReader& currentPowerReader, std::shared_ptr<SerialScreenProtocol> screenProtocol,
+              std::shared_ptr<TelemetryServer> telemetry, std::shared_ptr<SamplePipeline> pipeline,
+              bool realtime, LoopProfiler* profiler) {
     std::cout << "单线程主循环已启动" << std::endl;
     
     auto lastSendTime = std::chrono::steady_clock::now();
     const auto sendInterval = std::chrono::milliseconds(50); // 50ms发送间隔
     
+    // 实时模式：统计休眠唤醒抖动，并在分配钩子可用时检查稳态迭代不分配内存
+    LoopJitterStats jitter;
+    auto lastJitterReport = lastSendTime;
+    const auto jitterReportInterval = std::chrono::seconds(10);
+    const uint64_t warmupIterations = 1000; // 预热期间允许首次分配（如输出流缓冲区）
+    uint64_t iteration = 0;
+    const bool checkAllocations = realtime && alloc_guard::available();
+    
     while (true) {
+        if (profiler) {
+            profiler->beginIteration();
+        }
         auto currentTime = std::chrono::steady_clock::now();
+        ++iteration;
+        
+        // 只有两个串口都在线时才算稳态（重连过程需要分配端口对象）
+        bool steadyState = checkAllocations && iteration > warmupIterations &&
+                           currentPowerReader.isConnected() && screenProtocol->isConnected();
+        if (steadyState) {
+            alloc_guard::arm();
+        }
+        
+        // 断线的串口按退避时间在后台重连，互不阻塞
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_MAINTAIN);
+        }
+        currentPowerReader.maintainConnection();
+        screenProtocol->maintainConnection();
         
         // 任务1: 接收电流功率数据
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_POWER_READ);
+        }
         if (currentPowerReader.readAndParseFrame()) {
             // 数据接收成功，继续处理
         }
         
         // 任务2: 接收串口屏按键事件（非阻塞）
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_SCREEN_POLL);
+        }
         screenProtocol->checkForSerialScreenData();
         
         // 任务3: 定期发送数据到串口屏
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_PERIODIC_SEND);
+        }
         if (currentTime - lastSendTime >= sendInterval) {
+            // 按显示速率抽取一次滤波结果
+            pipeline->flush();
             screenProtocol->sendPeriodicData();
             lastSendTime = currentTime;
         }
         
+        // 任务4: 向遥测订阅者批量推送数据（非阻塞）
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_TELEMETRY);
+        }
+        if (telemetry) {
+            telemetry->poll();
+        }
+        
+        if (steadyState) {
+            alloc_guard::disarm();
+            if (alloc_guard::allocations() > 0) {
+                alloc_guard::reportViolation(alloc_guard::allocations(), iteration);
+            }
+        }
+        
         // 短暂休息，避免CPU占用过高
+        if (profiler) {
+            profiler->beginTask(LoopProfiler::TASK_SLEEP);
+        }
+        auto sleepStart = std::chrono::steady_clock::now();
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        
+        if (realtime) {
+            auto sleepEnd = std::chrono::steady_clock::now();
+            jitter.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                sleepEnd - sleepStart - std::chrono::milliseconds(1)).count());
+            if (sleepEnd - lastJitterReport >= jitterReportInterval) {
+                jitter.print();
+                jitter.reset();
+                lastJitterReport = sleepEnd;
+            }
+        }
+        
+        if (profiler) {
+            profiler->endIteration();
+            if (profiler->takeDumpRequest()) {
+                profiler->dump(std::cerr);
+            }
+        }
+    }
+}
+
+// 协程模式下的定期任务：按显示速率刷新串口屏并推送遥测
+Task<void> runPeriodicTasks(Scheduler& scheduler, std::shared_ptr<SerialScreenProtocol> screenProtocol,
+                            std::shared_ptr<TelemetryServer> telemetry, std::shared_ptr<SamplePipeline> pipeline) {
+    const int sendIntervalMs = 50;  // 50ms发送间隔
+    const int pollIntervalMs = 5;   // 遥测推送间隔
+    int elapsedMs = 0;
+
+    while (scheduler.isRunning()) {
+        co_await scheduler.sleep(pollIntervalMs);
+        elapsedMs += pollIntervalMs;
+
+        if (elapsedMs >= sendIntervalMs) {
+            pipeline->flush();
+            screenProtocol->sendPeriodicData();
+            elapsedMs = 0;
+        }
+        if (telemetry) {
+            telemetry->poll();
+        }
+    }
+}
+
+// 协程主循环：两个串口的读取和定期任务都是同一线程上的协程，没有阻塞读
+void coroutineMainLoop(UartReader& currentPowerReader, std::shared_ptr<SerialScreenProtocol> screenProtocol,
+                       std::shared_ptr<TelemetryServer> telemetry, std::shared_ptr<SamplePipeline> pipeline) {
+    Scheduler scheduler;
+    if (!scheduler.isValid()) {
+        std::cerr << "协程调度器初始化失败，改用单线程轮询主循环" << std::endl;
+        mainLoop(currentPowerReader, screenProtocol, telemetry, pipeline, false, nullptr);
+        return;
     }
+
+    std::cout << "协程主循环已启动" << std::endl;
+    // 串口屏命令由读协程为每次连接启动的写协程经 AsyncPort 写出
+    screenProtocol->setExternalTransmit(true);
+    scheduler.spawn(runCurrentPowerReader(scheduler, currentPowerReader));
+    scheduler.spawn(runSerialScreenReader(scheduler, *screenProtocol));
+    scheduler.spawn(runPeriodicTasks(scheduler, screenProtocol, telemetry, pipeline));
+    scheduler.run();
+}
+
+// io_uring 主循环：所有端口的读请求常驻内核，一次 io_uring_enter 完成写入提交和等待
+void uringMainLoop(UringLoop& ring, UartReader& currentPowerReader, std::shared_ptr<SerialScreenProtocol> screenProtocol,
+                   std::shared_ptr<TelemetryServer> telemetry, std::shared_ptr<SamplePipeline> pipeline) {
+    std::cout << "io_uring 主循环已启动" << std::endl;
+
+    auto lastSendTime = std::chrono::steady_clock::now();
+    const auto sendInterval = std::chrono::milliseconds(50); // 50ms发送间隔
+    const int pollIntervalMs = 5;                            // 遥测推送间隔
+
+    while (true) {
+        currentPowerReader.maintainConnection();
+        screenProtocol->maintainConnection();
+
+        // 任务1/2: 提交批量写入并等待完成事件，收到的数据在完成事件中直接送入协议解码器
+        ring.runOnce(pollIntervalMs);
+
+        // 定期确认设备节点仍然存在（USB拔出后读请求可能一直挂起）
+        if (currentPowerReader.isConnected()) {
+            currentPowerReader.checkDevicePresent();
+        }
+        if (screenProtocol->isConnected()) {
+            screenProtocol->checkDevicePresent();
+        }
+
+        // 任务3: 定期发送数据到串口屏（放入发送缓冲区，下一次 runOnce 提交）
+        auto currentTime = std::chrono::steady_clock::now();
+        if (currentTime - lastSendTime >= sendInterval) {
+            pipeline->flush();
+            screenProtocol->sendPeriodicData();
+            lastSendTime = currentTime;
+        }
+
+        // 任务4: 向遥测订阅者批量推送数据（非阻塞）
+        if (telemetry) {
+            telemetry->poll();
+        }
+    }
+}
+
+// 创建串口传输层；io_uring 模式下由 UringTransport 包装，读写改走 io_uring；
+// 启用卡顿分析时由 ProfiledTransport 包装，统计读写和 drain 耗时
+std::unique_ptr<Transport> makeTransport(TransportType type, const std::string& port_name,
+                                         const SerialSettings& settings, UringLoop* ring) {
+    std::unique_ptr<Transport> transport = createTransport(type, port_name, settings);
+    if (ring) {
+        return std::make_unique<UringTransport>(*ring, std::move(transport));
+    }
+    if (activeProfiler) {
+        return std::make_unique<ProfiledTransport>(std::move(transport), *activeProfiler);
+    }
+    return transport;
 }
 
 int main() {
     std::cout << "=== 串口通讯程序（单线程事件驱动）===" << std::endl;
     listAvailablePorts();
 
-    std::string current_power_port = "/dev/ttyUSB0";  // 电流功率数据串口
-    std::string serial_screen_port = "/dev/ttyUSB1";  // 串口屏串口
+    // 串口可通过环境变量覆盖（例如指向串口屏模拟器的伪终端）
+    std::string current_power_port = getEnvOr("UART_POWER_PORT", "/dev/ttyUSB0");   // 电流功率数据串口
+    std::string serial_screen_port = getEnvOr("UART_SCREEN_PORT", "/dev/ttyUSB1");  // 串口屏串口，逗号分隔可接多块屏
     int baud_rate = 9600;
 
-    std::cout << "串口配置:" << std::endl;
+    std::vector<std::string> screenPorts;
+    std::stringstream screenPortList(serial_screen_port);
+    for (std::string name; std::getline(screenPortList, name, ',');) {
+        if (!name.empty()) {
+            screenPorts.push_back(name);
+        }
+    }
+    if (screenPorts.empty()) {
+        screenPorts.push_back("/dev/ttyUSB1");
+    }
+
+    // 传输层: libserialport（默认）或 termios（直接文件描述符，readv/writev、VMIN/VTIME、低延迟标志）
+    TransportType transportType = TransportType::LIBSERIALPORT;
+    std::string transportName = getEnvOr("UART_TRANSPORT", "libserialport");
+    if (!parseTransportType(transportName, transportType)) {
+        std::cerr << "未知的传输层: " << transportName << "，使用 libserialport" << std::endl;
+        transportType = TransportType::LIBSERIALPORT;
+        transportName = "libserialport";
+    }
+
+    // I/O模式: blocking（默认，轮询+阻塞读）、coro（协程+epoll）或 uring（io_uring，不可用时回退到 coro）
+    std::string ioMode = getEnvOr("UART_IO", "blocking");
+    if (screenPorts.size() > 1 && ioMode != "blocking") {
+        // 多屏广播由传输层自己轮询各串口，只在单线程轮询主循环中使用
+        std::cerr << "多串口屏广播仅支持 blocking 主循环，忽略 UART_IO=" << ioMode << std::endl;
+        ioMode = "blocking";
+    }
+    // 传感器和串口屏接在同一个串口（同一条RS-485总线）上：串口屏协议持有串口，电流功率读取器借用同一个
+    // 传输层读取全部字节，由分流器把两种协议的帧分别交给各自的解码器
+    bool sharedPort = screenPorts.size() == 1 && screenPorts.front() == current_power_port;
+    if (sharedPort && ioMode != "blocking") {
+        std::cerr << "传感器与串口屏共用串口仅支持 blocking 主循环，忽略 UART_IO=" << ioMode << std::endl;
+        ioMode = "blocking";
+    }
+
+    // 可选的主循环卡顿分析（仅单线程轮询主循环）
+    std::unique_ptr<LoopProfiler> profiler;
+    std::unique_ptr<TimedStreambuf> timedCout;
+    std::streambuf* originalCoutBuffer = nullptr;
+    if (getEnvOr("UART_PROFILE", "0") == "1") {
+        if (ioMode != "blocking") {
+            std::cerr << "卡顿分析仅支持 blocking 主循环，忽略 UART_PROFILE" << std::endl;
+        } else {
+            CycleClock::calibrate();
+            double budgetMs = getEnvDoubleInRange("UART_PROFILE_BUDGET_MS", 20.0, 0.0, 60000.0);
+            size_t traceLength = static_cast<size_t>(getEnvLongInRange("UART_PROFILE_TRACE", 64, 1, 65536));
+            profiler = std::make_unique<LoopProfiler>(budgetMs, traceLength);
+            activeProfiler = profiler.get();
+            // 控制台输出的耗时计入分析结果
+            timedCout = std::make_unique<TimedStreambuf>(std::cout.rdbuf(), *profiler);
+            originalCoutBuffer = std::cout.rdbuf(timedCout.get());
+            struct sigaction action = {};
+            action.sa_handler = onProfileDumpSignal;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESTART;
+            sigaction(SIGUSR1, &action, nullptr);
+            std::cout << "卡顿分析已启用: 时钟=" << (CycleClock::usesTsc() ? "rdtsc" : "clock_gettime")
+                      << " 预算=" << budgetMs << " ms 记录最近 " << traceLength << " 次迭代，kill -USR1 "
+                      << getpid() << " 打印结果" << std::endl;
+        }
+    }
+
+    std::unique_ptr<UringLoop> ring;
+    if (ioMode == "uring") {
+        ring = std::make_unique<UringLoop>();
+        if (!ring->isValid()) {
+            std::cerr << "io_uring 不可用，回退到 epoll 协程主循环" << std::endl;
+            ring.reset();
+            ioMode = "coro";
+        }
+    }
+
+    std::cout << "串口配置 (传输层: " << transportName << (ring ? " + io_uring" : "") << "):" << std::endl;
     std::cout << "  - 电流功率串口: " << current_power_port << " (波特率: " << baud_rate << ")" << std::endl;
     std::cout << "  - 串口屏串口: " << serial_screen_port << " (波特率: " << baud_rate << ")" << std::endl;
 
+    // 可选的本地遥测流服务（通过环境变量启用）
+    std::shared_ptr<TelemetryServer> telemetry;
+    TelemetryServerConfig telemetryConfig;
+    telemetryConfig.unix_path = getEnvOr("UART_TELEMETRY_UNIX", "");
+    telemetryConfig.tcp_port = static_cast<int>(getEnvLongInRange("UART_TELEMETRY_TCP", 0, 0, 65535));
+    if (!telemetryConfig.unix_path.empty() || telemetryConfig.tcp_port > 0) {
+        telemetry = std::make_shared<TelemetryServer>(telemetryConfig);
+        if (!telemetry->start()) {
+            std::cerr << "遥测服务启动失败，继续运行但不推送遥测数据" << std::endl;
+            telemetry.reset();
+        }
+    }
+
     // 创建串口屏协议（支持读写）
-    auto screenProtocol = std::make_shared<SerialScreenProtocol>(serial_screen_port, baud_rate);
+    SerialSettings screenSettings;
+    screenSettings.baud_rate = baud_rate;
+    std::shared_ptr<SerialScreenProtocol> screenProtocol;
+    if (screenPorts.size() > 1) {
+        // 多块串口屏：命令只格式化一次，由广播传输层写给所有屏幕
+        std::vector<std::unique_ptr<Transport>> screenTransports;
+        for (const auto& name : screenPorts) {
+            screenTransports.push_back(createTransport(transportType, name, screenSettings));
+        }
+        auto fanout = std::make_unique<ScreenFanoutTransport>(std::move(screenTransports));
+        ScreenFanoutTransport* fanoutPtr = fanout.get();
+        std::unique_ptr<Transport> screenTransport = std::move(fanout);
+        if (activeProfiler) {
+            screenTransport = std::make_unique<ProfiledTransport>(std::move(screenTransport), *activeProfiler);
+        }
+        screenProtocol = std::make_shared<SerialScreenProtocol>(std::move(screenTransport), baud_rate);
+        SerialScreenProtocol* screen = screenProtocol.get();
+        fanoutPtr->setRefreshCallback([screen]() { screen->requestFullRefresh(); });
+    } else {
+        screenProtocol = std::make_shared<SerialScreenProtocol>(
+            makeTransport(transportType, screenPorts.front(), screenSettings, ring.get()));
+    }
+    
+    // 串口屏发送预算：8N1 下每字节10位，默认使用整条链路带宽
+    double screenTxBudget = getEnvDoubleInRange("UART_SCREEN_TX_BUDGET", baud_rate / 10.0, 1.0, 1e9);
+    screenProtocol->setLinkBudget(screenTxBudget);
     
     // 注册串口屏事件回调函数
     screenProtocol->registerEventCallback(SerialScreenEvent::START_BUTTON, []() {
@@ -105,38 +454,190 @@ int main() {
         // 这里可以添加相机阈值-1的具体处理逻辑
     });
     
+    // 将所有串口屏事件转发到遥测服务
+    if (telemetry) {
+        screenProtocol->setEventObserver(
+            [telemetry](uint8_t page, uint8_t control, uint8_t event, SerialScreenEvent screenEvent) {
+                telemetry->publishScreenEvent(page, control, event, static_cast<int>(screenEvent));
+            }
+        );
+    }
+    
+    // 样本处理管线：标定、滤波并按显示速率输出到串口屏
+    SamplePipelineConfig pipelineConfig;
+    std::string filterName = getEnvOr("UART_FILTER", "ma");
+    if (!SamplePipeline::parseFilterType(filterName, pipelineConfig.filter)) {
+        std::cerr << "未知滤波器类型: " << filterName << "，使用滑动平均" << std::endl;
+    }
+    pipelineConfig.window = static_cast<size_t>(getEnvLongInRange("UART_FILTER_WINDOW", 8, 1,
+        static_cast<long>(SamplePipelineConfig::MAX_WINDOW)));
+    pipelineConfig.ema_alpha = static_cast<float>(getEnvDoubleInRange("UART_FILTER_ALPHA", 0.2, 0.0001, 1.0));
+    std::string currentCal = getEnvOr("UART_CAL_CURRENT", "");
+    if (!currentCal.empty() && !SamplePipeline::parseCalibration(currentCal, pipelineConfig.current_cal)) {
+        std::cerr << "电流标定参数格式错误（应为 gain,offset）: " << currentCal << std::endl;
+    }
+    std::string powerCal = getEnvOr("UART_CAL_POWER", "");
+    if (!powerCal.empty() && !SamplePipeline::parseCalibration(powerCal, pipelineConfig.power_cal)) {
+        std::cerr << "功率标定参数格式错误（应为 gain,offset）: " << powerCal << std::endl;
+    }
+
+    auto pipeline = std::make_shared<SamplePipeline>(pipelineConfig);
+    pipeline->setOutputCallback([screenProtocol](float current, float power) {
+        screenProtocol->updateDisplayedCurrentPower(current, power);
+    });
+    pipeline->setPeakCallback([screenProtocol](float power) {
+        screenProtocol->updatePeakPower(power);
+    });
+
+    // 功率波形（可选）：标定后的原始功率样本抽取后批量发送到屏幕曲线控件
+    if (getEnvOr("UART_WAVE", "0") == "1") {
+        if (screenPorts.size() > 1) {
+            // 透传握手需要逐个屏幕应答，多屏广播时无法保证所有屏幕同步进入透传状态
+            std::cerr << "多串口屏广播模式不支持波形显示，忽略 UART_WAVE" << std::endl;
+        } else {
+            WaveformConfig waveConfig;
+            waveConfig.component_id = static_cast<int>(getEnvLongInRange("UART_WAVE_ID", 1, 0, 255));
+            waveConfig.channel = static_cast<int>(getEnvLongInRange("UART_WAVE_CH", 0, 0, 3));
+            waveConfig.full_scale = static_cast<float>(getEnvDoubleInRange("UART_WAVE_MAX", 100.0, 0.001, 1e9));
+            waveConfig.height = static_cast<int>(getEnvLongInRange("UART_WAVE_HEIGHT", 255, 1, 255));
+            waveConfig.batch_points = static_cast<size_t>(getEnvLongInRange("UART_WAVE_BATCH", 10, 1, 256));
+            waveConfig.decimation = static_cast<size_t>(getEnvLongInRange("UART_WAVE_DECIMATE", 1, 1, 100000));
+            // 默认占用链路带宽的20%（波特率/10 字节每秒）
+            waveConfig.budget_bytes_per_s = getEnvDoubleInRange("UART_WAVE_BUDGET", baud_rate / 10 / 5, 1.0, 1e9);
+            screenProtocol->enableWaveform(waveConfig);
+            pipeline->setBatchCallback([screenProtocol](const float* power, size_t count) {
+                screenProtocol->pushWaveformSamples(power, count);
+            });
+            std::cout << "功率波形: 控件=" << waveConfig.component_id << " 通道=" << waveConfig.channel
+                      << " 满量程=" << waveConfig.full_scale << " W 每批=" << waveConfig.batch_points
+                      << " 点 抽取=" << waveConfig.decimation << " 预算=" << waveConfig.budget_bytes_per_s
+                      << " B/s" << std::endl;
+        }
+    }
+    std::cout << "样本处理管线: 滤波器=" << filterName << " 窗口=" << pipeline->getConfig().window
+              << " EMA系数=" << pipeline->getConfig().ema_alpha << std::endl;
+
     // 创建电流功率协议
     auto currentPowerProtocol = std::make_unique<CurrentPowerProtocol>();
 
-    // 设置电流功率回调，将数据转发到串口屏
+    // 保留字节解码：legacy（默认，校验全0）、extended（帧序号+设备时刻）或 auto（自动识别）
+    std::string sequenceName = getEnvOr("UART_SEQ", "legacy");
+    SequenceMode sequenceMode = SequenceMode::LEGACY;
+    if (!CurrentPowerProtocol::parseSequenceMode(sequenceName, sequenceMode)) {
+        std::cerr << "未知的帧序号模式: " << sequenceName << "，使用 legacy" << std::endl;
+    } else if (sequenceMode != SequenceMode::LEGACY) {
+        double tickHz = getEnvDoubleInRange("UART_SEQ_TICK_HZ", 1000.0, 0.001, 1e9);
+        currentPowerProtocol->setSequenceMode(sequenceMode, tickHz);
+        std::cout << "帧序号统计: 模式=" << sequenceName << " 设备时刻频率=" << tickHz << " Hz" << std::endl;
+    }
+
+    // 设置电流功率回调，将数据送入处理管线（再由管线转发到串口屏）
     currentPowerProtocol->setCurrentPowerCallback(
-        [screenProtocol](float current, float power) {
-            screenProtocol->updateCurrentPower(current, power);
+        [pipeline, telemetry](float current, float power) {
+            pipeline->push(current, power);
+            if (telemetry) {
+                telemetry->publishSample(current, power);
+            }
         }
     );
 
     // 创建电流功率串口读取器
-    UartReader currentPowerReader(current_power_port, baud_rate);
+    SerialSettings powerSettings;
+    powerSettings.baud_rate = baud_rate;
+    powerSettings.read_write = false;
+    // termios 传输层的 VMIN/VTIME：例如 UART_VMIN=20 让内核攒满一帧再唤醒读取
+    powerSettings.vmin = static_cast<int>(getEnvLongInRange("UART_VMIN", 0, 0, 255));
+    powerSettings.vtime = static_cast<int>(getEnvLongInRange("UART_VTIME", 0, 0, 255));
+    if ((powerSettings.vmin > 0 || powerSettings.vtime > 0) && transportType != TransportType::TERMIOS) {
+        std::cerr << "UART_VMIN/UART_VTIME 只对 termios 传输层生效" << std::endl;
+    }
+    std::unique_ptr<Transport> powerTransport;
+    if (sharedPort) {
+        powerTransport = std::make_unique<SharedPortTransport>(screenProtocol->getTransport());
+    } else {
+        powerTransport = makeTransport(transportType, current_power_port, powerSettings, ring.get());
+    }
+    UartReader currentPowerReader(std::move(powerTransport));
     currentPowerReader.addProtocol(std::move(currentPowerProtocol));
+    if (sharedPort) {
+        currentPowerReader.attachProtocol(*screenProtocol);
+        screenProtocol->setExternalReceive(true);
+        // 串口由串口屏协议持有：读取端发现断线时由它关闭串口，重连后重新发送全部数据
+        SerialScreenProtocol* screen = screenProtocol.get();
+        currentPowerReader.setDisconnectCallback([screen](const char* reason) {
+            if (screen->isConnected()) {
+                screen->handleDisconnect(reason);
+            }
+        });
+        std::cout << "传感器与串口屏共用串口: " << current_power_port << "，按帧格式分流" << std::endl;
+    }
+    long backlogAlarm = getEnvLongInRange("UART_BACKLOG_ALARM", 0, 0, 1L << 20);
+    if (backlogAlarm > 0) {
+        currentPowerReader.setBacklogAlarm(static_cast<size_t>(backlogAlarm));
+    }
 
-    // 打开电流功率串口
-    if (!currentPowerReader.open()) {
-        std::cerr << "无法打开电流功率串口，程序退出" << std::endl;
-        return -1;
+    // io_uring 模式：完成事件直接把数据送入解码器，读写错误按断线处理
+    if (auto uring = dynamic_cast<UringTransport*>(&currentPowerReader.getTransport())) {
+        uring->setReceiver([&currentPowerReader](const uint8_t* data, size_t length) {
+            currentPowerReader.feed(data, length);
+        });
+        uring->setErrorHandler([&currentPowerReader]() {
+            currentPowerReader.handleDisconnect("读取错误");
+        });
     }
-    
-    // 打开串口屏串口（读写模式）
+    if (auto uring = dynamic_cast<UringTransport*>(&screenProtocol->getTransport())) {
+        SerialScreenProtocol* screen = screenProtocol.get();
+        uring->setReceiver([screen](const uint8_t* data, size_t length) {
+            screen->feed(data, length);
+        });
+        uring->setErrorHandler([screen]() {
+            screen->handleDisconnect("读写错误");
+        });
+    }
+
+    // 打开串口屏串口（读写模式）；共用串口时先由串口屏协议打开，读取器直接复用
     if (!screenProtocol->open()) {
-        std::cerr << "无法打开串口屏串口，程序退出" << std::endl;
-        return -1;
+        std::cerr << "无法打开串口屏串口，将在后台重连" << std::endl;
     } else {
         std::cout << "串口屏串口已打开（读写模式）" << std::endl;
     }
 
+    // 打开电流功率串口（失败时不退出，主循环中后台重连）
+    if (!currentPowerReader.open()) {
+        std::cerr << "无法打开电流功率串口，将在后台重连" << std::endl;
+    }
+
+    // 可选的实时模式：所有对象和缓冲区已在上面创建完毕，此时绑定CPU、切换SCHED_FIFO并锁定内存
+    bool realtime = getEnvOr("UART_RT", "0") == "1";
+    if (realtime) {
+        RealtimeConfig rtConfig;
+        rtConfig.cpu = static_cast<int>(getEnvLongInRange("UART_RT_CPU", -1, -1, CPU_SETSIZE - 1));
+        rtConfig.priority = static_cast<int>(getEnvLongInRange("UART_RT_PRIORITY", 50, 0, 99));
+        RealtimeStatus rtStatus = applyRealtimeMode(rtConfig);
+        std::cout << "实时模式: CPU绑定=" << (rtStatus.pinned ? "是" : "否")
+                  << " SCHED_FIFO=" << (rtStatus.fifo ? "是" : "否")
+                  << " 内存锁定=" << (rtStatus.memory_locked ? "是" : "否")
+                  << " 分配检查=" << (alloc_guard::available() ? "开启" : "未编译") << std::endl;
+    }
+
+    if (ring) {
+        std::cout << "启动io_uring主循环..." << std::endl;
+        uringMainLoop(*ring, currentPowerReader, screenProtocol, telemetry, pipeline);
+        return 0;
+    }
+    if (ioMode == "coro") {
+        std::cout << "启动协程主循环..." << std::endl;
+        coroutineMainLoop(currentPowerReader, screenProtocol, telemetry, pipeline);
+        return 0;
+    }
+
     std::cout << "启动单线程主循环..." << std::endl;
     
     // 启动单线程主循环
-    mainLoop(currentPowerReader, screenProtocol);
+    mainLoop(currentPowerReader, screenProtocol, telemetry, pipeline, realtime, profiler.get());
 
+    if (originalCoutBuffer) {
+        std::cout.rdbuf(originalCoutBuffer);
+    }
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "memory_transport.h"
+#include <cstdint>
+#include <cstring>
+
+MemoryTransport::MemoryTransport(const std::string& name)
+    : name(name), opened(false), rx_offset(0), tx_capacity(SIZE_MAX) {}
+
+bool MemoryTransport::open() {
+    opened = true;
+    return true;
+}
+
+void MemoryTransport::close() {
+    opened = false;
+}
+
+int MemoryTransport::read(uint8_t* buffer, size_t n, unsigned int timeout_ms) {
+    // 内存中没有"稍后到达"的数据，超时等待没有意义
+    (void)timeout_ms;
+    return readNonblocking(buffer, n);
+}
+
+int MemoryTransport::readNonblocking(uint8_t* buffer, size_t n) {
+    if (!opened) {
+        return -1;
+    }
+    size_t available = rx.size() - rx_offset;
+    size_t count = n < available ? n : available;
+    std::memcpy(buffer, rx.data() + rx_offset, count);
+    rx_offset += count;
+    if (rx_offset == rx.size()) {
+        rx.clear();
+        rx_offset = 0;
+    }
+    return static_cast<int>(count);
+}
+
+int MemoryTransport::write(const uint8_t* data, size_t length) {
+    if (!opened) {
+        return -1;
+    }
+    // 与非阻塞写一样，发送缓冲区满时只接受放得下的部分
+    size_t space = tx.size() < tx_capacity ? tx_capacity - tx.size() : 0;
+    size_t count = length < space ? length : space;
+    tx.insert(tx.end(), data, data + count);
+    return static_cast<int>(count);
+}
+
+bool MemoryTransport::flushInput() {
+    rx.clear();
+    rx_offset = 0;
+    return opened;
+}
+
+int MemoryTransport::inputWaiting() {
+    return opened ? static_cast<int>(rx.size() - rx_offset) : -1;
+}
+
+void MemoryTransport::injectRx(const uint8_t* data, size_t length) {
+    rx.insert(rx.end(), data, data + length);
+}
+
+std::vector<uint8_t> MemoryTransport::takeTx() {
+    std::vector<uint8_t> out;
+    out.swap(tx);
+    return out;
+}
@@ -0,0 +1,40 @@
+#include "profiled_transport.h"
+
+ProfiledTransport::ProfiledTransport(std::unique_ptr<Transport> inner, LoopProfiler& profiler)
+    : inner(std::move(inner)), profiler(profiler) {}
+
+int ProfiledTransport::read(uint8_t* buffer, size_t n, unsigned int timeout_ms) {
+    uint64_t start = CycleClock::now();
+    int result = inner->read(buffer, n, timeout_ms);
+    profiler.addSpan(LoopProfiler::SPAN_READ, CycleClock::now() - start);
+    return result;
+}
+
+int ProfiledTransport::readNonblocking(uint8_t* buffer, size_t n) {
+    uint64_t start = CycleClock::now();
+    int result = inner->readNonblocking(buffer, n);
+    profiler.addSpan(LoopProfiler::SPAN_READ, CycleClock::now() - start);
+    return result;
+}
+
+int ProfiledTransport::write(const uint8_t* data, size_t length) {
+    uint64_t start = CycleClock::now();
+    int result = inner->write(data, length);
+    profiler.addSpan(LoopProfiler::SPAN_WRITE, CycleClock::now() - start);
+    return result;
+}
+
+int ProfiledTransport::writev(const struct iovec* iov, int iovcnt) {
+    // 转发给内部传输层的 writev，保留 fd 后端一次系统调用的聚集写
+    uint64_t start = CycleClock::now();
+    int result = inner->writev(iov, iovcnt);
+    profiler.addSpan(LoopProfiler::SPAN_WRITE, CycleClock::now() - start);
+    return result;
+}
+
+bool ProfiledTransport::drain() {
+    uint64_t start = CycleClock::now();
+    bool result = inner->drain();
+    profiler.addSpan(LoopProfiler::SPAN_DRAIN, CycleClock::now() - start);
+    return result;
+}
@@ -0,0 +1,142 @@
+#include "realtime.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace {
+
+// 触碰一段栈空间，让这些页面提前映射（配合 mlockall 常驻内存）
+void prefaultStack(size_t kb) {
+    const size_t size = kb * 1024;
+    volatile uint8_t* stack = static_cast<volatile uint8_t*>(alloca(size));
+    for (size_t i = 0; i < size; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+// 扩大堆并触碰全部页面；关闭收缩和mmap，使释放后的内存仍保留在进程内供后续复用
+bool prefaultHeap(size_t kb) {
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    const size_t size = kb * 1024;
+    uint8_t* heap = static_cast<uint8_t*>(std::malloc(size));
+    if (!heap) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i += 4096) {
+        heap[i] = 0;
+    }
+    std::free(heap);
+    return true;
+}
+
+} // namespace
+
+RealtimeStatus applyRealtimeMode(const RealtimeConfig& config) {
+    RealtimeStatus status;
+
+    if (config.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err == 0) {
+            status.pinned = true;
+            std::cout << "实时模式: I/O线程已绑定到CPU " << config.cpu << std::endl;
+        } else {
+            std::cerr << "实时模式: 无法绑定CPU " << config.cpu << " (" << std::strerror(err)
+                      << ")，继续使用默认调度" << std::endl;
+        }
+    }
+
+    if (config.priority > 0) {
+        struct sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = config.priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err == 0) {
+            status.fifo = true;
+            std::cout << "实时模式: 已切换到SCHED_FIFO 优先级 " << config.priority << std::endl;
+        } else {
+            std::cerr << "实时模式: 无法切换到SCHED_FIFO (" << std::strerror(err)
+                      << ")，需要root或CAP_SYS_NICE，继续使用普通调度" << std::endl;
+        }
+    }
+
+    if (config.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            status.memory_locked = true;
+            std::cout << "实时模式: 内存已锁定" << std::endl;
+        } else {
+            std::cerr << "实时模式: 无法锁定内存 (" << std::strerror(errno)
+                      << ")，可能需要提高 RLIMIT_MEMLOCK" << std::endl;
+        }
+    }
+
+    prefaultStack(config.prefault_stack_kb);
+    status.prefaulted = prefaultHeap(config.prefault_heap_kb);
+
+    return status;
+}
+
+LoopJitterStats::LoopJitterStats() {
+    reset();
+}
+
+void LoopJitterStats::reset() {
+    samples = 0;
+    min_us = 0;
+    max_us = 0;
+    sum_us = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+void LoopJitterStats::record(int64_t latency_us) {
+    if (latency_us < 0) {
+        latency_us = 0;
+    }
+    if (samples == 0 || latency_us < min_us) {
+        min_us = latency_us;
+    }
+    if (latency_us > max_us) {
+        max_us = latency_us;
+    }
+    sum_us += latency_us;
+    ++samples;
+
+    static const int64_t limits[BUCKET_COUNT - 1] = {50, 100, 250, 500, 1000, 2000, 5000};
+    size_t bucket = BUCKET_COUNT - 1;
+    for (size_t i = 0; i < BUCKET_COUNT - 1; ++i) {
+        if (latency_us < limits[i]) {
+            bucket = i;
+            break;
+        }
+    }
+    ++buckets[bucket];
+}
+
+void LoopJitterStats::print() const {
+    static const char* labels[BUCKET_COUNT] = {
+        "<50us", "<100us", "<250us", "<500us", "<1ms", "<2ms", "<5ms", ">=5ms"
+    };
+
+    std::cout << "\n=== 主循环调度抖动统计 ===" << std::endl;
+    std::cout << "样本数: " << samples;
+    if (samples > 0) {
+        std::cout << " 最小: " << min_us << "us 平均: " << sum_us / static_cast<int64_t>(samples)
+                  << "us 最大: " << max_us << "us";
+    }
+    std::cout << std::endl;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        std::cout << "  " << labels[i] << ": " << buckets[i] << std::endl;
+    }
+    std::cout << "==========================\n" << std::endl;
+}
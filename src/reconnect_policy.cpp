@@ -0,0 +1,60 @@
+#include "reconnect_policy.h"
+#include <unistd.h>
+
+ReconnectPolicy::ReconnectPolicy(int initial_delay_ms, int max_delay_ms)
+    : initial_delay_ms(initial_delay_ms), max_delay_ms(max_delay_ms),
+      current_delay_ms(initial_delay_ms), connected(false), ever_connected(false),
+      disconnected_since(Clock::now()), next_attempt(Clock::now()),
+      last_presence_check(Clock::now()) {}
+
+bool ReconnectPolicy::markConnected() {
+    bool recovered = false;
+    if (!connected && ever_connected) {
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - disconnected_since).count();
+        stats.last_recovery_ms = ms;
+        stats.total_recovery_ms += ms;
+        if (ms > stats.max_recovery_ms) {
+            stats.max_recovery_ms = ms;
+        }
+        ++stats.reconnects;
+        recovered = true;
+    }
+    connected = true;
+    ever_connected = true;
+    current_delay_ms = initial_delay_ms;
+    last_presence_check = Clock::now();
+    return recovered;
+}
+
+void ReconnectPolicy::markDisconnected() {
+    if (connected) {
+        ++stats.disconnects;
+        disconnected_since = Clock::now();
+    }
+    connected = false;
+    current_delay_ms = initial_delay_ms;
+    next_attempt = Clock::now() + std::chrono::milliseconds(current_delay_ms);
+}
+
+void ReconnectPolicy::attemptFailed() {
+    ++stats.failed_attempts;
+    current_delay_ms = current_delay_ms * 2 > max_delay_ms ? max_delay_ms : current_delay_ms * 2;
+    next_attempt = Clock::now() + std::chrono::milliseconds(current_delay_ms);
+}
+
+bool ReconnectPolicy::shouldAttempt() const {
+    return !connected && Clock::now() >= next_attempt;
+}
+
+bool ReconnectPolicy::shouldCheckPresence() {
+    auto now = Clock::now();
+    if (now - last_presence_check < std::chrono::seconds(1)) {
+        return false;
+    }
+    last_presence_check = now;
+    return true;
+}
+
+bool ReconnectPolicy::devicePresent(const std::string& path) {
+    return ::access(path.c_str(), F_OK) == 0;
+}
@@ -0,0 +1,200 @@
+#include "sample_pipeline.h"
+#include <algorithm>
+#include <cstdlib>
+
+SamplePipeline::SamplePipeline(const SamplePipelineConfig& config)
+    : config(config), batch_count(0), has_new_output(false) {
+    if (this->config.window == 0) {
+        this->config.window = 1;
+    } else if (this->config.window > SamplePipelineConfig::MAX_WINDOW) {
+        this->config.window = SamplePipelineConfig::MAX_WINDOW;
+    }
+    if (this->config.batch_size == 0) {
+        this->config.batch_size = 1;
+    }
+    if (!(this->config.ema_alpha > 0.0f) || this->config.ema_alpha > 1.0f) {
+        this->config.ema_alpha = 1.0f;
+    }
+
+    // 所有缓冲区在构造时一次性分配，运行期间不再分配内存
+    current_batch.resize(this->config.batch_size);
+    power_batch.resize(this->config.batch_size);
+    current_channel.cal = this->config.current_cal;
+    power_channel.cal = this->config.power_cal;
+    current_channel.history.resize(this->config.window);
+    power_channel.history.resize(this->config.window);
+    median_scratch.resize(this->config.window);
+}
+
+void SamplePipeline::setOutputCallback(std::function<void(float, float)> callback) {
+    outputCallback = callback;
+}
+
+void SamplePipeline::setPeakCallback(std::function<void(float)> callback) {
+    peakCallback = callback;
+}
+
+void SamplePipeline::setBatchCallback(std::function<void(const float*, size_t)> callback) {
+    batchCallback = callback;
+}
+
+void SamplePipeline::push(float current, float power) {
+    current_batch[batch_count] = current;
+    power_batch[batch_count] = power;
+    ++batch_count;
+
+    if (batch_count == config.batch_size) {
+        processBatch();
+    }
+}
+
+bool SamplePipeline::flush() {
+    processBatch();
+
+    if (!has_new_output) {
+        return false;
+    }
+    has_new_output = false;
+
+    if (outputCallback) {
+        outputCallback(filteredValue(current_channel), filteredValue(power_channel));
+    }
+    return true;
+}
+
+void SamplePipeline::processBatch() {
+    if (batch_count == 0) {
+        return;
+    }
+    size_t n = batch_count;
+    batch_count = 0;
+
+    processChannel(current_channel, current_batch.data(), n);
+    processChannel(power_channel, power_batch.data(), n);
+
+    // 峰值保持使用标定后的原始功率，不经过滤波
+    if (peakCallback) {
+        const float* p = power_batch.data();
+        float peak = p[0];
+        for (size_t i = 1; i < n; ++i) {
+            peak = p[i] > peak ? p[i] : peak;
+        }
+        peakCallback(peak);
+    }
+    if (batchCallback) {
+        batchCallback(power_batch.data(), n);
+    }
+
+    has_new_output = true;
+}
+
+void SamplePipeline::processChannel(Channel& channel, float* samples, size_t count) {
+    // 线性标定（简单的逐元素乘加，编译器可自动向量化）
+    const float gain = channel.cal.gain;
+    const float offset = channel.cal.offset;
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = samples[i] * gain + offset;
+    }
+
+    channel.last = samples[count - 1];
+
+    switch (config.filter) {
+        case FilterType::EMA: {
+            // EMA是递推的，只需顺序更新一个状态值
+            const float alpha = config.ema_alpha;
+            size_t i = 0;
+            if (!channel.ema_valid) {
+                channel.ema = samples[0];
+                channel.ema_valid = true;
+                i = 1;
+            }
+            float ema = channel.ema;
+            for (; i < count; ++i) {
+                ema += alpha * (samples[i] - ema);
+            }
+            channel.ema = ema;
+            break;
+        }
+        case FilterType::MOVING_AVERAGE:
+        case FilterType::MEDIAN: {
+            // 只保留最近 window 个样本，输出时再计算
+            const size_t window = channel.history.size();
+            size_t start = count > window ? count - window : 0;
+            for (size_t i = start; i < count; ++i) {
+                channel.history[channel.history_pos] = samples[i];
+                channel.history_pos = (channel.history_pos + 1) % window;
+            }
+            channel.history_count = std::min(window, channel.history_count + (count - start));
+            break;
+        }
+        case FilterType::NONE:
+            break;
+    }
+}
+
+float SamplePipeline::filteredValue(Channel& channel) {
+    switch (config.filter) {
+        case FilterType::EMA:
+            return channel.ema;
+        case FilterType::MOVING_AVERAGE: {
+            // 环形缓冲区未满时只有前 history_count 个有效；满了以后顺序无关
+            const float* h = channel.history.data();
+            const size_t n = channel.history_count;
+            float sum = 0.0f;
+            for (size_t i = 0; i < n; ++i) {
+                sum += h[i];
+            }
+            return n > 0 ? sum / static_cast<float>(n) : 0.0f;
+        }
+        case FilterType::MEDIAN: {
+            const size_t n = channel.history_count;
+            if (n == 0) {
+                return 0.0f;
+            }
+            std::copy(channel.history.begin(), channel.history.begin() + static_cast<std::ptrdiff_t>(n),
+                      median_scratch.begin());
+            auto mid = median_scratch.begin() + static_cast<std::ptrdiff_t>(n / 2);
+            std::nth_element(median_scratch.begin(), mid,
+                             median_scratch.begin() + static_cast<std::ptrdiff_t>(n));
+            return *mid;
+        }
+        case FilterType::NONE:
+            break;
+    }
+    return channel.last;
+}
+
+bool SamplePipeline::parseFilterType(const std::string& name, FilterType& type) {
+    if (name == "none") {
+        type = FilterType::NONE;
+    } else if (name == "ma") {
+        type = FilterType::MOVING_AVERAGE;
+    } else if (name == "median") {
+        type = FilterType::MEDIAN;
+    } else if (name == "ema") {
+        type = FilterType::EMA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SamplePipeline::parseCalibration(const std::string& text, Calibration& cal) {
+    size_t comma = text.find(',');
+    if (comma == std::string::npos) {
+        return false;
+    }
+    char* end = nullptr;
+    float gain = std::strtof(text.c_str(), &end);
+    if (end != text.c_str() + comma) {
+        return false;
+    }
+    const char* offset_str = text.c_str() + comma + 1;
+    float offset = std::strtof(offset_str, &end);
+    if (end == offset_str || *end != '\0') {
+        return false;
+    }
+    cal.gain = gain;
+    cal.offset = offset;
+    return true;
+}
@@ -0,0 +1,323 @@
+#include "screen_fanout_transport.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+ScreenFanoutTransport::ScreenFanoutTransport(std::vector<std::unique_ptr<Transport>> transports,
+                                             size_t buffer_capacity)
+    : opened(false), buffer_capacity(buffer_capacity), base(0), events_head(0), last_event_source(0) {
+    ports.resize(transports.size());
+    for (size_t i = 0; i < transports.size(); ++i) {
+        ports[i].transport = std::move(transports[i]);
+        ports[i].rx_frame.reserve(FRAME_SIZE);
+    }
+    buffer.reserve(buffer_capacity);
+    events.reserve(64 * FRAME_SIZE);
+    event_sources.reserve(64);
+}
+
+ScreenFanoutTransport::~ScreenFanoutTransport() {
+    close();
+}
+
+std::string ScreenFanoutTransport::getName() const {
+    std::string name;
+    for (const auto& port : ports) {
+        if (!name.empty()) {
+            name += ",";
+        }
+        name += port.transport->getName();
+    }
+    return name;
+}
+
+bool ScreenFanoutTransport::anyConnected() const {
+    for (const auto& port : ports) {
+        if (port.reconnect.isConnected()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ScreenFanoutTransport::open() {
+    for (size_t i = 0; i < ports.size(); ++i) {
+        if (!ports[i].reconnect.isConnected()) {
+            openPort(i);
+        }
+    }
+    // 至少一个屏幕在线即可工作，其余在后台重连
+    opened = anyConnected();
+    return opened;
+}
+
+bool ScreenFanoutTransport::openPort(size_t index) {
+    Port& port = ports[index];
+    if (!port.transport->open()) {
+        port.transport->close();
+        port.reconnect.markDisconnected();
+        return false;
+    }
+
+    port.transport->flushInput();
+    port.rx_frame.clear();
+    port.cursor = end(); // 新连上的屏幕不补发积压的旧命令，由全量刷新恢复显示
+
+    if (port.reconnect.markConnected()) {
+        const auto& stats = port.reconnect.getStats();
+        std::cout << "串口屏串口已恢复: " << port.transport->getName() << " 恢复耗时: " << std::fixed
+                  << std::setprecision(1) << stats.last_recovery_ms << " ms" << std::endl;
+    }
+    return true;
+}
+
+void ScreenFanoutTransport::portDown(size_t index, const char* reason) {
+    Port& port = ports[index];
+    std::cerr << "串口屏串口断开: " << port.transport->getName() << " (" << reason << ")，将在后台重连" << std::endl;
+    port.transport->close();
+    port.reconnect.markDisconnected();
+    port.rx_frame.clear();
+}
+
+void ScreenFanoutTransport::close() {
+    for (auto& port : ports) {
+        port.transport->close();
+        port.reconnect.markDisconnected();
+        port.rx_frame.clear();
+    }
+    opened = false;
+    base = end();
+    buffer.clear();
+    events.clear();
+    event_sources.clear();
+    events_head = 0;
+}
+
+void ScreenFanoutTransport::maintainPorts() {
+    for (size_t i = 0; i < ports.size(); ++i) {
+        Port& port = ports[i];
+        if (port.reconnect.isConnected()) {
+            if (port.transport->getFileDescriptor() >= 0 && port.reconnect.shouldCheckPresence() &&
+                !ReconnectPolicy::devicePresent(port.transport->getName())) {
+                portDown(i, "设备节点消失");
+            }
+        } else if (port.reconnect.shouldAttempt()) {
+            if (openPort(i)) {
+                requestRefresh();
+            } else {
+                port.reconnect.attemptFailed();
+            }
+        }
+    }
+}
+
+void ScreenFanoutTransport::requestRefresh() {
+    if (refresh_callback) {
+        refresh_callback();
+    }
+}
+
+void ScreenFanoutTransport::pollInput() {
+    uint8_t chunk[64];
+    for (size_t i = 0; i < ports.size(); ++i) {
+        Port& port = ports[i];
+        while (port.reconnect.isConnected()) {
+            int n = port.transport->readNonblocking(chunk, sizeof(chunk));
+            if (n < 0) {
+                portDown(i, "读取错误");
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            for (int k = 0; k < n; ++k) {
+                if (port.rx_frame.empty() && chunk[k] != 0x65) {
+                    continue; // 等待帧头
+                }
+                port.rx_frame.push_back(chunk[k]);
+                if (port.rx_frame.size() == FRAME_SIZE) {
+                    // 整帧追加到合并事件流，保证不同屏幕的帧不会交错
+                    events.insert(events.end(), port.rx_frame.begin(), port.rx_frame.end());
+                    event_sources.push_back(i);
+                    ++port.stats.events;
+                    port.rx_frame.clear();
+                }
+            }
+        }
+    }
+}
+
+int ScreenFanoutTransport::readNonblocking(uint8_t* out, size_t n) {
+    if (!opened) {
+        return -1;
+    }
+    maintainPorts();
+    if (events_head == events.size()) {
+        events.clear();
+        event_sources.clear();
+        events_head = 0;
+        pollInput();
+    }
+    if (events_head == events.size() && !anyConnected()) {
+        return -1; // 所有屏幕都已断开，交给协议层的重连逻辑
+    }
+
+    size_t available = events.size() - events_head;
+    size_t count = n < available ? n : available;
+    if (count > 0) {
+        last_event_source = event_sources[events_head / FRAME_SIZE];
+        std::memcpy(out, events.data() + events_head, count);
+        events_head += count;
+    }
+    return static_cast<int>(count);
+}
+
+int ScreenFanoutTransport::read(uint8_t* out, size_t n, unsigned int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    size_t got = 0;
+    while (got < n) {
+        int r = readNonblocking(out + got, n - got);
+        if (r < 0) {
+            return got > 0 ? static_cast<int>(got) : -1;
+        }
+        got += static_cast<size_t>(r);
+        if (got == n || std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        if (r == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return static_cast<int>(got);
+}
+
+void ScreenFanoutTransport::compact() {
+    // 丢弃所有在线串口都已写出的部分
+    size_t min_cursor = end();
+    for (const auto& port : ports) {
+        if (port.reconnect.isConnected() && port.cursor < min_cursor) {
+            min_cursor = port.cursor;
+        }
+    }
+    if (min_cursor > base) {
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(min_cursor - base));
+        base = min_cursor;
+    }
+}
+
+bool ScreenFanoutTransport::append(const struct iovec* iov, int iovcnt) {
+    size_t length = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        length += iov[i].iov_len;
+    }
+    if (length > buffer_capacity) {
+        return false;
+    }
+    if (buffer.size() + length > buffer_capacity) {
+        compact();
+    }
+    bool dropped = false;
+    while (buffer.size() + length > buffer_capacity) {
+        // 积压最多的串口跳到最新位置，只影响它自己
+        Port* slowest = nullptr;
+        for (auto& port : ports) {
+            if (port.reconnect.isConnected() && port.cursor < end() &&
+                (!slowest || port.cursor < slowest->cursor)) {
+                slowest = &port;
+            }
+        }
+        if (!slowest) {
+            base = end();
+            buffer.clear();
+            break;
+        }
+        slowest->stats.bytes_dropped += end() - slowest->cursor;
+        ++slowest->stats.overflows;
+        slowest->cursor = end();
+        dropped = true;
+        compact();
+    }
+    // 命令和结束符作为一个整体追加，跳过积压时游标总是落在命令边界上
+    for (int i = 0; i < iovcnt; ++i) {
+        const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+        buffer.insert(buffer.end(), data, data + iov[i].iov_len);
+    }
+    if (dropped) {
+        requestRefresh();
+    }
+    return true;
+}
+
+void ScreenFanoutTransport::pump() {
+    bool all_caught_up = true;
+    for (size_t i = 0; i < ports.size(); ++i) {
+        Port& port = ports[i];
+        if (!port.reconnect.isConnected() || port.cursor >= end()) {
+            continue;
+        }
+        int n = port.transport->write(buffer.data() + (port.cursor - base), end() - port.cursor);
+        if (n < 0) {
+            portDown(i, "写入错误");
+            continue;
+        }
+        port.cursor += static_cast<size_t>(n);
+        port.stats.bytes_written += static_cast<uint64_t>(n);
+        if (port.cursor < end()) {
+            all_caught_up = false; // 发送缓冲区已满，下次再写
+        }
+    }
+    if (all_caught_up) {
+        base = end();
+        buffer.clear();
+    }
+}
+
+int ScreenFanoutTransport::write(const uint8_t* data, size_t length) {
+    struct iovec iov;
+    iov.iov_base = const_cast<uint8_t*>(data);
+    iov.iov_len = length;
+    return writev(&iov, 1);
+}
+
+int ScreenFanoutTransport::writev(const struct iovec* iov, int iovcnt) {
+    if (!opened) {
+        return -1;
+    }
+    // 格式化好的命令只追加一次，各屏幕共享同一份字节
+    int total = 0;
+    if (append(iov, iovcnt)) {
+        for (int i = 0; i < iovcnt; ++i) {
+            total += static_cast<int>(iov[i].iov_len);
+        }
+    }
+    pump();
+    return anyConnected() ? total : -1;
+}
+
+bool ScreenFanoutTransport::drain() {
+    pump();
+    return anyConnected();
+}
+
+bool ScreenFanoutTransport::flushInput() {
+    for (auto& port : ports) {
+        if (port.reconnect.isConnected()) {
+            port.transport->flushInput();
+        }
+        port.rx_frame.clear();
+    }
+    events.clear();
+    event_sources.clear();
+    events_head = 0;
+    return true;
+}
+
+ScreenFanoutTransport::PortStats ScreenFanoutTransport::getPortStats(size_t index) const {
+    const Port& port = ports[index];
+    PortStats stats = port.stats;
+    stats.connected = port.reconnect.isConnected();
+    stats.backlog = stats.connected ? end() - port.cursor : 0;
+    return stats;
+}
@@ -0,0 +1,168 @@
+#include "screen_tx_scheduler.h"
+#include <cstring>
+
+namespace {
+// 令牌桶容量：一个刷新周期（50ms）的预算，至少容纳一条最长的命令
+const double BURST_SECONDS = 0.05;
+// 交互类命令不等待令牌，最多透支1秒的预算，之后周期类命令相应推迟
+const double MAX_DEBT_SECONDS = 1.0;
+}
+
+ScreenTxScheduler::ScreenTxScheduler(double budget_bytes_per_s)
+    : budget_bytes_per_s(0.0), capacity(0.0), tokens(0.0), last_refill(Clock::now()), window_start(last_refill) {
+    setBudget(budget_bytes_per_s);
+    tokens = capacity;
+}
+
+void ScreenTxScheduler::setBudget(double bytes_per_s) {
+    budget_bytes_per_s = bytes_per_s > 0.0 ? bytes_per_s : 1.0;
+    capacity = budget_bytes_per_s * BURST_SECONDS;
+    const double min_capacity = static_cast<double>(MAX_COMMAND_SIZE + TERMINATOR_SIZE);
+    if (capacity < min_capacity) {
+        capacity = min_capacity;
+    }
+    if (tokens > capacity) {
+        tokens = capacity;
+    }
+}
+
+void ScreenTxScheduler::refill(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - last_refill).count();
+    if (elapsed <= 0.0) {
+        return;
+    }
+    last_refill = now;
+    tokens += elapsed * budget_bytes_per_s;
+    if (tokens > capacity) {
+        tokens = capacity;
+    }
+}
+
+void ScreenTxScheduler::enqueue(Priority priority, std::string_view key, std::string_view command,
+                                Clock::time_point now) {
+    ClassStats& cls = stats[priority];
+    ++cls.queued;
+    ++window.classes[priority].queued;
+
+    if (key.size() > MAX_KEY_SIZE) {
+        key = key.substr(0, MAX_KEY_SIZE);
+    }
+    if (command.size() > MAX_COMMAND_SIZE) {
+        command = command.substr(0, MAX_COMMAND_SIZE);
+    }
+
+    Slot* target = nullptr;
+    Slot* free_slot = nullptr;
+    for (Slot& slot : slots) {
+        if (!slot.pending) {
+            if (!free_slot) {
+                free_slot = &slot;
+            }
+            continue;
+        }
+        if (slot.priority == priority && std::string_view(slot.key, slot.key_length) == key) {
+            target = &slot;
+            break;
+        }
+    }
+
+    if (target) {
+        // 同一控件的旧值尚未发出：只发送最新值，排队时间从旧值入队时算起
+        ++cls.superseded;
+        ++window.classes[priority].superseded;
+    } else if (free_slot) {
+        target = free_slot;
+        target->pending = true;
+        target->priority = priority;
+        std::memcpy(target->key, key.data(), key.size());
+        target->key_length = key.size();
+        target->queued_at = now;
+    } else {
+        ++cls.dropped;
+        ++window.classes[priority].dropped;
+        return;
+    }
+
+    std::memcpy(target->command, command.data(), command.size());
+    target->command_length = command.size();
+}
+
+ScreenTxScheduler::Slot* ScreenTxScheduler::oldestPending(Priority priority) {
+    Slot* oldest = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.pending && slot.priority == priority && (!oldest || slot.queued_at < oldest->queued_at)) {
+            oldest = &slot;
+        }
+    }
+    return oldest;
+}
+
+bool ScreenTxScheduler::next(std::string_view& command, Clock::time_point now) {
+    refill(now);
+
+    Slot* slot = oldestPending(PRIORITY_INTERACTIVE);
+    size_t cost = 0;
+    if (slot) {
+        cost = slot->command_length + TERMINATOR_SIZE;
+        if (tokens - static_cast<double>(cost) < -budget_bytes_per_s * MAX_DEBT_SECONDS) {
+            return false;
+        }
+    } else {
+        slot = oldestPending(PRIORITY_PERIODIC);
+        if (!slot) {
+            return false;
+        }
+        cost = slot->command_length + TERMINATOR_SIZE;
+        if (tokens < static_cast<double>(cost)) {
+            return false; // 预算不足，等待下一次发送机会
+        }
+    }
+
+    tokens -= static_cast<double>(cost);
+    slot->pending = false;
+    double delay_ms = std::chrono::duration<double, std::milli>(now - slot->queued_at).count();
+    record(stats[slot->priority], cost, delay_ms);
+    record(window.classes[slot->priority], cost, delay_ms);
+    command = std::string_view(slot->command, slot->command_length);
+    return true;
+}
+
+void ScreenTxScheduler::record(ClassStats& target, size_t bytes, double delay_ms) {
+    ++target.sent;
+    target.bytes += bytes;
+    target.delay_sum_ms += delay_ms;
+    if (delay_ms > target.delay_max_ms) {
+        target.delay_max_ms = delay_ms;
+    }
+}
+
+bool ScreenTxScheduler::hasPending(Priority priority) const {
+    for (const Slot& slot : slots) {
+        if (slot.pending && slot.priority == priority) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ScreenTxScheduler::clear() {
+    for (Slot& slot : slots) {
+        slot.pending = false;
+    }
+}
+
+ScreenTxScheduler::Window ScreenTxScheduler::takeWindow(Clock::time_point now) {
+    Window result = window;
+    result.seconds = std::chrono::duration<double>(now - window_start).count();
+    window = Window();
+    window_start = now;
+    return result;
+}
+
+const char* ScreenTxScheduler::priorityName(Priority priority) {
+    switch (priority) {
+        case PRIORITY_INTERACTIVE: return "交互";
+        case PRIORITY_PERIODIC: return "周期";
+        default: return "未知";
+    }
+}
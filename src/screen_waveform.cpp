@@ -0,0 +1,140 @@
+#include "screen_waveform.h"
+#include <cstdio>
+
+WaveformStream::WaveformStream(const WaveformConfig& config, size_t max_pending)
+    : config(config), state(State::IDLE), pending(max_pending > 0 ? max_pending : 1), pending_head(0),
+      pending_count(0), decimation_sum(0.0f), decimation_count(0), tokens(0.0), last_refill(Clock::now()) {
+    if (this->config.batch_points == 0) {
+        this->config.batch_points = 1;
+    }
+    if (this->config.batch_points > pending.size()) {
+        this->config.batch_points = pending.size();
+    }
+    if (this->config.decimation == 0) {
+        this->config.decimation = 1;
+    }
+    if (this->config.height <= 0 || this->config.height > 255) {
+        this->config.height = 255;
+    }
+    inflight.reserve(this->config.batch_points);
+}
+
+uint8_t WaveformStream::scale(float power) const {
+    if (config.full_scale <= 0.0f || power <= 0.0f) {
+        return 0;
+    }
+    float y = power / config.full_scale * static_cast<float>(config.height);
+    if (y >= static_cast<float>(config.height)) {
+        return static_cast<uint8_t>(config.height);
+    }
+    return static_cast<uint8_t>(y + 0.5f);
+}
+
+void WaveformStream::push(float power) {
+    ++stats.samples;
+    decimation_sum += power;
+    if (++decimation_count < config.decimation) {
+        return;
+    }
+    float mean = decimation_sum / static_cast<float>(decimation_count);
+    decimation_sum = 0.0f;
+    decimation_count = 0;
+
+    if (pending_count == pending.size()) {
+        // 积压已满：丢弃最旧的点，曲线保持最新
+        pending_head = (pending_head + 1) % pending.size();
+        --pending_count;
+        ++stats.points_dropped;
+    }
+    pending[(pending_head + pending_count) % pending.size()] = scale(mean);
+    ++pending_count;
+}
+
+void WaveformStream::refill() {
+    auto now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_refill).count();
+    last_refill = now;
+    tokens += elapsed * config.budget_bytes_per_s;
+    // 最多积攒一秒的预算（至少够两批），避免空闲后突发占满链路
+    double cap = config.budget_bytes_per_s;
+    double min_cap = 2.0 * static_cast<double>(config.batch_points + 16);
+    if (cap < min_cap) {
+        cap = min_cap;
+    }
+    if (tokens > cap) {
+        tokens = cap;
+    }
+}
+
+bool WaveformStream::readyToSend() {
+    refill();
+    if (state != State::IDLE || pending_count < config.batch_points) {
+        return false;
+    }
+    // addt 命令约14字节 + 点数据
+    double cost = static_cast<double>(config.batch_points + 16);
+    return tokens >= cost;
+}
+
+size_t WaveformStream::beginTransfer(char* cmd, size_t capacity) {
+    size_t count = config.batch_points < pending_count ? config.batch_points : pending_count;
+    int length = snprintf(cmd, capacity, "addt %d,%d,%zu", config.component_id, config.channel, count);
+    if (count == 0 || length <= 0 || static_cast<size_t>(length) >= capacity) {
+        return 0;
+    }
+
+    inflight.clear();
+    for (size_t i = 0; i < count; ++i) {
+        inflight.push_back(pending[pending_head]);
+        pending_head = (pending_head + 1) % pending.size();
+    }
+    pending_count -= count;
+
+    size_t bytes = static_cast<size_t>(length) + 3 + count;
+    tokens -= static_cast<double>(bytes);
+    stats.bytes_sent += bytes;
+    state = State::WAIT_READY;
+    deadline = Clock::now() + std::chrono::milliseconds(config.handshake_timeout_ms);
+    return static_cast<size_t>(length);
+}
+
+const std::vector<uint8_t>& WaveformStream::onReady() {
+    if (state != State::WAIT_READY) {
+        // 重复或迟到的 0xFE：本批点数据已经发出（或已超时放弃），不能再写一次
+        return no_points;
+    }
+    state = State::WAIT_DONE;
+    deadline = Clock::now() + std::chrono::milliseconds(config.handshake_timeout_ms);
+    return inflight;
+}
+
+void WaveformStream::onDone() {
+    if (state != State::WAIT_DONE) {
+        return;
+    }
+    stats.points_sent += inflight.size();
+    ++stats.transfers;
+    inflight.clear();
+    state = State::IDLE;
+}
+
+bool WaveformStream::checkTimeout() {
+    if (state == State::IDLE || Clock::now() < deadline) {
+        return false;
+    }
+    stats.points_dropped += inflight.size();
+    ++stats.timeouts;
+    inflight.clear();
+    state = State::IDLE;
+    return true;
+}
+
+void WaveformStream::reset() {
+    stats.points_dropped += inflight.size() + pending_count;
+    inflight.clear();
+    pending_head = 0;
+    pending_count = 0;
+    decimation_sum = 0.0f;
+    decimation_count = 0;
+    state = State::IDLE;
+}
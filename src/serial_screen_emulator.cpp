@@ -0,0 +1,333 @@
+#include "serial_screen_emulator.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+SerialScreenEmulator::SerialScreenEmulator()
+    : master_fd(-1), slave_fd(-1), transparent_remaining(0), last_waveform_point(-1), script_repeat(false),
+      script_index(0), waiting(false) {
+    pending.reserve(MAX_COMMAND_LENGTH);
+}
+
+SerialScreenEmulator::~SerialScreenEmulator() {
+    close();
+}
+
+bool SerialScreenEmulator::open(const std::string& link_path) {
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0) {
+        std::cerr << "无法创建伪终端: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        std::cerr << "无法解锁伪终端: " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    const char* name = ptsname(master_fd);
+    if (!name) {
+        std::cerr << "无法获取伪终端从端名称" << std::endl;
+        close();
+        return false;
+    }
+    slave_path = name;
+
+    // 从端设置为原始模式，保证 0xFF 等字节原样传输
+    slave_fd = ::open(slave_path.c_str(), O_RDWR | O_NOCTTY);
+    if (slave_fd >= 0) {
+        struct termios tio;
+        if (tcgetattr(slave_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, B9600);
+            cfsetospeed(&tio, B9600);
+            tcsetattr(slave_fd, TCSANOW, &tio);
+        }
+    }
+
+    int flags = fcntl(master_fd, F_GETFL, 0);
+    fcntl(master_fd, F_SETFL, flags | O_NONBLOCK);
+
+    if (!link_path.empty()) {
+        ::unlink(link_path.c_str());
+        if (::symlink(slave_path.c_str(), link_path.c_str()) != 0) {
+            std::cerr << "无法创建符号链接: " << link_path << " (" << std::strerror(errno) << ")" << std::endl;
+        } else {
+            this->link_path = link_path;
+        }
+    }
+
+    std::cout << "串口屏模拟器已启动, 从端: " << slave_path;
+    if (!this->link_path.empty()) {
+        std::cout << " (链接: " << this->link_path << ")";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+void SerialScreenEmulator::close() {
+    if (!link_path.empty()) {
+        ::unlink(link_path.c_str());
+        link_path.clear();
+    }
+    if (slave_fd >= 0) {
+        ::close(slave_fd);
+        slave_fd = -1;
+    }
+    if (master_fd >= 0) {
+        ::close(master_fd);
+        master_fd = -1;
+    }
+}
+
+void SerialScreenEmulator::setScript(const std::vector<ScreenScriptStep>& steps, bool repeat) {
+    script = steps;
+    script_repeat = repeat;
+    script_index = 0;
+    if (!script.empty()) {
+        next_step_time = Clock::now() + std::chrono::milliseconds(script[0].delay_ms);
+    }
+}
+
+bool SerialScreenEmulator::loadScript(const std::string& path, std::vector<ScreenScriptStep>& steps) {
+    // 每行: 延迟ms 页面 控件 事件 [期望响应控件]，页面/控件/事件为十六进制，# 开头为注释
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "无法打开脚本文件: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(line);
+        ScreenScriptStep step;
+        unsigned int page, control, event;
+        if (!(iss >> std::dec >> step.delay_ms >> std::hex >> page >> control >> event)) {
+            std::cerr << "脚本格式错误, 第" << line_no << "行: " << line << std::endl;
+            return false;
+        }
+        step.page = static_cast<uint8_t>(page);
+        step.control = static_cast<uint8_t>(control);
+        step.event = static_cast<uint8_t>(event);
+        iss >> step.expect_widget;
+        steps.push_back(step);
+    }
+    return true;
+}
+
+bool SerialScreenEmulator::injectEvent(uint8_t page, uint8_t control, uint8_t event) {
+    uint8_t frame[7] = {0x65, page, control, event, 0xFF, 0xFF, 0xFF};
+    if (!injectBytes(frame, sizeof(frame))) {
+        return false;
+    }
+    ++stats.events_injected;
+    return true;
+}
+
+bool SerialScreenEmulator::injectBytes(const uint8_t* data, size_t length) {
+    if (master_fd < 0) {
+        return false;
+    }
+    ssize_t n = ::write(master_fd, data, length);
+    return n == static_cast<ssize_t>(length);
+}
+
+void SerialScreenEmulator::poll(int timeout_ms) {
+    if (master_fd < 0) {
+        return;
+    }
+
+    // 脚本的下一步可能比 timeout_ms 更早到期
+    if (!script.empty() && script_index < script.size()) {
+        auto until_step = std::chrono::duration_cast<std::chrono::milliseconds>(
+            next_step_time - Clock::now()).count();
+        if (until_step < timeout_ms) {
+            timeout_ms = until_step > 0 ? static_cast<int>(until_step) : 0;
+        }
+    }
+
+    struct pollfd pfd = {master_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN)) {
+        uint8_t buffer[4096];
+        ssize_t n;
+        while ((n = ::read(master_fd, buffer, sizeof(buffer))) > 0) {
+            feed(buffer, static_cast<size_t>(n));
+        }
+    }
+
+    if (waiting && Clock::now() - waiting_since > std::chrono::milliseconds(RESPONSE_TIMEOUT_MS)) {
+        ++stats.response_timeouts;
+        waiting = false;
+    }
+
+    runScript();
+}
+
+void SerialScreenEmulator::runScript() {
+    if (script.empty() || script_index >= script.size() || Clock::now() < next_step_time) {
+        return;
+    }
+
+    const ScreenScriptStep& step = script[script_index];
+    if (injectEvent(step.page, step.control, step.event) && !step.expect_widget.empty()) {
+        waiting_widget = step.expect_widget;
+        waiting_since = Clock::now();
+        waiting = true;
+    }
+
+    ++script_index;
+    if (script_index >= script.size() && script_repeat) {
+        script_index = 0;
+    }
+    if (script_index < script.size()) {
+        next_step_time = Clock::now() + std::chrono::milliseconds(script[script_index].delay_ms);
+    }
+}
+
+void SerialScreenEmulator::feed(const uint8_t* data, size_t length) {
+    stats.bytes += length;
+    for (size_t i = 0; i < length; ++i) {
+        if (transparent_remaining > 0) {
+            // 透传状态：每个字节都是一个波形点
+            last_waveform_point = data[i];
+            ++stats.waveform_points;
+            ++stats.waveform_bytes;
+            if (--transparent_remaining == 0) {
+                static const uint8_t done[4] = {0xFD, 0xFF, 0xFF, 0xFF};
+                injectBytes(done, sizeof(done));
+                ++stats.waveform_transfers;
+            }
+            continue;
+        }
+        pending.push_back(data[i]);
+        size_t n = pending.size();
+        if (n >= 3 && pending[n - 1] == 0xFF && pending[n - 2] == 0xFF && pending[n - 3] == 0xFF) {
+            handleCommand(pending.data(), n - 3);
+            pending.clear();
+        } else if (n > MAX_COMMAND_LENGTH) {
+            // 长时间没有结束符，视为垃圾数据
+            ++stats.malformed;
+            pending.clear();
+        }
+    }
+}
+
+void SerialScreenEmulator::handleCommand(const uint8_t* data, size_t length) {
+    if (length == 0) {
+        ++stats.malformed;
+        return;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] < 0x20 || data[i] == 0xFF) {
+            ++stats.malformed; // 命令中不应出现控制字符
+            return;
+        }
+    }
+
+    std::string cmd(reinterpret_cast<const char*>(data), length);
+    size_t eq = cmd.find('=');
+    if (eq == std::string::npos) {
+        // 非赋值指令：指令名由字母组成，后跟空格分隔的参数，如 "page 0"、"ref t0"
+        size_t word_end = 0;
+        while (word_end < cmd.size() && std::isalpha(static_cast<unsigned char>(cmd[word_end]))) {
+            ++word_end;
+        }
+        if (word_end > 0 && (word_end == cmd.size() || cmd[word_end] == ' ')) {
+            ++stats.instructions;
+            int id, channel, count;
+            char extra;
+            if (cmd.compare(0, word_end, "addt") == 0 &&
+                std::sscanf(cmd.c_str() + word_end, " %d,%d,%d%c", &id, &channel, &count, &extra) == 3 &&
+                count > 0) {
+                // 进入透传状态并应答准备就绪
+                static const uint8_t ready[4] = {0xFE, 0xFF, 0xFF, 0xFF};
+                transparent_remaining = static_cast<size_t>(count);
+                stats.waveform_bytes += length + 3;
+                injectBytes(ready, sizeof(ready));
+            }
+        } else {
+            ++stats.malformed;
+        }
+        return;
+    }
+
+    std::string name = cmd.substr(0, eq);
+    std::string value = cmd.substr(eq + 1);
+    if (name.empty() || name.find(' ') != std::string::npos) {
+        ++stats.malformed;
+        return;
+    }
+    if (!value.empty() && value[0] == '"') {
+        if (value.size() < 2 || value.back() != '"') {
+            ++stats.malformed; // 引号不匹配
+            return;
+        }
+        value = value.substr(1, value.size() - 2);
+    } else if (value.empty()) {
+        ++stats.malformed;
+        return;
+    }
+
+    widgets[name] = value;
+    ++stats.commands;
+
+    if (waiting && name == waiting_widget) {
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - waiting_since).count();
+        if (stats.responses == 0 || ms < stats.latency_min_ms) {
+            stats.latency_min_ms = ms;
+        }
+        if (ms > stats.latency_max_ms) {
+            stats.latency_max_ms = ms;
+        }
+        stats.latency_sum_ms += ms;
+        ++stats.responses;
+        waiting = false;
+    }
+}
+
+void SerialScreenEmulator::printReport(double elapsed_s) const {
+    if (elapsed_s <= 0.0) {
+        elapsed_s = 1.0;
+    }
+    std::cout << "\n=== 串口屏模拟器统计 ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "运行时间: " << elapsed_s << " s" << std::endl;
+    std::cout << "接收字节: " << stats.bytes << " (" << stats.bytes / elapsed_s << " B/s)" << std::endl;
+    std::cout << "赋值命令: " << stats.commands << " (" << stats.commands / elapsed_s << " 条/s)" << std::endl;
+    std::cout << "其他指令: " << stats.instructions << std::endl;
+    std::cout << "格式错误: " << stats.malformed << std::endl;
+    std::cout << "注入按键: " << stats.events_injected << std::endl;
+    std::cout << std::setprecision(2);
+    if (stats.responses > 0) {
+        std::cout << "按键响应延迟: 最小 " << stats.latency_min_ms << " ms, 平均 "
+                  << stats.latency_sum_ms / static_cast<double>(stats.responses) << " ms, 最大 "
+                  << stats.latency_max_ms << " ms (" << stats.responses << " 次)" << std::endl;
+    }
+    std::cout << "响应超时: " << stats.response_timeouts << std::endl;
+    if (stats.waveform_transfers > 0) {
+        std::cout << "波形透传: " << stats.waveform_transfers << " 次, " << stats.waveform_points << " 点 ("
+                  << stats.waveform_points / elapsed_s << " 点/s), 每点 "
+                  << static_cast<double>(stats.waveform_bytes) / static_cast<double>(stats.waveform_points)
+                  << " 字节, 最新点 " << last_waveform_point << std::endl;
+    }
+    std::cout << "控件表:" << std::endl;
+    for (const auto& widget : widgets) {
+        std::cout << "  " << widget.first << " = \"" << widget.second << "\"" << std::endl;
+    }
+    std::cout << "========================\n" << std::endl;
+}
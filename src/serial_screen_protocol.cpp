@@ -1,4 +1,5 @@
 #include "serial_screen_protocol.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
@@ -9,10 +10,30 @@
 #include <mutex>
 #include <random>
 
-SerialScreenProtocol::SerialScreenProtocol(const std::string& port_name, int baud_rate) 
-    : port_name(port_name), baud_rate(baud_rate), port(nullptr), 
+SerialScreenProtocol::SerialScreenProtocol(const std::string& port_name, int baud_rate, TransportType transport_type)
+    : port_name(port_name),
       distance_D(0.0f), side_length_x(0.0f), current_I(0.0f), power_P(0.0f), max_power(0.0f),
-      start_received(false), data_updated(false) {
+      data_updated(false), refresh_requested(false), external_receive(false), external_transmit(false), tx(baud_rate / 10.0), link_bytes_per_s(baud_rate / 10.0) {
+    SerialSettings settings;
+    settings.baud_rate = baud_rate;
+    settings.read_write = true;
+    transport = createTransport(transport_type, port_name, settings);
+    initDebugValues();
+}
+
+SerialScreenProtocol::SerialScreenProtocol(std::unique_ptr<Transport> transport, int baud_rate)
+    : port_name(transport->getName()), transport(std::move(transport)),
+      distance_D(0.0f), side_length_x(0.0f), current_I(0.0f), power_P(0.0f), max_power(0.0f),
+      data_updated(false), refresh_requested(false), external_receive(false), external_transmit(false), tx(baud_rate / 10.0), link_bytes_per_s(baud_rate / 10.0) {
+    initDebugValues();
+}
+
+void SerialScreenProtocol::initDebugValues() {
+    rx_frame.reserve(16);
+    tx_pending.reserve(4 * (ScreenTxScheduler::MAX_COMMAND_SIZE + ScreenTxScheduler::TERMINATOR_SIZE));
+    tx_pending_head = 0;
+    last_cmd_length = 0;
+    next_tx_report = std::chrono::steady_clock::now() + std::chrono::seconds(TX_REPORT_INTERVAL_S);
     
     // 生成100以内的随机值用于调试
     std::random_device rd;
@@ -31,64 +52,70 @@ SerialScreenProtocol::~SerialScreenProtocol() {
 }
 
 bool SerialScreenProtocol::open() {
-    int result = sp_get_port_by_name(port_name.c_str(), &port);
-    if (result != SP_OK) {
-        std::cerr << "无法打开串口屏串口: " << port_name << std::endl;
+    if (!openPort()) {
+        close();
+        reconnect.markDisconnected();
         return false;
     }
 
-    result = sp_open(port, SP_MODE_READ_WRITE);
-    if (result != SP_OK) {
-        std::cerr << "无法打开串口屏串口进行读写" << std::endl;
-        return false;
+    // 丢弃断线前残留的半帧数据
+    transport->flushInput();
+    rx_frame.clear();
+    tx_pending.clear(); // 断线前没写完的命令不再补发，由全量刷新恢复显示
+    tx_pending_head = 0;
+    if (waveform) {
+        waveform->reset(); // 放弃断线前进行中的波形传输
     }
 
-    // 设置完整的串口参数，与系统配置保持一致
-    result = sp_set_baudrate(port, baud_rate);
-    if (result != SP_OK) {
-        std::cerr << "无法设置串口屏波特率: " << baud_rate << std::endl;
-        return false;
-    }
+    if (reconnect.markConnected()) {
+        const auto& stats = reconnect.getStats();
+        std::cout << "串口屏串口已恢复: " << port_name << " 恢复耗时: " << std::fixed << std::setprecision(1)
+                  << stats.last_recovery_ms << " ms (累计重连 " << stats.reconnects << " 次)" << std::endl;
 
-    // 设置数据位为8位
-    result = sp_set_bits(port, 8);
-    if (result != SP_OK) {
-        std::cerr << "无法设置串口屏数据位" << std::endl;
-        return false;
+        // 屏幕可能已重新上电，重新发送全部数据恢复显示
+        std::lock_guard<std::mutex> lock(data_mutex);
+        sendAllData();
+        pumpTx();
     }
+    return true;
+}
 
-    // 设置停止位为1位
-    result = sp_set_stopbits(port, 1);
-    if (result != SP_OK) {
-        std::cerr << "无法设置串口屏停止位" << std::endl;
-        return false;
+void SerialScreenProtocol::handleDisconnect(const char* reason) {
+    std::cerr << "串口屏串口断开: " << port_name << " (" << reason << ")，将在后台重连" << std::endl;
+    close();
+    reconnect.markDisconnected();
+    tx.clear(); // 重连后重新发送全部数据
+    tx_pending.clear();
+    tx_pending_head = 0;
+    if (waveform) {
+        waveform->reset();
     }
+}
 
-    // 设置无校验位
-    result = sp_set_parity(port, SP_PARITY_NONE);
-    if (result != SP_OK) {
-        std::cerr << "无法设置串口屏校验位" << std::endl;
-        return false;
+void SerialScreenProtocol::checkDevicePresent() {
+    // 没有设备节点的传输层（内存）不做检查
+    if (transport->getFileDescriptor() >= 0 && reconnect.shouldCheckPresence() &&
+        !ReconnectPolicy::devicePresent(port_name)) {
+        handleDisconnect("设备节点消失");
     }
+}
 
-    // 设置无流控制
-    result = sp_set_flowcontrol(port, SP_FLOWCONTROL_NONE);
-    if (result != SP_OK) {
-        std::cerr << "无法设置串口屏流控制" << std::endl;
-        return false;
+void SerialScreenProtocol::maintainConnection() {
+    if (reconnect.isConnected()) {
+        return;
+    }
+    if (reconnect.shouldAttempt() && !open()) {
+        reconnect.attemptFailed();
     }
+}
 
-    std::cout << "成功打开串口屏串口: " << port_name << " 波特率: " << baud_rate 
-              << " 数据位: 8 停止位: 1 校验位: 无 流控制: 无 (读写模式)" << std::endl;
-    return true;
+bool SerialScreenProtocol::openPort() {
+    // 共用串口时传感器读取器可能已经重新打开了串口
+    return transport->isOpen() || transport->open();
 }
 
 void SerialScreenProtocol::close() {
-    if (port) {
-        sp_close(port);
-        sp_free_port(port);
-        port = nullptr;
-    }
+    transport->close();
 }
 
 void SerialScreenProtocol::sendFloat(const std::string& name, float value) {
@@ -102,28 +129,155 @@ void SerialScreenProtocol::sendFloat(const std::string& name, float value) {
     sendCmd(cmd);
 }
 
-void SerialScreenProtocol::sendCmd(const std::string& cmd) {
-    if (!port) {
+void SerialScreenProtocol::sendCmd(std::string_view cmd) {
+    if (!transport->isOpen()) {
         return; // 串口未打开就直接返回，不报错
     }
 
-    // 使用非阻塞方式发送命令字符串
-    sp_nonblocking_write(port, 
-        reinterpret_cast<const uint8_t*>(cmd.c_str()), cmd.length());
+    // 命令字符串和结束符 0xFF 0xFF 0xFF 合并为一次聚集写，fd 后端只需一次系统调用
+    static const uint8_t endCmd[3] = {0xFF, 0xFF, 0xFF};
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<char*>(cmd.data());
+    iov[0].iov_len = cmd.length();
+    iov[1].iov_base = const_cast<uint8_t*>(endCmd);
+    iov[1].iov_len = sizeof(endCmd);
+    if (!writeFrame(iov, 2)) {
+        return;
+    }
 
-    // 使用非阻塞方式发送结束符 0xFF 0xFF 0xFF
-    uint8_t endCmd[3] = {0xFF, 0xFF, 0xFF};
-    sp_nonblocking_write(port, endCmd, 3);
+    // 减少调试输出，只在重要数据更新时显示（固定缓冲区比较，不分配内存）
+    if (cmd != std::string_view(last_cmd, last_cmd_length)) {
+        std::cout << "发送串口屏命令: " << cmd << std::endl;
+        last_cmd_length = cmd.length() < sizeof(last_cmd) ? cmd.length() : sizeof(last_cmd);
+        std::memcpy(last_cmd, cmd.data(), last_cmd_length);
+    }
+}
 
-    // 立即刷新串口缓冲区，确保数据立即发送
-    sp_drain(port);
+bool SerialScreenProtocol::writeFrame(const struct iovec* iov, int iovcnt) {
+    // 前面的字节还没写完时整帧排在后面，保证命令不会交错
+    size_t written = 0;
+    if (external_transmit) {
+        if (!transport->isOpen()) {
+            return false;
+        }
+    } else if (flushTxPending()) {
+        int n = transport->writev(iov, iovcnt);
+        if (n < 0) {
+            handleDisconnect("写入错误");
+            return false;
+        }
+        written = static_cast<size_t>(n);
+    } else if (!transport->isOpen()) {
+        return false;
+    }
 
-    // 减少调试输出，只在重要数据更新时显示
-    static std::string last_cmd = "";
-    if (cmd != last_cmd) {
-        std::cout << "发送串口屏命令: " << cmd << std::endl;
-        last_cmd = cmd;
+    // 非阻塞写：内核发送缓冲区满时只写出一部分，剩余部分等下次再写，不阻塞主循环
+    for (int i = 0; i < iovcnt; ++i) {
+        const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+        size_t length = iov[i].iov_len;
+        if (written >= length) {
+            written -= length;
+            continue;
+        }
+        tx_pending.insert(tx_pending.end(), data + written, data + length);
+        written = 0;
+    }
+    return true;
+}
+
+bool SerialScreenProtocol::flushTxPending() {
+    if (tx_pending_head == tx_pending.size()) {
+        return true;
+    }
+    if (external_transmit) {
+        return false; // 由写协程写出
+    }
+    int n = transport->write(tx_pending.data() + tx_pending_head, tx_pending.size() - tx_pending_head);
+    if (n < 0) {
+        handleDisconnect("写入错误");
+        return false;
+    }
+    tx_pending_head += static_cast<size_t>(n);
+    if (tx_pending_head < tx_pending.size()) {
+        return false;
+    }
+    tx_pending.clear();
+    tx_pending_head = 0;
+    return true;
+}
+
+size_t SerialScreenProtocol::takeTxPending(uint8_t* buffer, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    if (tx_pending_head == tx_pending.size()) {
+        pumpTx();
+    }
+    size_t n = std::min(getTxPendingBytes(), max_bytes);
+    std::memcpy(buffer, tx_pending.data() + tx_pending_head, n);
+    tx_pending_head += n;
+    if (tx_pending_head == tx_pending.size()) {
+        tx_pending.clear();
+        tx_pending_head = 0;
     }
+    return n;
+}
+
+void SerialScreenProtocol::setLinkBudget(double bytes_per_s) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    link_bytes_per_s = bytes_per_s;
+    applyTxBudget();
+}
+
+void SerialScreenProtocol::applyTxBudget() {
+    // 波形有自己的预算份额，数值命令使用剩余带宽
+    double budget = link_bytes_per_s - (waveform ? waveform->getConfig().budget_bytes_per_s : 0.0);
+    tx.setBudget(budget > 0.0 ? budget : link_bytes_per_s * 0.5);
+}
+
+void SerialScreenProtocol::queueFloat(ScreenTxScheduler::Priority priority, const char* name, float value) {
+    char cmd[50];
+    char floatStr[10];
+    snprintf(floatStr, sizeof(floatStr), "%.3f", value);
+    snprintf(cmd, sizeof(cmd), "%s=\"%s\"", name, floatStr);
+    tx.enqueue(priority, name, cmd);
+}
+
+void SerialScreenProtocol::pumpTx() {
+    // 透传期间屏幕把收到的字节都当作点数据，命令留在队列中等透传结束
+    if (waveform && waveform->busy()) {
+        return;
+    }
+    // 内核发送缓冲区写满时命令留在调度器中：排队期间同一控件的新值仍可覆盖旧值
+    std::string_view cmd;
+    while (transport->isOpen() && flushTxPending() && tx.next(cmd)) {
+        sendCmd(cmd);
+    }
+}
+
+void SerialScreenProtocol::reportTxStats() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_tx_report) {
+        return;
+    }
+    next_tx_report = now + std::chrono::seconds(TX_REPORT_INTERVAL_S);
+
+    ScreenTxScheduler::Window window = tx.takeWindow(now);
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < ScreenTxScheduler::PRIORITY_COUNT; ++i) {
+        bytes += window.classes[i].bytes;
+    }
+    if (bytes == 0 || window.seconds <= 0.0) {
+        return;
+    }
+    std::cout << "串口屏发送: " << std::fixed << std::setprecision(0) << bytes / window.seconds << " B/s (预算 "
+              << tx.getBudget() << " B/s)";
+    for (size_t i = 0; i < ScreenTxScheduler::PRIORITY_COUNT; ++i) {
+        const ScreenTxScheduler::ClassStats& cls = window.classes[i];
+        std::cout << " | " << ScreenTxScheduler::priorityName(static_cast<ScreenTxScheduler::Priority>(i))
+                  << ": 发送 " << cls.sent << " 覆盖 " << cls.superseded << " 丢弃 " << cls.dropped
+                  << std::setprecision(1) << " 排队延迟 平均 " << cls.averageDelayMs() << " ms 最大 "
+                  << cls.delay_max_ms << " ms" << std::setprecision(0);
+    }
+    std::cout << std::endl;
 }
 
 void SerialScreenProtocol::updateCurrentPower(float current, float power) {
@@ -146,30 +300,62 @@ void SerialScreenProtocol::updateMaxPower(float max_power) {
     data_updated = true;
 }
 
+void SerialScreenProtocol::updateDisplayedCurrentPower(float current, float power) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    current_I = current;
+    power_P = power;
+    data_updated = true;
+}
+
+void SerialScreenProtocol::updatePeakPower(float power) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    if (power > max_power) {
+        max_power = power;
+        std::cout << "*** 更新最大功率: " << std::fixed << std::setprecision(3) << max_power << " W ***" << std::endl;
+        data_updated = true;
+    }
+}
+
 void SerialScreenProtocol::sendDistanceAndSideLengthImmediately() {
     // 立即发送距离和边长数据，不使用互斥锁以避免死锁
     // 这个方法在parseFrame中被调用，parseFrame已经持有锁
-    sendFloat("t0.txt", distance_D);
-    sendFloat("t1.txt", side_length_x);
+    // 作为交互类命令入队，排在所有周期数据之前写出（波形透传期间等透传结束）
+    sendDistanceAndSideLength(ScreenTxScheduler::PRIORITY_INTERACTIVE);
+    pumpTx();
     std::cout << "*** 立即发送距离和边长数据完成 ***" << std::endl;
 }
 
 void SerialScreenProtocol::checkForSerialScreenData() {
     // 非阻塞检查串口屏数据
-    if (port) {
+    if (transport->isOpen() && !external_receive) {
         // 读取一个字节来判断是否有数据
         uint8_t first_byte;
-        size_t bytes_read = sp_nonblocking_read(port, &first_byte, 1);
+        int bytes_read = transport->readNonblocking(&first_byte, 1);
+        
+        if (bytes_read < 0) {
+            handleDisconnect("读取错误");
+            return;
+        }
+        if (bytes_read == 0) {
+            // 定期确认设备节点仍然存在（USB拔出后读操作可能不报错）
+            checkDevicePresent();
+            return;
+        }
         
-        if (bytes_read > 0 && first_byte == 0x65) {
+        if (first_byte == 0x65) {
             // 检测到串口屏协议帧头，读取完整帧
-            std::vector<uint8_t> frame_data;
+            std::vector<uint8_t>& frame_data = rx_frame;
+            frame_data.clear();
             frame_data.push_back(first_byte);
             
             // 读取剩余6字节
             uint8_t buffer[6];
-            bytes_read = sp_blocking_read(port, buffer, 6, 10); // 短超时
+            bytes_read = transport->read(buffer, 6, 10); // 短超时
             
+            if (bytes_read < 0) {
+                handleDisconnect("读取错误");
+                return;
+            }
             if (bytes_read == 6) {
                 // 添加剩余数据到frame_data
                 frame_data.insert(frame_data.end(), buffer, buffer + 6);
@@ -177,6 +363,37 @@ void SerialScreenProtocol::checkForSerialScreenData() {
                 // 解析数据帧
                 parseFrame(frame_data);
             }
+        } else if (isTransferResponse(first_byte)) {
+            // 透传应答 FE/FD FF FF FF
+            uint8_t tail[3];
+            bytes_read = transport->read(tail, 3, 10);
+            if (bytes_read < 0) {
+                handleDisconnect("读取错误");
+                return;
+            }
+            if (bytes_read == 3 && tail[0] == 0xFF && tail[1] == 0xFF && tail[2] == 0xFF) {
+                handleTransferResponse(first_byte);
+            }
+        }
+    }
+}
+
+void SerialScreenProtocol::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (rx_frame.empty() && data[i] != 0x65 && !isTransferResponse(data[i])) {
+            continue; // 等待帧头
+        }
+        rx_frame.push_back(data[i]);
+        if (rx_frame[0] != 0x65) {
+            if (rx_frame.size() == RESPONSE_SIZE) {
+                if (rx_frame[1] == 0xFF && rx_frame[2] == 0xFF && rx_frame[3] == 0xFF) {
+                    handleTransferResponse(rx_frame[0]);
+                }
+                rx_frame.clear();
+            }
+        } else if (rx_frame.size() == getFrameSize()) {
+            parseFrame(rx_frame);
+            rx_frame.clear();
         }
     }
 }
@@ -185,17 +402,77 @@ void SerialScreenProtocol::sendPeriodicData() {
     // 定期发送数据到串口屏
     std::lock_guard<std::mutex> lock(data_mutex);
     
-    // 发送电流和功率数据
-    sendCurrentAndPower();
+    // 先写出上次没写完的字节（透传期间可能是点数据）
+    flushTxPending();
     
-    // 发送最大功率
-    sendMaxPower();
+    // 透传期间屏幕把收到的字节都当作点数据，其他命令推迟到下一次发送
+    if (waveform && waveform->busy() && !waveform->checkTimeout()) {
+        return;
+    }
+    
+    if (refresh_requested) {
+        refresh_requested = false;
+        sendAllData();
+    } else {
+        // 电流、功率和最大功率作为周期类命令入队，预算不足时只保留每个控件的最新值
+        sendCurrentAndPower();
+        sendMaxPower();
+    }
+    pumpTx();
     
-    // 如果收到start按键，发送距离和边长
-    if (start_received) {
-        sendDistanceAndSideLength();
-        start_received = false;
+    // 数值控件发送完毕后，在预算内发送一批波形点
+    serviceWaveform();
+    reportTxStats();
+}
+
+void SerialScreenProtocol::enableWaveform(const WaveformConfig& config) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    waveform = std::make_unique<WaveformStream>(config);
+    // 一批点数据也可能只写出一部分
+    tx_pending.reserve(tx_pending.capacity() + waveform->getConfig().batch_points);
+    applyTxBudget();
+}
+
+void SerialScreenProtocol::pushWaveformSamples(const float* power, size_t count) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    if (!waveform) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        waveform->push(power[i]);
+    }
+}
+
+void SerialScreenProtocol::serviceWaveform() {
+    if (!waveform || !transport->isOpen() || getTxPendingBytes() > 0 || !waveform->readyToSend()) {
+        return;
+    }
+    char cmd[32];
+    if (waveform->beginTransfer(cmd, sizeof(cmd)) > 0) {
+        sendCmd(cmd);
+    }
+}
+
+void SerialScreenProtocol::handleTransferResponse(uint8_t code) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    if (!waveform || !waveform->busy()) {
+        return;
+    }
+    if (code == 0xFD) {
+        waveform->onDone();
+        pumpTx(); // 透传期间到达的交互类命令立即发出
+        return;
+    }
+
+    // 屏幕已进入透传状态：发送原始点数据（不带结束符）
+    const std::vector<uint8_t>& points = waveform->onReady();
+    if (points.empty() || !transport->isOpen()) {
+        return;
     }
+    struct iovec iov;
+    iov.iov_base = const_cast<uint8_t*>(points.data());
+    iov.iov_len = points.size();
+    writeFrame(&iov, 1);
 }
 
 void SerialScreenProtocol::setStartButtonCallback(std::function<void()> callback) {
@@ -204,7 +481,8 @@ void SerialScreenProtocol::setStartButtonCallback(std::function<void()> callback
 
 void SerialScreenProtocol::notifyStartButtonPressed() {
     std::lock_guard<std::mutex> lock(data_mutex);
-    start_received = true;
+    // 下一次定期发送时排在周期数据之前写出
+    sendDistanceAndSideLength(ScreenTxScheduler::PRIORITY_INTERACTIVE);
     std::cout << "*** 收到start按键通知，将发送距离和边长数据 ***" << std::endl;
 }
 
@@ -229,6 +507,11 @@ void SerialScreenProtocol::clearAllEventCallbacks() {
     std::cout << "清除所有事件回调" << std::endl;
 }
 
+void SerialScreenProtocol::setEventObserver(std::function<void(uint8_t, uint8_t, uint8_t, SerialScreenEvent)> observer) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    eventObserver = observer;
+}
+
 void SerialScreenProtocol::triggerEventCallback(SerialScreenEvent event) {
     std::lock_guard<std::mutex> lock(data_mutex);
     auto it = eventCallbacks.find(event);
@@ -282,30 +565,30 @@ SerialScreenEvent SerialScreenProtocol::parseEvent(uint8_t page, uint8_t control
     return SerialScreenEvent::UNKNOWN_EVENT;
 }
 
-void SerialScreenProtocol::sendDistanceAndSideLength() {
+void SerialScreenProtocol::sendDistanceAndSideLength(ScreenTxScheduler::Priority priority) {
     // 发送距离D (只有收到start才发送)
-    sendFloat("t0.txt", distance_D);
+    queueFloat(priority, "t0.txt", distance_D);
     
     // 发送边长x (只有收到start才发送)
-    sendFloat("t1.txt", side_length_x);
+    queueFloat(priority, "t1.txt", side_length_x);
 }
 
 void SerialScreenProtocol::sendCurrentAndPower() {
     // 发送电流I (只要收到就发送)
-    sendFloat("t2.txt", current_I);
+    queueFloat(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", current_I);
     
     // 发送功率P (只要收到就发送)
-    sendFloat("t3.txt", power_P);
+    queueFloat(ScreenTxScheduler::PRIORITY_PERIODIC, "t3.txt", power_P);
 }
 
 void SerialScreenProtocol::sendMaxPower() {
     // 发送最大功率 (持续发送)
-    sendFloat("t4.txt", max_power);
+    queueFloat(ScreenTxScheduler::PRIORITY_PERIODIC, "t4.txt", max_power);
 }
 
 void SerialScreenProtocol::sendAllData() {
-    // 这个方法保留用于兼容性，但主要使用上面的分离方法
-    sendDistanceAndSideLength();
+    // 重连或刷新时恢复全部显示：距离和边长按交互类优先发送，其余按预算发送
+    sendDistanceAndSideLength(ScreenTxScheduler::PRIORITY_INTERACTIVE);
     sendCurrentAndPower();
     sendMaxPower();
 }
@@ -315,6 +598,10 @@ bool SerialScreenProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
     if (!isValidFrame(frame_data)) {
         return false;
     }
+    if (frame_data.size() == RESPONSE_SIZE) {
+        handleTransferResponse(frame_data[0]);
+        return true;
+    }
 
     // 根据通信.csv协议格式解析
     uint8_t page = frame_data[1];      // 页面
@@ -334,7 +621,7 @@ bool SerialScreenProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
     SerialScreenEvent screenEvent = parseEvent(page, control, event);
     
     // 根据事件类型获取功能名称（用于显示）
-    std::string function_name = "未知功能";
+    const char* function_name = "未知功能";
     bool is_start_button = false;
     
     switch (screenEvent) {
@@ -374,16 +661,20 @@ bool SerialScreenProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
     
     std::cout << "功能: " << function_name << std::endl;
     
+    // 通知事件观察者
+    if (eventObserver) {
+        eventObserver(page, control, event, screenEvent);
+    }
+    
     // 触发通用事件回调
     triggerEventCallback(screenEvent);
     
     // 如果是start按键，设置标志并调用旧的回调（保持向后兼容）
     if (is_start_button) {
         std::lock_guard<std::mutex> lock(data_mutex);
-        start_received = true;
         std::cout << "*** 检测到start按键，将发送距离和边长数据 ***" << std::endl;
         
-        // 立即发送距离和边长数据，不等待轮询
+        // 立即发送距离和边长数据，不等待轮询（波形透传期间留在队列中，透传结束后优先发出）
         sendDistanceAndSideLengthImmediately();
         
         // 调用旧的回调函数通知其他实例（保持向后兼容）
@@ -405,6 +696,12 @@ bool SerialScreenProtocol::parseFrame(const std::vector<uint8_t>& frame_data) {
 }
 
 bool SerialScreenProtocol::isValidFrame(const std::vector<uint8_t>& frame_data) {
+    // 透传应答 FE/FD FF FF FF
+    if (frame_data.size() == RESPONSE_SIZE) {
+        return isTransferResponse(frame_data[0]) && frame_data[1] == 0xFF && frame_data[2] == 0xFF &&
+               frame_data[3] == 0xFF;
+    }
+
     // 根据通信.csv协议格式验证
     if (frame_data.size() != 7) {  // 帧头(1) + 页面(1) + 控件(1) + 事件(1) + 帧尾(3)
         return false;
@@ -431,13 +728,21 @@ std::string SerialScreenProtocol::getProtocolName() const {
     return "串口屏协议";
 }
 
-bool SerialScreenProtocol::findFrameHeader(struct sp_port* port) {
+std::vector<FrameFormat> SerialScreenProtocol::getFrameFormats() const {
+    return {
+        FrameFormat{{0x65}, {0xFF, 0xFF, 0xFF}, 7},             // 按键事件
+        FrameFormat{{0xFE}, {0xFF, 0xFF, 0xFF}, RESPONSE_SIZE}, // 透传就绪
+        FrameFormat{{0xFD}, {0xFF, 0xFF, 0xFF}, RESPONSE_SIZE}, // 透传完成
+    };
+}
+
+bool SerialScreenProtocol::findFrameHeader(Transport& transport) {
     uint8_t buffer[1];
-    size_t bytes_read;
+    int bytes_read;
     
     do {
-        bytes_read = sp_blocking_read(port, buffer, 1, 10); // 减少超时时间到10ms
-        if (bytes_read == 0) {
+        bytes_read = transport.read(buffer, 1, 10); // 减少超时时间到10ms
+        if (bytes_read <= 0) {
             return false;
         }
     } while (buffer[0] != 0x65);
@@ -0,0 +1,5 @@
+#include "shared_port_transport.h"
+
+bool SharedPortTransport::open() {
+    return target.isOpen() || target.open();
+}
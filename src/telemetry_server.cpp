@@ -0,0 +1,322 @@
+#include "telemetry_server.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+void putU64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+} // namespace
+
+TelemetryServer::TelemetryServer(const TelemetryServerConfig& config)
+    : config(config), unix_fd(-1), tcp_fd(-1), unix_bound(false), active_clients(0) {
+    if (this->config.queue_capacity == 0) {
+        this->config.queue_capacity = 1;
+    }
+    if (this->config.max_batch == 0 || this->config.max_batch > 0xFFFF) {
+        this->config.max_batch = 256;
+    }
+
+    clients.resize(this->config.max_clients);
+    for (auto& client : clients) {
+        client.queue.resize(this->config.queue_capacity);
+        client.out.reserve(TELEMETRY_FRAME_HEADER_SIZE + this->config.max_batch * TELEMETRY_RECORD_SIZE);
+    }
+}
+
+TelemetryServer::~TelemetryServer() {
+    stop();
+}
+
+uint64_t TelemetryServer::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool TelemetryServer::start() {
+    if (!config.unix_path.empty()) {
+        unix_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (unix_fd < 0) {
+            std::cerr << "无法创建遥测Unix套接字: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (config.unix_path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "遥测Unix套接字路径过长: " << config.unix_path << std::endl;
+            stop();
+            return false;
+        }
+        std::strncpy(addr.sun_path, config.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        // 只清理上次残留的套接字文件；路径上是其他类型的文件时不删除，由 bind 报错
+        struct stat st;
+        if (::lstat(config.unix_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            ::unlink(config.unix_path.c_str());
+        }
+
+        if (bind(unix_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "无法绑定遥测Unix套接字: " << config.unix_path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            stop();
+            return false;
+        }
+        unix_bound = true;
+        if (listen(unix_fd, 8) != 0 || !setNonBlocking(unix_fd)) {
+            std::cerr << "无法监听遥测Unix套接字: " << config.unix_path
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            stop();
+            return false;
+        }
+        std::cout << "遥测服务已监听Unix套接字: " << config.unix_path << std::endl;
+    }
+
+    if (config.tcp_port > 0) {
+        tcp_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (tcp_fd < 0) {
+            std::cerr << "无法创建遥测TCP套接字: " << std::strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(tcp_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        // 只监听回环地址，不对外暴露
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(config.tcp_port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(tcp_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(tcp_fd, 8) != 0 || !setNonBlocking(tcp_fd)) {
+            std::cerr << "无法监听遥测TCP端口: 127.0.0.1:" << config.tcp_port
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            stop();
+            return false;
+        }
+        std::cout << "遥测服务已监听TCP端口: 127.0.0.1:" << config.tcp_port << std::endl;
+    }
+
+    return isRunning();
+}
+
+void TelemetryServer::stop() {
+    for (auto& client : clients) {
+        if (client.fd >= 0) {
+            closeClient(client);
+        }
+    }
+    if (unix_fd >= 0) {
+        ::close(unix_fd);
+        unix_fd = -1;
+    }
+    if (unix_bound) {
+        ::unlink(config.unix_path.c_str());
+        unix_bound = false;
+    }
+    if (tcp_fd >= 0) {
+        ::close(tcp_fd);
+        tcp_fd = -1;
+    }
+}
+
+void TelemetryServer::publishSample(float current, float power) {
+    if (active_clients == 0) {
+        return;
+    }
+    Record record{};
+    record.type = TELEMETRY_SAMPLE;
+    record.timestamp_ns = nowNs();
+    std::memcpy(record.data, &current, sizeof(float));
+    std::memcpy(record.data + 4, &power, sizeof(float));
+    enqueue(record);
+}
+
+void TelemetryServer::publishScreenEvent(uint8_t page, uint8_t control, uint8_t event, int event_id) {
+    if (active_clients == 0) {
+        return;
+    }
+    Record record{};
+    record.type = TELEMETRY_SCREEN_EVENT;
+    record.a = page;
+    record.b = control;
+    record.c = event;
+    record.timestamp_ns = nowNs();
+    int32_t id = static_cast<int32_t>(event_id);
+    std::memcpy(record.data, &id, sizeof(id));
+    enqueue(record);
+}
+
+void TelemetryServer::enqueue(const Record& record) {
+    ++stats.published;
+    for (auto& client : clients) {
+        if (client.fd < 0) {
+            continue;
+        }
+        size_t capacity = client.queue.size();
+        if (client.count == capacity) {
+            // 队列已满：丢弃最旧的记录，保证最新数据可见（对慢速订阅者等效于降采样）
+            client.head = (client.head + 1) % capacity;
+            --client.count;
+            ++client.dropped;
+            ++stats.dropped;
+        }
+        client.queue[(client.head + client.count) % capacity] = record;
+        ++client.count;
+    }
+}
+
+void TelemetryServer::poll() {
+    if (unix_fd >= 0) {
+        acceptClients(unix_fd);
+    }
+    if (tcp_fd >= 0) {
+        acceptClients(tcp_fd);
+    }
+
+    uint64_t now = nowNs();
+    for (auto& client : clients) {
+        if (client.fd >= 0 && !flushClient(client, now)) {
+            closeClient(client);
+        }
+    }
+}
+
+void TelemetryServer::acceptClients(int listen_fd) {
+    while (true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            return; // EAGAIN 或错误，下一轮再试
+        }
+
+        Client* slot = nullptr;
+        for (auto& client : clients) {
+            if (client.fd < 0) {
+                slot = &client;
+                break;
+            }
+        }
+        if (!slot || !setNonBlocking(fd)) {
+            ::close(fd); // 没有空闲槽位
+            continue;
+        }
+        if (listen_fd == tcp_fd) {
+            int nodelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        }
+
+        slot->fd = fd;
+        slot->head = 0;
+        slot->count = 0;
+        slot->out.clear();
+        slot->out_offset = 0;
+        slot->dropped = 0;
+        slot->last_progress_ns = nowNs();
+        ++active_clients;
+        stats.clients = active_clients;
+        std::cout << "遥测订阅者已连接, 当前数量: " << active_clients << std::endl;
+    }
+}
+
+void TelemetryServer::buildBatch(Client& client) {
+    size_t n = client.count < config.max_batch ? client.count : config.max_batch;
+    size_t payload = 2 + n * TELEMETRY_RECORD_SIZE;
+
+    client.out.resize(4 + payload);
+    client.out_offset = 0;
+    uint8_t* p = client.out.data();
+    putU32(p, static_cast<uint32_t>(payload));
+    putU16(p + 4, static_cast<uint16_t>(n));
+    p += TELEMETRY_FRAME_HEADER_SIZE;
+
+    size_t capacity = client.queue.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Record& r = client.queue[(client.head + i) % capacity];
+        p[0] = r.type;
+        p[1] = r.a;
+        p[2] = r.b;
+        p[3] = r.c;
+        putU64(p + 4, r.timestamp_ns);
+        std::memcpy(p + 12, r.data, sizeof(r.data));
+        p += TELEMETRY_RECORD_SIZE;
+    }
+    client.head = (client.head + n) % capacity;
+    client.count -= n;
+}
+
+bool TelemetryServer::flushClient(Client& client, uint64_t now_ns) {
+    while (true) {
+        if (client.out_offset >= client.out.size()) {
+            client.out.clear();
+            client.out_offset = 0;
+            if (client.count == 0) {
+                client.last_progress_ns = now_ns;
+                return true; // 全部发送完毕
+            }
+            buildBatch(client);
+        }
+
+        ssize_t n = send(client.fd, client.out.data() + client.out_offset,
+                         client.out.size() - client.out_offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            client.out_offset += static_cast<size_t>(n);
+            client.last_progress_ns = now_ns;
+            if (client.out_offset >= client.out.size()) {
+                ++stats.frames_sent;
+            }
+            stats.bytes_sent += static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            // 套接字缓冲区已满，检查订阅者是否卡死
+            uint64_t stalled_ms = (now_ns - client.last_progress_ns) / 1000000ULL;
+            if (stalled_ms > static_cast<uint64_t>(config.stall_timeout_ms)) {
+                std::cout << "遥测订阅者过慢(" << stalled_ms << "ms无进展, 已丢弃"
+                          << client.dropped << "条记录)，断开连接" << std::endl;
+                ++stats.clients_dropped;
+                return false;
+            }
+            return true;
+        }
+        return false; // 对端关闭或出错
+    }
+}
+
+void TelemetryServer::closeClient(Client& client) {
+    ::close(client.fd);
+    client.fd = -1;
+    --active_clients;
+    stats.clients = active_clients;
+    std::cout << "遥测订阅者已断开, 当前数量: " << active_clients << std::endl;
+}
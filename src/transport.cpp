@@ -0,0 +1,56 @@
+#include "transport.h"
+#include "libserialport_transport.h"
+#include "fd_transport.h"
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+int Transport::writev(const struct iovec* iov, int iovcnt) {
+    int total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+        int n = write(data, iov[i].iov_len);
+        if (n < 0) {
+            return -1;
+        }
+        total += n;
+        if (static_cast<size_t>(n) < iov[i].iov_len) {
+            break; // 发送缓冲区已满，与 writev 一样返回部分写入
+        }
+    }
+    return total;
+}
+
+long Transport::overrunCount() const {
+    int fd = getFileDescriptor();
+    if (fd < 0) {
+        return -1;
+    }
+    // 伪终端等不支持该请求的设备返回错误
+    struct serial_icounter_struct counters;
+    if (::ioctl(fd, TIOCGICOUNT, &counters) != 0) {
+        return -1;
+    }
+    return static_cast<long>(counters.overrun) + static_cast<long>(counters.buf_overrun);
+}
+
+std::unique_ptr<Transport> createTransport(TransportType type, const std::string& name,
+                                           const SerialSettings& settings) {
+    switch (type) {
+        case TransportType::TERMIOS:
+            return std::make_unique<TermiosTransport>(name, settings);
+        case TransportType::LIBSERIALPORT:
+        default:
+            return std::make_unique<LibSerialPortTransport>(name, settings);
+    }
+}
+
+bool parseTransportType(const std::string& name, TransportType& type) {
+    if (name == "libserialport" || name == "sp") {
+        type = TransportType::LIBSERIALPORT;
+    } else if (name == "termios" || name == "fd") {
+        type = TransportType::TERMIOS;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,244 @@
+#include "uart_capi.h"
+#include "uart_reader.h"
+#include "current_power_protocol.h"
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <time.h>
+
+namespace {
+thread_local char last_error[256] = "";
+
+void setError(const char* message, const char* detail = nullptr) {
+    if (detail) {
+        std::snprintf(last_error, sizeof(last_error), "%s: %s", message, detail);
+    } else {
+        std::snprintf(last_error, sizeof(last_error), "%s", message);
+    }
+}
+
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// 断线时两次重连检查之间的休眠
+const auto DISCONNECTED_POLL = std::chrono::milliseconds(10);
+// 带超时读取时每次阻塞等待的上限（与 UartReader 默认空闲超时相同）
+const long MAX_IDLE_WAIT_MS = 100;
+}
+
+// 句柄：读取器、协议和未取走样本的环形队列（打开时分配，读取过程不分配内存）
+struct uart_handle {
+    std::unique_ptr<UartReader> reader;
+    CurrentPowerProtocol* protocol = nullptr;
+    std::vector<uart_sample> queue;
+    size_t queue_head = 0;
+    size_t queue_count = 0;
+    uint64_t samples_dropped = 0;
+
+    void push(float current, float power) {
+        if (queue_count == queue.size()) {
+            // 队列满：丢弃最旧的样本
+            queue_head = (queue_head + 1) % queue.size();
+            --queue_count;
+            ++samples_dropped;
+        }
+        uart_sample& sample = queue[(queue_head + queue_count) % queue.size()];
+        sample.timestamp_ns = monotonicNs();
+        sample.current = current;
+        sample.power = power;
+        sample.flags = 0;
+        sample.sequence = 0;
+        if (protocol->isExtendedActive()) {
+            sample.sequence = protocol->getSequenceTracker().getStats().last_sequence;
+            sample.flags |= UART_SAMPLE_HAS_SEQUENCE;
+        }
+        ++queue_count;
+    }
+
+    size_t pop(uart_sample* out, size_t max) {
+        size_t n = queue_count < max ? queue_count : max;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = queue[queue_head];
+            queue_head = (queue_head + 1) % queue.size();
+        }
+        queue_count -= n;
+        return n;
+    }
+};
+
+extern "C" {
+
+int uart_abi_version(void) {
+    return UART_ABI_VERSION;
+}
+
+void uart_config_init(uart_config* config) {
+    if (!config) {
+        return;
+    }
+    std::memset(config, 0, sizeof(*config));
+    config->struct_size = sizeof(uart_config);
+    config->port = nullptr;
+    config->baud_rate = 9600;
+    config->transport = UART_TRANSPORT_LIBSERIALPORT;
+    config->sequence_mode = UART_SEQ_AUTO;
+    config->tick_hz = 1000.0;
+    config->queue_capacity = 4096;
+}
+
+uart_handle* uart_open(const uart_config* user_config) {
+    if (!user_config || user_config->struct_size < offsetof(uart_config, port) + sizeof(user_config->port)) {
+        setError("配置无效");
+        return nullptr;
+    }
+    // 旧版本调用方的结构体较短：只覆盖它提供的字段，其余取默认值
+    uart_config config;
+    uart_config_init(&config);
+    size_t size = user_config->struct_size < sizeof(config) ? user_config->struct_size : sizeof(config);
+    std::memcpy(&config, user_config, size);
+    config.struct_size = sizeof(config);
+
+    if (!config.port || !*config.port) {
+        setError("未指定串口");
+        return nullptr;
+    }
+    TransportType transport_type;
+    switch (config.transport) {
+        case UART_TRANSPORT_LIBSERIALPORT: transport_type = TransportType::LIBSERIALPORT; break;
+        case UART_TRANSPORT_TERMIOS: transport_type = TransportType::TERMIOS; break;
+        default:
+            setError("未知的传输层");
+            return nullptr;
+    }
+    SequenceMode sequence_mode;
+    switch (config.sequence_mode) {
+        case UART_SEQ_LEGACY: sequence_mode = SequenceMode::LEGACY; break;
+        case UART_SEQ_EXTENDED: sequence_mode = SequenceMode::EXTENDED; break;
+        case UART_SEQ_AUTO: sequence_mode = SequenceMode::AUTO; break;
+        default:
+            setError("未知的帧序号解码方式");
+            return nullptr;
+    }
+
+    // C 接口不能让异常穿过边界：只有内存分配可能失败
+    try {
+        std::unique_ptr<uart_handle> handle(new uart_handle());
+        handle->queue.resize(config.queue_capacity > 0 ? config.queue_capacity : 4096);
+
+        auto protocol = std::make_unique<CurrentPowerProtocol>();
+        protocol->setVerbose(false);
+        protocol->setSequenceMode(sequence_mode, config.tick_hz > 0.0 ? config.tick_hz : 1000.0);
+        uart_handle* raw = handle.get();
+        protocol->setCurrentPowerCallback([raw](float current, float power) { raw->push(current, power); });
+        handle->protocol = protocol.get();
+
+        SerialSettings settings;
+        settings.baud_rate = config.baud_rate > 0 ? config.baud_rate : 9600;
+        settings.read_write = false;
+        handle->reader = std::make_unique<UartReader>(createTransport(transport_type, config.port, settings));
+        handle->reader->setVerbose(false);
+        handle->reader->addProtocol(std::move(protocol));
+
+        if (!handle->reader->open()) {
+            setError("无法打开串口", config.port);
+            return nullptr;
+        }
+        return handle.release();
+    } catch (const std::exception& e) {
+        setError("打开失败", e.what());
+        return nullptr;
+    }
+}
+
+int uart_read_samples(uart_handle* handle, uart_sample* samples, size_t max, int timeout_ms) {
+    if (!handle || (!samples && max > 0)) {
+        setError("参数无效");
+        return UART_ERR_INVALID;
+    }
+    // 返回值是 int：一次最多取回 INT_MAX 个样本
+    if (max > static_cast<size_t>(INT_MAX)) {
+        max = static_cast<size_t>(INT_MAX);
+    }
+
+    UartReader& reader = *handle->reader;
+    reader.maintainConnection();
+    if (timeout_ms == 0) {
+        // 只处理调用时已到达的字节：数据持续到达时也不会一直读下去
+        int waiting = reader.isConnected() ? reader.getTransport().inputWaiting() : 0;
+        size_t budget = waiting > 0 ? static_cast<size_t>(waiting) : 0;
+        while (budget > 0 && handle->queue_count < max) {
+            int n = reader.readPending(budget);
+            if (n <= 0) {
+                break;
+            }
+            budget -= static_cast<size_t>(n) < budget ? static_cast<size_t>(n) : budget;
+        }
+    } else {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0);
+        while (handle->queue_count < max) {
+            auto now = std::chrono::steady_clock::now();
+            long remaining_ms = static_cast<long>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+            if (timeout_ms > 0 && now >= deadline) {
+                break;
+            }
+
+            if (!reader.isConnected()) {
+                // 按退避时间后台重连
+                auto wait = std::chrono::milliseconds(remaining_ms);
+                std::this_thread::sleep_for(timeout_ms > 0 && wait < DISCONNECTED_POLL ? wait : DISCONNECTED_POLL);
+                reader.maintainConnection();
+                continue;
+            }
+
+            // 空闲等待不超过剩余时间；只作用于本次读取，不改变读取器的空闲超时设置
+            long wait_ms = MAX_IDLE_WAIT_MS;
+            if (timeout_ms > 0 && remaining_ms < wait_ms) {
+                wait_ms = remaining_ms > 0 ? remaining_ms : 1;
+            }
+            reader.readAndParseFrame(static_cast<unsigned int>(wait_ms));
+        }
+    }
+
+    size_t n = handle->pop(samples, max);
+    if (n == 0 && max > 0 && !reader.isConnected()) {
+        setError("串口已断开", reader.getPortName().c_str());
+        return UART_ERR_DISCONNECTED;
+    }
+    return static_cast<int>(n);
+}
+
+int uart_get_stats(uart_handle* handle, uart_stats* stats) {
+    if (!handle || !stats) {
+        setError("参数无效");
+        return UART_ERR_INVALID;
+    }
+    const UartReader::ReadStats& read_stats = handle->reader->getReadStats();
+    std::memset(stats, 0, sizeof(*stats));
+    stats->frames = read_stats.frames;
+    stats->samples_dropped = handle->samples_dropped;
+    stats->lost_frames = handle->protocol->getSequenceTracker().getStats().lost;
+    stats->bytes = read_stats.bytes;
+    stats->reconnects = handle->reader->getReconnectStats().reconnects;
+    stats->overruns = read_stats.overruns;
+    stats->connected = handle->reader->isConnected() ? 1 : 0;
+    return UART_OK;
+}
+
+void uart_close(uart_handle* handle) {
+    delete handle;
+}
+
+const char* uart_last_error(void) {
+    return last_error;
+}
+
+} // extern "C"
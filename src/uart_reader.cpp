@@ -1,160 +1,273 @@
 #include "uart_reader.h"
-#include "current_power_protocol.h"
-#include "serial_screen_protocol.h"
 #include <iostream>
 #include <iomanip>
 
-UartReader::UartReader(const std::string& port_name, int baud_rate) 
-    : port_name(port_name), baud_rate(baud_rate), port(nullptr) {}
+UartReader::UartReader(const std::string& port_name, int baud_rate, TransportType transport_type)
+    : port_name(port_name) {
+    SerialSettings settings;
+    settings.baud_rate = baud_rate;
+    settings.read_write = false;
+    transport = createTransport(transport_type, port_name, settings);
+    initReadPath();
+}
+
+UartReader::UartReader(std::unique_ptr<Transport> transport)
+    : port_name(transport->getName()), transport(std::move(transport)) {
+    initReadPath();
+}
+
+void UartReader::initReadPath() {
+    rx_buffer.resize(RX_BUFFER_SIZE);
+    min_frame_size = 2;
+    backlog_alarm_bytes = RX_BUFFER_SIZE / 2;
+    backlog_alarmed = false;
+    idle_read_timeout_ms = IDLE_READ_TIMEOUT_MS;
+    verbose = true;
+    next_overrun_check = std::chrono::steady_clock::now();
+    next_report = next_overrun_check + std::chrono::seconds(READ_REPORT_INTERVAL_S);
+}
 
 UartReader::~UartReader() {
-    if (port) {
-        sp_close(port);
-        sp_free_port(port);
-    }
+    closePort();
+}
+
+void UartReader::closePort() {
+    transport->close();
 }
 
 void UartReader::addProtocol(std::unique_ptr<Protocol> protocol) {
     protocols.push_back(std::move(protocol));
+    attachProtocol(*protocols.back());
+}
+
+void UartReader::attachProtocol(Protocol& protocol) {
+    demux.addProtocol(protocol);
+    size_t frame_size = demux.getMinFrameSize();
+    min_frame_size = frame_size > 1 ? frame_size : 2;
 }
 
 bool UartReader::open() {
-    int result = sp_get_port_by_name(port_name.c_str(), &port);
-    if (result != SP_OK) {
-        std::cerr << "无法打开串口: " << port_name << std::endl;
+    if (!openPort()) {
+        closePort();
+        reconnect.markDisconnected();
         return false;
     }
 
-    result = sp_open(port, SP_MODE_READ);
-    if (result != SP_OK) {
-        std::cerr << "无法打开串口进行读取" << std::endl;
-        return false;
+    // 丢弃断线前残留在缓冲区中的半帧数据，并重置各协议的解码状态
+    transport->flushInput();
+    for (auto& protocol : protocols) {
+        protocol->reset();
     }
+    demux.reset();
 
-    // 设置完整的串口参数，与系统配置保持一致
-    result = sp_set_baudrate(port, baud_rate);
-    if (result != SP_OK) {
-        std::cerr << "无法设置波特率: " << baud_rate << std::endl;
-        return false;
+    if (reconnect.markConnected()) {
+        const auto& stats = reconnect.getStats();
+        std::cout << "串口已恢复: " << port_name << " 恢复耗时: " << std::fixed << std::setprecision(1)
+                  << stats.last_recovery_ms << " ms (累计重连 " << stats.reconnects << " 次)" << std::endl;
     }
+    return true;
+}
 
-    // 设置数据位为8位
-    result = sp_set_bits(port, 8);
-    if (result != SP_OK) {
-        std::cerr << "无法设置数据位" << std::endl;
-        return false;
+void UartReader::handleDisconnect(const char* reason) {
+    std::cerr << "串口断开: " << port_name << " (" << reason << ")，将在后台重连" << std::endl;
+    closePort();
+    reconnect.markDisconnected();
+    if (disconnect_callback) {
+        disconnect_callback(reason);
     }
+}
 
-    // 设置停止位为1位
-    result = sp_set_stopbits(port, 1);
-    if (result != SP_OK) {
-        std::cerr << "无法设置停止位" << std::endl;
-        return false;
+void UartReader::checkDevicePresent() {
+    // 没有设备节点的传输层（内存）不做检查
+    if (transport->getFileDescriptor() >= 0 && reconnect.shouldCheckPresence() &&
+        !ReconnectPolicy::devicePresent(port_name)) {
+        handleDisconnect("设备节点消失");
     }
+}
 
-    // 设置无校验位
-    result = sp_set_parity(port, SP_PARITY_NONE);
-    if (result != SP_OK) {
-        std::cerr << "无法设置校验位" << std::endl;
-        return false;
+void UartReader::maintainConnection() {
+    if (reconnect.isConnected()) {
+        return;
     }
-
-    // 设置无流控制
-    result = sp_set_flowcontrol(port, SP_FLOWCONTROL_NONE);
-    if (result != SP_OK) {
-        std::cerr << "无法设置流控制" << std::endl;
-        return false;
+    if (reconnect.shouldAttempt() && !open()) {
+        reconnect.attemptFailed();
     }
+}
 
-    std::cout << "成功打开串口: " << port_name << " 波特率: " << baud_rate 
-              << " 数据位: 8 停止位: 1 校验位: 无 流控制: 无" << std::endl;
-    return true;
+bool UartReader::openPort() {
+    return transport->open();
 }
 
 bool UartReader::readAndParseFrame() {
-    // 读取一个字节来判断协议类型
-    uint8_t first_byte;
-    size_t bytes_read = sp_blocking_read(port, &first_byte, 1, 100); // 优化超时时间到100ms
-    
-    if (bytes_read == 0) {
-        return false; // 没有数据
-    }
-    
-    // 根据第一个字节判断协议类型
-    if (first_byte == 0xAA) {
-        // 可能是电流功率协议，需要读取第二个字节确认
-        uint8_t second_byte;
-        bytes_read = sp_blocking_read(port, &second_byte, 1, 100); // 优化超时时间
-        if (bytes_read == 0 || second_byte != 0xAA) {
+    return readAndParseFrame(idle_read_timeout_ms);
+}
+
+bool UartReader::readAndParseFrame(unsigned int idle_timeout_ms) {
+    if (!transport->isOpen()) {
+        return false; // 断线中，等待重连
+    }
+    checkOverruns();
+
+    int waiting = transport->inputWaiting();
+    if (waiting < 0) {
+        handleDisconnect("读取错误");
+        return false;
+    }
+
+    uint8_t* buffer = rx_buffer.data();
+    size_t capacity = rx_buffer.size();
+    int bytes_read;
+    if (waiting == 0) {
+        // 空闲：阻塞等待第一个字节
+        bytes_read = transport->read(buffer, 1, idle_timeout_ms > 0 ? idle_timeout_ms : 1);
+        if (bytes_read < 0) {
+            handleDisconnect("读取错误");
+            return false;
+        }
+        if (bytes_read == 0) {
+            recordBacklog(0);
+            // 线路空闲：裁决还在等待字节的候选帧
+            size_t frames = demux.flush();
+            read_stats.frames += frames;
+            // 没有数据：定期确认设备节点仍然存在（USB拔出后读操作可能只是超时）
+            checkDevicePresent();
+            return frames > 0;
+        }
+
+        // 帧的其余部分通常还在线路上：积压不足一帧时按帧大小等待，避免逐字节读取
+        waiting = transport->inputWaiting();
+        size_t rest = min_frame_size - 1;
+        int more;
+        if (waiting >= 0 && static_cast<size_t>(waiting) < rest) {
+            more = transport->read(buffer + 1, rest, FRAME_READ_TIMEOUT_MS);
+        } else {
+            size_t want = waiting > 0 ? static_cast<size_t>(waiting) : rest;
+            more = transport->readNonblocking(buffer + 1, want < capacity - 1 ? want : capacity - 1);
+        }
+        if (more < 0) {
+            handleDisconnect("读取错误");
+            return false;
+        }
+        bytes_read += more;
+        recordBacklog(waiting > 0 ? static_cast<size_t>(waiting) + 1 : 1);
+    } else {
+        // 已有积压：一次读完（最多一个缓冲区）
+        size_t want = static_cast<size_t>(waiting) < capacity ? static_cast<size_t>(waiting) : capacity;
+        bytes_read = transport->readNonblocking(buffer, want);
+        if (bytes_read < 0) {
+            handleDisconnect("读取错误");
             return false;
         }
-        
-        // 确认是电流功率协议，读取剩余数据
-        return tryReadCurrentPowerFrame(first_byte, second_byte);
-        
-    } else if (first_byte == 0x65) {
-        // 串口屏协议，读取剩余数据
-        return tryReadSerialScreenFrame(first_byte);
+        recordBacklog(static_cast<size_t>(waiting));
     }
-    
-    return false; // 未知协议
+    return decodeRead(static_cast<size_t>(bytes_read)) > 0;
 }
 
-bool UartReader::tryReadCurrentPowerFrame(uint8_t first_byte, uint8_t second_byte) {
-    // 查找电流功率协议处理器
-    for (auto& protocol : protocols) {
-        if (auto currentPowerProtocol = dynamic_cast<CurrentPowerProtocol*>(protocol.get())) {
-            std::vector<uint8_t> frame_data;
-            frame_data.push_back(first_byte);  // 0xAA
-            frame_data.push_back(second_byte); // 0xAA
-            
-            // 读取剩余的数据
-            size_t remaining_size = currentPowerProtocol->getFrameSize() - 2;
-            uint8_t buffer[remaining_size];
-            size_t bytes_read = sp_blocking_read(port, buffer, remaining_size, 100);
-            
-            if (bytes_read != remaining_size) {
-                return false;
-            }
-            
-            // 添加剩余数据到frame_data
-            frame_data.insert(frame_data.end(), buffer, buffer + bytes_read);
-            
-            // 解析数据帧
-            if (currentPowerProtocol->parseFrame(frame_data)) {
-                return true;
-            }
-            break;
-        }
+int UartReader::readPending(size_t max_bytes) {
+    if (!transport->isOpen()) {
+        return 0;
+    }
+    size_t want = max_bytes < rx_buffer.size() ? max_bytes : rx_buffer.size();
+    if (want == 0) {
+        return 0;
+    }
+    int bytes_read = transport->readNonblocking(rx_buffer.data(), want);
+    if (bytes_read < 0) {
+        handleDisconnect("读取错误");
+        return -1;
     }
-    return false;
+    if (bytes_read > 0) {
+        decodeRead(static_cast<size_t>(bytes_read));
+    }
+    return bytes_read;
 }
 
-bool UartReader::tryReadSerialScreenFrame(uint8_t first_byte) {
-    // 查找串口屏协议处理器
-    for (auto& protocol : protocols) {
-        if (auto serialScreenProtocol = dynamic_cast<SerialScreenProtocol*>(protocol.get())) {
-            std::vector<uint8_t> frame_data;
-            frame_data.push_back(first_byte);  // 0x65
-            
-            // 读取剩余的数据（使用动态帧大小）
-            size_t remaining_size = serialScreenProtocol->getFrameSize() - 1; // 减去已读取的第一个字节
-            uint8_t buffer[remaining_size];
-            size_t bytes_read = sp_blocking_read(port, buffer, remaining_size, 200); // 优化超时时间到200ms
-            
-            if (bytes_read != remaining_size) {
-                return false;
-            }
-            
-            // 添加剩余数据到frame_data
-            frame_data.insert(frame_data.end(), buffer, buffer + bytes_read);
-            
-            // 解析数据帧
-            if (serialScreenProtocol->parseFrame(frame_data)) {
-                return true;
-            }
-            break;
-        }
+// 统计一次读取并交给分流器解码，返回解码出的帧数
+size_t UartReader::decodeRead(size_t bytes_read) {
+    ++read_stats.reads;
+    if (bytes_read >= 2 * min_frame_size) {
+        ++read_stats.drain_reads;
+    }
+    read_stats.bytes += static_cast<uint64_t>(bytes_read);
+    size_t frames = feed(rx_buffer.data(), bytes_read);
+    read_stats.frames += frames;
+
+    if (std::chrono::steady_clock::now() >= next_report) {
+        reportReadStats();
+    }
+    return frames;
+}
+
+void UartReader::recordBacklog(size_t backlog) {
+    read_stats.last_backlog = backlog;
+    if (backlog > read_stats.backlog_high_water) {
+        read_stats.backlog_high_water = backlog;
     }
-    return false;
-} 
\ No newline at end of file
+    if (!backlog_alarmed && backlog >= backlog_alarm_bytes) {
+        backlog_alarmed = true;
+        ++read_stats.backlog_alarms;
+        std::cerr << "接收积压告警: " << port_name << " 积压 " << backlog << " 字节 (阈值 " << backlog_alarm_bytes
+                  << ", 高水位 " << read_stats.backlog_high_water << ")，主循环处理不及时可能导致tty缓冲区溢出"
+                  << std::endl;
+    } else if (backlog_alarmed && backlog < backlog_alarm_bytes / 2) {
+        backlog_alarmed = false;
+    }
+}
+
+void UartReader::checkOverruns() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_overrun_check) {
+        return;
+    }
+    next_overrun_check = now + std::chrono::seconds(1);
+
+    long overruns = transport->overrunCount();
+    if (overruns < 0) {
+        return; // 驱动不支持（如伪终端）
+    }
+    if (read_stats.overruns >= 0 && overruns > read_stats.overruns) {
+        ++read_stats.overrun_alarms;
+        std::cerr << "接收溢出告警: " << port_name << " 内核报告新增 " << overruns - read_stats.overruns
+                  << " 次接收溢出 (累计 " << overruns << ")" << std::endl;
+    }
+    read_stats.overruns = overruns;
+}
+
+void UartReader::reportReadStats() {
+    next_report = std::chrono::steady_clock::now() + std::chrono::seconds(READ_REPORT_INTERVAL_S);
+    if (!verbose) {
+        return;
+    }
+    uint64_t reads = read_stats.reads - last_report.reads;
+    uint64_t bytes = read_stats.bytes - last_report.bytes;
+    uint64_t frames = read_stats.frames - last_report.frames;
+
+    std::cout << "\n=== 接收统计 (" << port_name << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "最近 " << READ_REPORT_INTERVAL_S << " s: 读取 " << reads << " 次, " << bytes << " 字节, "
+              << frames << " 帧, 平均每次 " << (reads > 0 ? static_cast<double>(bytes) / reads : 0.0)
+              << " 字节, 多帧读取 " << read_stats.drain_reads - last_report.drain_reads << " 次" << std::endl;
+    std::cout << "积压高水位: " << read_stats.backlog_high_water << " 字节, 积压告警 " << read_stats.backlog_alarms
+              << " 次, 接收溢出 ";
+    if (read_stats.overruns >= 0) {
+        std::cout << read_stats.overruns;
+    } else {
+        std::cout << "不支持";
+    }
+    std::cout << std::endl;
+    const FrameDemux::Stats& demux_stats = demux.getStats();
+    std::cout << "分流: 丢弃 " << demux_stats.discarded_bytes << " 字节, 候选校验失败 " << demux_stats.rejected
+              << " 次, 多候选裁决 " << demux_stats.ambiguous << " 次";
+    for (const FrameDemux::Route& route : demux.getRoutes()) {
+        std::cout << " | " << route.owner->getProtocolName() << "(帧头 " << std::hex << std::setfill('0')
+                  << std::setw(2) << static_cast<int>(route.format.header[0]) << std::dec << std::setfill(' ')
+                  << ") " << route.frames << " 帧";
+    }
+    std::cout << std::endl;
+    std::cout << "========================\n" << std::endl;
+    last_report = read_stats;
+}
+
+size_t UartReader::feed(const uint8_t* data, size_t length) {
+    return demux.feed(data, length);
+}
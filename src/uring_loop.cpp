@@ -0,0 +1,439 @@
+#include "uring_loop.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#ifdef UART_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace {
+
+// user_data 编码：端口号 << 8 | 操作类型
+enum UringOp : uint8_t {
+    OP_READ = 1,
+    OP_WRITE = 2,
+    OP_CANCEL = 3
+};
+
+uint64_t makeUserData(int port_id, uint8_t op) {
+    return (static_cast<uint64_t>(port_id) << 8) | op;
+}
+
+} // namespace
+
+UringLoop::UringLoop(size_t max_ports, size_t buffer_size, unsigned entries)
+    : ring_fd(-1), fixed_buffers(false), buffer_size(buffer_size), sq_entries(0), cq_entries(0),
+      pending_submit(0), sq_map(nullptr), sq_map_size(0), cq_map(nullptr), cq_map_size(0),
+      sqe_map(nullptr), sqe_map_size(0), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr),
+      sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr), cq_mask(nullptr), sqes(nullptr), cqes(nullptr) {
+    ports.resize(max_ports);
+    buffers.resize(max_ports * 2 * buffer_size);
+
+    if (!setupRing(entries)) {
+        closeRing();
+    }
+}
+
+UringLoop::~UringLoop() {
+    closeRing();
+}
+
+#ifdef UART_HAVE_IO_URING
+
+bool UringLoop::setupRing(unsigned entries) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0) {
+        std::cerr << "io_uring 不可用: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // 需要 IORING_ENTER_EXT_ARG 才能在一次 enter 中带超时等待（Linux 5.11+）
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        std::cerr << "io_uring 内核版本过旧（不支持带超时的等待）" << std::endl;
+        return false;
+    }
+
+    sq_entries = params.sq_entries;
+    cq_entries = params.cq_entries;
+    sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && cq_map_size > sq_map_size) {
+        sq_map_size = cq_map_size;
+    }
+
+    sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_SQ_RING);
+    if (sq_map == MAP_FAILED) {
+        sq_map = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_map = sq_map;
+    } else {
+        cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd, IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) {
+            cq_map = nullptr;
+            return false;
+        }
+    }
+    sqe_map_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqe_map = mmap(nullptr, sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, IORING_OFF_SQES);
+    if (sqe_map == MAP_FAILED) {
+        sqe_map = nullptr;
+        return false;
+    }
+
+    auto* sq = static_cast<uint8_t*>(sq_map);
+    auto* cq = static_cast<uint8_t*>(cq_map);
+    sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    sqes = static_cast<struct io_uring_sqe*>(sqe_map);
+
+    // 注册收发缓冲区：内核预先固定这些页面，每次读写不再需要映射用户内存
+    std::vector<struct iovec> iov(ports.size() * 2);
+    for (size_t i = 0; i < iov.size(); ++i) {
+        iov[i].iov_base = buffers.data() + i * buffer_size;
+        iov[i].iov_len = buffer_size;
+    }
+    fixed_buffers = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS,
+                            iov.data(), static_cast<unsigned>(iov.size())) == 0;
+    if (!fixed_buffers) {
+        // 通常是 RLIMIT_MEMLOCK 不足，退回普通读写
+        std::cerr << "io_uring 注册缓冲区失败(" << std::strerror(errno) << ")，使用普通读写请求" << std::endl;
+    }
+
+    std::cout << "io_uring 已启用: SQ " << sq_entries << " CQ " << cq_entries
+              << (fixed_buffers ? " 固定缓冲区" : "") << std::endl;
+    return true;
+}
+
+void UringLoop::closeRing() {
+    if (sqe_map) {
+        munmap(sqe_map, sqe_map_size);
+        sqe_map = nullptr;
+    }
+    if (cq_map && cq_map != sq_map) {
+        munmap(cq_map, cq_map_size);
+    }
+    cq_map = nullptr;
+    if (sq_map) {
+        munmap(sq_map, sq_map_size);
+        sq_map = nullptr;
+    }
+    if (ring_fd >= 0) {
+        ::close(ring_fd);
+        ring_fd = -1;
+    }
+}
+
+struct io_uring_sqe* UringLoop::getSqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    unsigned tail = *sq_tail;
+    if (tail - head >= sq_entries) {
+        // 提交队列已满：先把已有请求交给内核
+        enter(0, 0);
+        head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= sq_entries) {
+            return nullptr;
+        }
+    }
+    unsigned index = tail & *sq_mask;
+    struct io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++pending_submit;
+    return sqe;
+}
+
+int UringLoop::enter(unsigned min_complete, int timeout_ms) {
+    unsigned flags = 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    void* argp = nullptr;
+    size_t argsz = 0;
+
+    if (min_complete > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout_ms >= 0) {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000LL;
+            std::memset(&arg, 0, sizeof(arg));
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            argsz = sizeof(arg);
+        }
+    }
+
+    unsigned to_submit = pending_submit;
+    ++stats.enters;
+    int result = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                                          flags, argp, argsz));
+    if (result >= 0) {
+        pending_submit -= static_cast<unsigned>(result) < to_submit ? static_cast<unsigned>(result) : to_submit;
+    }
+    return result;
+}
+
+bool UringLoop::submitRead(int port_id) {
+    Port& port = ports[port_id];
+    struct io_uring_sqe* sqe = getSqe();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = port.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(rxBuffer(port_id));
+    sqe->len = static_cast<uint32_t>(buffer_size);
+    sqe->off = static_cast<uint64_t>(-1);   // 串口不可定位，使用当前位置
+    sqe->buf_index = static_cast<uint16_t>(port_id * 2);
+    sqe->user_data = makeUserData(port_id, OP_READ);
+    port.read_inflight = true;
+    return true;
+}
+
+bool UringLoop::submitWrite(int port_id) {
+    Port& port = ports[port_id];
+    struct io_uring_sqe* sqe = getSqe();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = fixed_buffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = port.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(txBuffer(port_id));
+    sqe->len = static_cast<uint32_t>(port.tx_length);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->buf_index = static_cast<uint16_t>(port_id * 2 + 1);
+    sqe->user_data = makeUserData(port_id, OP_WRITE);
+    port.write_inflight = true;
+    port.tx_inflight = port.tx_length;
+    ++stats.writes_submitted;
+    return true;
+}
+
+void UringLoop::submitCancel(int port_id, uint8_t op) {
+    struct io_uring_sqe* sqe = getSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = makeUserData(port_id, op);
+    sqe->user_data = makeUserData(port_id, OP_CANCEL);
+}
+
+int UringLoop::runOnce(int timeout_ms) {
+    if (ring_fd < 0) {
+        return 0;
+    }
+
+    // 批量写：每个端口把积累的命令合成一个写请求
+    for (size_t i = 0; i < ports.size(); ++i) {
+        Port& port = ports[i];
+        if (port.in_use && !port.failed && !port.write_inflight && port.tx_length > 0) {
+            submitWrite(static_cast<int>(i));
+        }
+    }
+
+    // 提交 + 等待只用一次系统调用
+    if (enter(1, timeout_ms) < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+        ++stats.errors;
+        return 0;
+    }
+
+    int handled = 0;
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe& cqe = cqes[head & *cq_mask];
+        uint64_t user_data = cqe.user_data;
+        int32_t res = cqe.res;
+        ++head;
+        // 先释放 CQE 槽位，处理函数中可能再次提交请求
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        handleCompletion(user_data, res);
+        ++handled;
+        tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    }
+    return handled;
+}
+
+#else // !UART_HAVE_IO_URING
+
+bool UringLoop::setupRing(unsigned entries) {
+    (void)entries;
+    std::cerr << "编译时未启用 io_uring 支持" << std::endl;
+    return false;
+}
+
+void UringLoop::closeRing() {
+    ring_fd = -1;
+}
+
+struct io_uring_sqe* UringLoop::getSqe() { return nullptr; }
+int UringLoop::enter(unsigned, int) { return -1; }
+bool UringLoop::submitRead(int) { return false; }
+bool UringLoop::submitWrite(int) { return false; }
+void UringLoop::submitCancel(int, uint8_t) {}
+int UringLoop::runOnce(int) { return 0; }
+
+#endif // UART_HAVE_IO_URING
+
+int UringLoop::addPort(int fd, DataHandler on_data, ErrorHandler on_error) {
+    if (ring_fd < 0 || fd < 0) {
+        return -1;
+    }
+
+    int port_id = -1;
+    for (size_t i = 0; i < ports.size(); ++i) {
+        const Port& port = ports[i];
+        if (!port.in_use && !port.read_inflight && !port.write_inflight) {
+            port_id = static_cast<int>(i);
+            break;
+        }
+    }
+    if (port_id < 0) {
+        std::cerr << "io_uring 端口数量已达上限: " << ports.size() << std::endl;
+        return -1;
+    }
+
+    // VMIN=0 的 tty 没有数据时读请求立即以0完成，会让循环空转；
+    // 改为阻塞 + VMIN=1 后内核在数据到达时才完成读请求
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    Port& port = ports[port_id];
+    port.fd = fd;
+    port.in_use = true;
+    port.failed = false;
+    port.tx_length = 0;
+    port.tx_inflight = 0;
+    port.on_data = std::move(on_data);
+    port.on_error = std::move(on_error);
+
+    if (!submitRead(port_id)) {
+        port.in_use = false;
+        return -1;
+    }
+    return port_id;
+}
+
+void UringLoop::removePort(int port_id) {
+    if (port_id < 0 || static_cast<size_t>(port_id) >= ports.size() || !ports[port_id].in_use) {
+        return;
+    }
+    Port& port = ports[port_id];
+    // 请求持有文件引用，关闭 fd 并不会取消它们，需要显式取消
+    if (port.read_inflight) {
+        submitCancel(port_id, OP_READ);
+    }
+    if (port.write_inflight) {
+        submitCancel(port_id, OP_WRITE);
+    }
+    if (port.read_inflight || port.write_inflight) {
+        enter(0, 0);
+    }
+    port.in_use = false;
+    port.fd = -1;
+    port.tx_length = 0;
+}
+
+size_t UringLoop::queueWrite(int port_id, const uint8_t* data, size_t length) {
+    if (port_id < 0 || static_cast<size_t>(port_id) >= ports.size() || !ports[port_id].in_use) {
+        return 0;
+    }
+    Port& port = ports[port_id];
+    size_t space = buffer_size - port.tx_length;
+    size_t count = length < space ? length : space;
+    std::memcpy(txBuffer(port_id) + port.tx_length, data, count);
+    port.tx_length += count;
+    return count;
+}
+
+size_t UringLoop::pendingWrite(int port_id) const {
+    if (port_id < 0 || static_cast<size_t>(port_id) >= ports.size()) {
+        return 0;
+    }
+    return ports[port_id].tx_length;
+}
+
+void UringLoop::handleCompletion(uint64_t user_data, int32_t res) {
+    int port_id = static_cast<int>(user_data >> 8);
+    uint8_t op = static_cast<uint8_t>(user_data & 0xFF);
+    if (op == OP_CANCEL || port_id < 0 || static_cast<size_t>(port_id) >= ports.size()) {
+        return;
+    }
+    Port& port = ports[port_id];
+
+    if (op == OP_READ) {
+        port.read_inflight = false;
+        if (!port.in_use || port.failed) {
+            return; // 已移除的端口，等待取消完成即可
+        }
+        if (res > 0) {
+            ++stats.read_completions;
+            stats.bytes_read += static_cast<uint64_t>(res);
+            port.on_data(rxBuffer(port_id), static_cast<size_t>(res));
+            // 处理函数可能已经关闭端口（如协议检测到断线）
+            if (port.in_use && !port.failed && !port.read_inflight) {
+                submitRead(port_id);
+            }
+        } else if (res == -EAGAIN || res == -EINTR) {
+            submitRead(port_id);
+        } else {
+            failPort(port_id); // 0 为挂断，负值为读取错误
+        }
+        return;
+    }
+
+    // OP_WRITE
+    port.write_inflight = false;
+    if (!port.in_use || port.failed) {
+        return;
+    }
+    if (res > 0) {
+        size_t written = static_cast<size_t>(res);
+        stats.bytes_written += written;
+        // 前移未写出的数据（包括写请求进行期间追加的命令）
+        std::memmove(txBuffer(port_id), txBuffer(port_id) + written, port.tx_length - written);
+        port.tx_length -= written;
+        port.tx_inflight = 0;
+    } else if (res != -EAGAIN && res != -EINTR) {
+        failPort(port_id);
+    }
+}
+
+void UringLoop::failPort(int port_id) {
+    Port& port = ports[port_id];
+    ++stats.errors;
+    port.failed = true;
+    if (port.on_error) {
+        port.on_error(); // 通常会调用 removePort()
+    }
+}
@@ -0,0 +1,54 @@
+#include "uring_transport.h"
+
+UringTransport::UringTransport(UringLoop& loop, std::unique_ptr<Transport> inner)
+    : loop(loop), inner(std::move(inner)), port_id(-1), failed(false) {}
+
+UringTransport::~UringTransport() {
+    close();
+}
+
+bool UringTransport::open() {
+    if (!inner->open()) {
+        return false;
+    }
+    // 丢弃打开前残留的数据，之后所有接收都经过 io_uring
+    inner->flushInput();
+    failed = false;
+    port_id = loop.addPort(inner->getFileDescriptor(), receiver, [this]() {
+        failed = true;
+        if (error_handler) {
+            error_handler();
+        }
+    });
+    if (port_id < 0) {
+        inner->close();
+        return false;
+    }
+    return true;
+}
+
+void UringTransport::close() {
+    if (port_id >= 0) {
+        loop.removePort(port_id);
+        port_id = -1;
+    }
+    inner->close();
+}
+
+int UringTransport::read(uint8_t* buffer, size_t n, unsigned int timeout_ms) {
+    (void)timeout_ms;
+    return readNonblocking(buffer, n);
+}
+
+int UringTransport::readNonblocking(uint8_t* buffer, size_t n) {
+    (void)buffer;
+    (void)n;
+    return (port_id < 0 || failed) ? -1 : 0;
+}
+
+int UringTransport::write(const uint8_t* data, size_t length) {
+    if (port_id < 0 || failed) {
+        return -1;
+    }
+    return static_cast<int>(loop.queueWrite(port_id, data, length));
+}
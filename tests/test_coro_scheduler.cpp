@@ -0,0 +1,138 @@
+// 协程调度器测试：AsyncPort 的读取、写满内核缓冲区后的挂起写入和取消
+#include "test_util.h"
+#include "coro_scheduler.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Pipe {
+    int fds[2] = {-1, -1};
+    Pipe() {
+        if (pipe2(fds, O_NONBLOCK) != 0) {
+            fds[0] = fds[1] = -1;
+        }
+    }
+    ~Pipe() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+};
+
+Task<void> writeAll(Scheduler& scheduler, AsyncPort& port, const std::vector<uint8_t>& data, int& result) {
+    // 两次写入排队：第二次在第一次写完之后才开始，字节不交错
+    size_t half = data.size() / 2;
+    int first = co_await port.write(data.data(), half);
+    int second = co_await port.write(data.data() + half, data.size() - half);
+    result = first < 0 || second < 0 ? -1 : first + second;
+    scheduler.stop();
+}
+
+Task<void> readLater(Scheduler& scheduler, int fd, std::vector<uint8_t>& received) {
+    // 等写协程挂起在 EPOLLOUT 上后再开始读，腾出缓冲区空间
+    co_await scheduler.sleep(10);
+    uint8_t buffer[4096];
+    while (scheduler.isRunning()) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            received.insert(received.end(), buffer, buffer + n);
+        }
+        co_await scheduler.sleep(1);
+    }
+}
+
+void testWriteWaitsForBufferSpace() {
+    Scheduler scheduler;
+    CHECK(scheduler.isValid());
+    Pipe pipe;
+    CHECK(pipe.fds[1] >= 0);
+    fcntl(pipe.fds[1], F_SETPIPE_SZ, 4096);
+
+    std::vector<uint8_t> data(256 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    AsyncPort port(scheduler, pipe.fds[1]);
+    CHECK(port.isValid());
+    int result = 0;
+    std::vector<uint8_t> received;
+    scheduler.spawn(writeAll(scheduler, port, data, result));
+    scheduler.spawn(readLater(scheduler, pipe.fds[0], received));
+    scheduler.run();
+
+    // 写协程恢复时数据已全部进入管道，读出剩余部分后与原数据一致
+    uint8_t buffer[4096];
+    ssize_t n;
+    while ((n = read(pipe.fds[0], buffer, sizeof(buffer))) > 0) {
+        received.insert(received.end(), buffer, buffer + n);
+    }
+    CHECK_EQ(result, static_cast<int>(data.size()));
+    CHECK(received == data);
+}
+
+Task<void> writeUntilCancelled(AsyncPort& port, const std::vector<uint8_t>& data, int& result, bool& done) {
+    result = co_await port.write(data.data(), data.size());
+    done = true;
+}
+
+Task<void> cancelLater(Scheduler& scheduler, AsyncPort& port, const bool& done) {
+    co_await scheduler.sleep(10);
+    port.cancel();
+    while (!done) {
+        co_await scheduler.sleep(1);
+    }
+    scheduler.stop();
+}
+
+void testCancelResumesPendingWrite() {
+    Scheduler scheduler;
+    Pipe pipe;
+    fcntl(pipe.fds[1], F_SETPIPE_SZ, 4096);
+
+    // 没有读者：写协程挂起在 EPOLLOUT 上，连接结束时 cancel() 让它以错误返回
+    std::vector<uint8_t> data(64 * 1024, 0x55);
+    int result = 0;
+    bool done = false;
+    {
+        AsyncPort port(scheduler, pipe.fds[1]);
+        scheduler.spawn(writeUntilCancelled(port, data, result, done));
+        scheduler.spawn(cancelLater(scheduler, port, done));
+        scheduler.run();
+        CHECK(port.hasError());
+    }
+    CHECK(done);
+    CHECK_EQ(result, -1);
+}
+
+Task<void> readFrame(AsyncPort& port, std::vector<int>& results, Scheduler& scheduler) {
+    uint8_t buffer[8];
+    results.push_back(co_await port.readExact(buffer, 4, 200));   // 读满
+    results.push_back(co_await port.readExact(buffer, 8, 0));     // 只取已到达的
+    results.push_back(co_await port.readExact(buffer, 4, 20));    // 超时返回已读到的部分
+    scheduler.stop();
+}
+
+void testReadExactTimeouts() {
+    Scheduler scheduler;
+    Pipe pipe;
+    const uint8_t bytes[7] = {1, 2, 3, 4, 5, 6, 7};
+    CHECK_EQ(write(pipe.fds[1], bytes, sizeof(bytes)), 7);
+    AsyncPort port(scheduler, pipe.fds[0]);
+    std::vector<int> results;
+    scheduler.spawn(readFrame(port, results, scheduler));
+    scheduler.run();
+    CHECK(results == std::vector<int>({4, 3, 0}));
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testWriteWaitsForBufferSpace);
+    RUN_TEST(testCancelResumesPendingWrite);
+    RUN_TEST(testReadExactTimeouts);
+    return test_util::finish();
+}
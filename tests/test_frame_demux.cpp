@@ -0,0 +1,249 @@
+// 多协议分流测试：同一字节流上混合传感器帧和串口屏帧，以及共用串口的断线处理
+#include "test_util.h"
+#include "test_frames.h"
+#include "frame_demux.h"
+#include "memory_transport.h"
+#include "shared_port_transport.h"
+#include "uart_reader.h"
+#include "current_power_protocol.h"
+#include "serial_screen_protocol.h"
+#include <thread>
+
+namespace {
+
+// 记录收到的帧的测试协议
+class RecordingProtocol : public Protocol {
+public:
+    explicit RecordingProtocol(std::vector<FrameFormat> formats) : formats(std::move(formats)) {}
+
+    bool parseFrame(const std::vector<uint8_t>& frame_data) override {
+        frames.push_back(frame_data);
+        return true;
+    }
+    bool isValidFrame(const std::vector<uint8_t>& frame_data) override {
+        return !(reject_long && frame_data.size() > formats.front().size);
+    }
+    size_t getFrameSize() const override { return formats.front().size; }
+    std::string getProtocolName() const override { return "测试协议"; }
+    std::vector<FrameFormat> getFrameFormats() const override { return formats; }
+
+    std::vector<FrameFormat> formats;
+    std::vector<std::vector<uint8_t>> frames;
+    bool reject_long = false;           // 长帧的完整校验失败
+};
+
+struct PowerSink {
+    int calls = 0;
+    float power = 0.0f;
+};
+
+std::unique_ptr<CurrentPowerProtocol> makePowerProtocol(PowerSink& sink) {
+    auto protocol = std::make_unique<CurrentPowerProtocol>();
+    protocol->setVerbose(false);
+    protocol->setCurrentPowerCallback([&sink](float, float power) {
+        ++sink.calls;
+        sink.power = power;
+    });
+    return protocol;
+}
+
+void testSplitsMixedSensorAndScreenFrames() {
+    PowerSink sink;
+    auto power = makePowerProtocol(sink);
+    SerialScreenProtocol screen(std::make_unique<MemoryTransport>("screen"));
+    int start_events = 0;
+    screen.registerEventCallback(SerialScreenEvent::START_BUTTON, [&start_events]() { ++start_events; });
+
+    FrameDemux demux;
+    demux.addProtocol(*power);
+    demux.addProtocol(screen);
+    CHECK_EQ(demux.getMinFrameSize(), 4u);
+
+    std::vector<uint8_t> bytes = makePowerFrame(1.0f, 10.0f);
+    append(bytes, makeScreenEvent(0x01, 0x02, 0x01));
+    append(bytes, makePowerFrame(2.0f, 20.0f));
+    append(bytes, {0xFD, 0xFF, 0xFF, 0xFF});   // 透传应答（没有进行中的透传时忽略）
+    append(bytes, makePowerFrame(3.0f, 30.0f));
+
+    // 逐字节输入，与一次输入的结果相同
+    size_t frames = 0;
+    for (uint8_t byte : bytes) {
+        frames += demux.feed(&byte, 1);
+    }
+    CHECK_EQ(frames, 5u);
+    CHECK_EQ(sink.calls, 3);
+    CHECK_NEAR(sink.power, 30.0, 1e-6);
+    CHECK_EQ(start_events, 1);
+    CHECK_EQ(demux.getStats().discarded_bytes, 0u);
+    for (const FrameDemux::Route& route : demux.getRoutes()) {
+        if (route.format.header[0] == 0xAA) {
+            CHECK_EQ(route.frames, 3u);
+        } else if (route.format.header[0] == 0xFD) {
+            CHECK_EQ(route.frames, 1u);
+        }
+    }
+}
+
+void testResyncsAfterNoise() {
+    PowerSink sink;
+    auto power = makePowerProtocol(sink);
+    FrameDemux demux;
+    demux.addProtocol(*power);
+
+    // 噪声里混有一个帧头字节，逐字节丢弃后在真正的帧头处同步
+    std::vector<uint8_t> bytes = {0x00, 0xAA, 0x13, 0xFF, 0xAA};
+    append(bytes, makePowerFrame(1.0f, 5.0f));
+    CHECK_EQ(demux.feed(bytes.data(), bytes.size()), 1u);
+    CHECK_EQ(sink.calls, 1);
+    CHECK_EQ(demux.getStats().discarded_bytes, 5u);
+}
+
+void testTruncatedFrameDoesNotSwallowNext() {
+    PowerSink sink;
+    auto power = makePowerProtocol(sink);
+    SerialScreenProtocol screen(std::make_unique<MemoryTransport>("screen"));
+    int start_events = 0;
+    screen.registerEventCallback(SerialScreenEvent::START_BUTTON, [&start_events]() { ++start_events; });
+    FrameDemux demux;
+    demux.addProtocol(*power);
+    demux.addProtocol(screen);
+
+    // 传感器帧只发出前8字节就被按键帧打断：按键帧和之后的完整传感器帧都能解出
+    std::vector<uint8_t> truncated = makePowerFrame(9.0f, 90.0f);
+    truncated.resize(8);
+    std::vector<uint8_t> bytes = truncated;
+    append(bytes, makeScreenEvent(0x01, 0x02, 0x01));
+    append(bytes, makePowerFrame(1.0f, 10.0f));
+    CHECK_EQ(demux.feed(bytes.data(), bytes.size()), 2u);
+    CHECK_EQ(start_events, 1);
+    CHECK_EQ(sink.calls, 1);
+    CHECK_NEAR(sink.power, 10.0, 1e-6);
+    CHECK_EQ(demux.getStats().discarded_bytes, 8u);
+    CHECK(demux.getStats().rejected >= 1);
+}
+
+void testWaitsForLongerCandidate() {
+    // 同一帧头的短帧（4字节）和长帧（8字节），帧尾都是 0x0D
+    RecordingProtocol protocol({FrameFormat{{0x5A}, {0x0D}, 4}, FrameFormat{{0x5A}, {0x0D}, 8}});
+    FrameDemux demux;
+    demux.addProtocol(protocol);
+
+    // 短帧已完整，但长帧还在等待字节：先不输出
+    const uint8_t short_frame[4] = {0x5A, 0x01, 0x02, 0x0D};
+    CHECK_EQ(demux.feed(short_frame, sizeof(short_frame)), 0u);
+    CHECK(protocol.frames.empty());
+
+    // 线路空闲：按已到齐的字节裁决，输出短帧
+    CHECK_EQ(demux.flush(), 1u);
+    CHECK_EQ(protocol.frames.size(), 1u);
+    CHECK_EQ(protocol.frames[0].size(), 4u);
+
+    // 两种长度都通过校验时取长帧
+    const uint8_t long_frame[8] = {0x5A, 0x01, 0x02, 0x0D, 0x03, 0x04, 0x05, 0x0D};
+    CHECK_EQ(demux.feed(long_frame, sizeof(long_frame)), 1u);
+    CHECK_EQ(protocol.frames.back().size(), 8u);
+    CHECK_EQ(demux.getStats().ambiguous, 1u);
+
+    // 长帧校验失败时退回短帧，剩余字节重新同步
+    protocol.reject_long = true;
+    const uint8_t rejected[8] = {0x5A, 0x07, 0x02, 0x0D, 0x5A, 0x08, 0x09, 0x0D};
+    CHECK_EQ(demux.feed(rejected, sizeof(rejected)), 1u);
+    CHECK(protocol.frames.back() == std::vector<uint8_t>({0x5A, 0x07, 0x02, 0x0D}));
+    CHECK_EQ(demux.flush(), 1u);
+    CHECK(protocol.frames.back() == std::vector<uint8_t>({0x5A, 0x08, 0x09, 0x0D}));
+    CHECK_EQ(demux.getStats().rejected, 1u);
+}
+
+void testTransferResponsesReachScreen() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport));
+    CHECK(screen.open());
+    WaveformConfig config;
+    config.batch_points = 2;
+    config.budget_bytes_per_s = 1e6;
+    screen.enableWaveform(config);
+    const float samples[2] = {50.0f, 100.0f};
+    screen.pushWaveformSamples(samples, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    screen.sendPeriodicData();
+    CHECK(screen.getWaveform()->busy());
+    memory->takeTx();
+
+    PowerSink sink;
+    auto power = makePowerProtocol(sink);
+    FrameDemux demux;
+    demux.addProtocol(*power);
+    demux.addProtocol(screen);
+
+    // 0xFE 应答夹在传感器帧之间，分流给串口屏协议后写出点数据
+    std::vector<uint8_t> bytes = makePowerFrame(1.0f, 1.0f);
+    append(bytes, {0xFE, 0xFF, 0xFF, 0xFF});
+    append(bytes, makePowerFrame(1.0f, 2.0f));
+    append(bytes, {0xFD, 0xFF, 0xFF, 0xFF});
+    CHECK_EQ(demux.feed(bytes.data(), bytes.size()), 4u);
+    CHECK_EQ(sink.calls, 2);
+    CHECK(memory->takeTx() == std::vector<uint8_t>({128, 255}));
+    CHECK(!screen.getWaveform()->busy());
+}
+
+void testSharedPortDisconnectGoesThroughScreen() {
+    auto transport = std::make_unique<MemoryTransport>("shared");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport));
+    CHECK(screen.open());
+    screen.setExternalReceive(true);
+
+    PowerSink sink;
+    UartReader reader(std::make_unique<SharedPortTransport>(screen.getTransport()));
+    reader.setVerbose(false);
+    reader.addProtocol(makePowerProtocol(sink));
+    reader.attachProtocol(screen);
+    reader.setDisconnectCallback([&screen](const char* reason) {
+        if (screen.isConnected()) {
+            screen.handleDisconnect(reason);
+        }
+    });
+    CHECK(reader.open());
+
+    std::vector<uint8_t> bytes = makePowerFrame(1.0f, 3.0f);
+    append(bytes, makeScreenEvent(0x01, 0x02, 0x01));
+    memory->injectRx(bytes.data(), bytes.size());
+    CHECK(reader.readAndParseFrame());
+    CHECK_EQ(sink.calls, 1);
+    memory->takeTx();
+
+    // 读取端断线：串口屏协议走自己的断线处理，关闭串口并进入重连
+    reader.handleDisconnect("读取错误");
+    CHECK(!reader.isConnected());
+    CHECK(!screen.isConnected());
+    CHECK(!memory->isOpen());
+
+    // 重连后两端都恢复，串口屏重新发送全部数据
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    screen.maintainConnection();
+    reader.maintainConnection();
+    CHECK(screen.isConnected());
+    CHECK(reader.isConnected());
+    std::vector<uint8_t> tx = memory->takeTx();
+    std::string sent(tx.begin(), tx.end());
+    CHECK(sent.find("t0.txt=\"") != std::string::npos);
+
+    // 读取器析构不关闭借用的串口
+    {
+        UartReader borrower(std::make_unique<SharedPortTransport>(screen.getTransport()));
+    }
+    CHECK(memory->isOpen());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testSplitsMixedSensorAndScreenFrames);
+    RUN_TEST(testResyncsAfterNoise);
+    RUN_TEST(testTruncatedFrameDoesNotSwallowNext);
+    RUN_TEST(testWaitsForLongerCandidate);
+    RUN_TEST(testTransferResponsesReachScreen);
+    RUN_TEST(testSharedPortDisconnectGoesThroughScreen);
+    return test_util::finish();
+}
@@ -0,0 +1,202 @@
+// 帧序号跟踪测试：丢帧、重复、重置、回绕、时钟漂移和统计周期
+#include "test_util.h"
+#include "test_frames.h"
+#include "frame_sequence.h"
+#include "current_power_protocol.h"
+#include "memory_transport.h"
+#include "uart_reader.h"
+
+namespace {
+
+using Clock = FrameSequenceTracker::Clock;
+
+Clock::time_point at(Clock::time_point base, double seconds) {
+    return base + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void testCountsGapsAndDuplicates() {
+    FrameSequenceTracker tracker;
+    Clock::time_point t0 = Clock::now();
+    tracker.observe(10, 0, t0);
+    tracker.observe(11, 10, at(t0, 0.01));
+    tracker.observe(14, 40, at(t0, 0.04));     // 丢失 12、13
+    tracker.observe(14, 40, at(t0, 0.04));     // 重复
+    tracker.observe(20, 100, at(t0, 0.10));    // 丢失 15~19
+
+    const FrameSequenceTracker::Stats& stats = tracker.getStats();
+    CHECK_EQ(stats.frames, 5u);
+    CHECK_EQ(stats.lost, 7u);
+    CHECK_EQ(stats.gaps, 2u);
+    CHECK_EQ(stats.duplicates, 1u);
+    CHECK_EQ(stats.resets, 0u);
+    CHECK_EQ(stats.last_sequence, 20u);
+    CHECK_NEAR(tracker.lossRate(), 7.0 / 12.0, 1e-9);
+}
+
+void testSequenceWrapIsNotAReset() {
+    FrameSequenceTracker tracker;
+    Clock::time_point t0 = Clock::now();
+    tracker.observe(0xFFFFFFFEu, 0, t0);
+    tracker.observe(0xFFFFFFFFu, 1, t0);
+    tracker.observe(1, 3, t0);                 // 回绕，丢失 0
+    CHECK_EQ(tracker.getStats().resets, 0u);
+    CHECK_EQ(tracker.getStats().lost, 1u);
+}
+
+void testLargeJumpOrRollbackIsAReset() {
+    FrameSequenceTracker tracker(1000.0, 1000);
+    Clock::time_point t0 = Clock::now();
+    tracker.observe(500, 0, t0);
+    tracker.observe(501, 1, t0);
+    tracker.observe(3, 0, t0);                 // 传感器重启，序号回到起点
+    tracker.observe(4, 1, t0);
+    tracker.observe(50000, 2, t0);             // 跳变超过 max_gap
+    CHECK_EQ(tracker.getStats().resets, 2u);
+    CHECK_EQ(tracker.getStats().lost, 0u);
+    CHECK_EQ(tracker.getStats().last_sequence, 50000u);
+}
+
+void testEstimatesClockDrift() {
+    // 传感器时钟快 100 ppm：微秒计数，主机每过 1 s 设备时刻前进 1000100 个 tick
+    FrameSequenceTracker tracker(1e6);
+    Clock::time_point t0 = Clock::now();
+    for (uint32_t i = 0; i <= 50; ++i) {
+        double host_s = i * 0.1;
+        auto tick = static_cast<uint32_t>(host_s * 1e6 * (1.0 + 100e-6) + 0.5);
+        tracker.observe(i, tick, at(t0, host_s));
+        if (host_s < 1.9) {
+            CHECK(!tracker.getStats().drift_valid);  // 跨度不足2秒不输出
+        }
+    }
+    CHECK(tracker.getStats().drift_valid);
+    CHECK_NEAR(tracker.getStats().drift_ppm, 100.0, 1.0);
+
+    // 重启后重新拟合
+    tracker.observe(0, 0, at(t0, 5.1));
+    CHECK(!tracker.getStats().drift_valid);
+}
+
+void testWindowReportsIncrements() {
+    FrameSequenceTracker tracker;
+    Clock::time_point t0 = Clock::now();
+    tracker.takeWindow(t0);
+    tracker.observe(1, 0, t0);
+    tracker.observe(3, 2, t0);                 // 丢失 2
+
+    FrameSequenceTracker::Window window = tracker.takeWindow(at(t0, 2.0));
+    CHECK_EQ(window.frames, 2u);
+    CHECK_EQ(window.lost, 1u);
+    CHECK_NEAR(window.seconds, 2.0, 1e-6);
+    CHECK_NEAR(window.lossRate(), 1.0 / 3.0, 1e-9);
+
+    tracker.observe(4, 3, at(t0, 2.5));
+    window = tracker.takeWindow(at(t0, 3.0));
+    CHECK_EQ(window.frames, 1u);
+    CHECK_EQ(window.lost, 0u);
+    CHECK_NEAR(window.seconds, 1.0, 1e-6);
+    CHECK_EQ(tracker.getStats().frames, 3u);   // 累计值不受统计周期影响
+}
+
+void testProtocolSwitchesToExtendedFrames() {
+    CurrentPowerProtocol protocol;
+    protocol.setVerbose(false);
+    protocol.setSequenceMode(SequenceMode::AUTO);
+
+    // 保留字节全为0的旧固件帧不启用帧序号
+    CHECK(protocol.parseFrame(makePowerFrame(1.0f, 2.0f)));
+    CHECK(!protocol.isExtendedActive());
+
+    CHECK(protocol.parseFrame(makePowerFrame(1.0f, 2.0f, 7, 100)));
+    CHECK(protocol.isExtendedActive());
+    CHECK(protocol.parseFrame(makePowerFrame(1.0f, 2.0f, 9, 120)));
+    const FrameSequenceTracker::Stats& stats = protocol.getSequenceTracker().getStats();
+    CHECK_EQ(stats.frames, 2u);
+    CHECK_EQ(stats.lost, 1u);
+    CHECK_EQ(stats.last_sequence, 9u);
+
+    // LEGACY 模式下保留字节不解码
+    protocol.setSequenceMode(SequenceMode::LEGACY);
+    CHECK(protocol.parseFrame(makePowerFrame(1.0f, 2.0f, 10, 130)));
+    CHECK(!protocol.isExtendedActive());
+    CHECK_EQ(protocol.getSequenceTracker().getStats().frames, 0u);
+}
+
+void testReconnectRedetectsFrameFormat() {
+    auto transport = std::make_unique<MemoryTransport>();
+    MemoryTransport* memory = transport.get();
+    UartReader reader(std::move(transport));
+    reader.setVerbose(false);
+    auto owned = std::make_unique<CurrentPowerProtocol>();
+    CurrentPowerProtocol* protocol = owned.get();
+    protocol->setVerbose(false);
+    protocol->setSequenceMode(SequenceMode::AUTO);
+    reader.addProtocol(std::move(owned));
+    CHECK(reader.open());
+
+    std::vector<uint8_t> frame = makePowerFrame(1.0f, 2.0f, 7, 100);
+    memory->injectRx(frame.data(), frame.size());
+    CHECK(reader.readAndParseFrame());
+    CHECK(protocol->isExtendedActive());
+
+    // 重连后 AUTO 模式回到检测状态，换成旧固件时不会把全0保留字节当作帧序号
+    memory->close();
+    CHECK(reader.open());
+    CHECK(!protocol->isExtendedActive());
+    frame = makePowerFrame(1.0f, 2.0f);
+    memory->injectRx(frame.data(), frame.size());
+    CHECK(reader.readAndParseFrame());
+    CHECK(!protocol->isExtendedActive());
+
+    // EXTENDED 模式重置后仍按扩展格式解码
+    protocol->setSequenceMode(SequenceMode::EXTENDED);
+    protocol->reset();
+    CHECK(protocol->isExtendedActive());
+}
+
+void testReconnectStartsNewBaseline() {
+    auto transport = std::make_unique<MemoryTransport>();
+    MemoryTransport* memory = transport.get();
+    UartReader reader(std::move(transport));
+    reader.setVerbose(false);
+    auto owned = std::make_unique<CurrentPowerProtocol>();
+    CurrentPowerProtocol* protocol = owned.get();
+    protocol->setVerbose(false);
+    protocol->setSequenceMode(SequenceMode::EXTENDED, 1e6);
+    reader.addProtocol(std::move(owned));
+    CHECK(reader.open());
+
+    std::vector<uint8_t> bytes = makePowerFrame(1.0f, 2.0f, 5, 1000);
+    append(bytes, makePowerFrame(1.0f, 2.0f, 6, 2000));
+    memory->injectRx(bytes.data(), bytes.size());
+    CHECK(reader.readAndParseFrame());
+
+    // 断线期间传感器继续计数：重连后的第一帧是新基准，不是丢帧
+    memory->close();
+    CHECK(reader.open());
+    bytes = makePowerFrame(1.0f, 2.0f, 50, 900000);
+    append(bytes, makePowerFrame(1.0f, 2.0f, 52, 901000));
+    memory->injectRx(bytes.data(), bytes.size());
+    CHECK(reader.readAndParseFrame());
+
+    const FrameSequenceTracker::Stats& stats = protocol->getSequenceTracker().getStats();
+    CHECK_EQ(stats.frames, 4u);        // 累计值跨重连保留
+    CHECK_EQ(stats.lost, 1u);          // 只有重连后 51 的丢失
+    CHECK_EQ(stats.gaps, 1u);
+    CHECK_EQ(stats.resets, 0u);
+    CHECK_EQ(stats.last_sequence, 52u);
+    CHECK(!stats.drift_valid);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testCountsGapsAndDuplicates);
+    RUN_TEST(testSequenceWrapIsNotAReset);
+    RUN_TEST(testLargeJumpOrRollbackIsAReset);
+    RUN_TEST(testEstimatesClockDrift);
+    RUN_TEST(testWindowReportsIncrements);
+    RUN_TEST(testProtocolSwitchesToExtendedFrames);
+    RUN_TEST(testReconnectRedetectsFrameFormat);
+    RUN_TEST(testReconnectStartsNewBaseline);
+    return test_util::finish();
+}
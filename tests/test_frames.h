@@ -0,0 +1,52 @@
+#ifndef TEST_FRAMES_H
+#define TEST_FRAMES_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 测试用的协议帧构造
+
+// 电流功率帧：AA AA + 电流(float) + 功率(float) + 帧序号(u32) + 设备时刻(u32) + FF FF，均为小端
+inline std::vector<uint8_t> makePowerFrame(float current, float power, uint32_t sequence = 0, uint32_t tick = 0) {
+    uint8_t frame[20] = {};
+    frame[0] = 0xAA;
+    frame[1] = 0xAA;
+    std::memcpy(&frame[2], &current, sizeof(float));
+    std::memcpy(&frame[6], &power, sizeof(float));
+    for (int i = 0; i < 4; ++i) {
+        frame[10 + i] = static_cast<uint8_t>(sequence >> (8 * i));
+        frame[14 + i] = static_cast<uint8_t>(tick >> (8 * i));
+    }
+    frame[18] = 0xFF;
+    frame[19] = 0xFF;
+    return std::vector<uint8_t>(frame, frame + sizeof(frame));
+}
+
+// 串口屏按键事件帧：65 页面 控件 事件 FF FF FF
+inline std::vector<uint8_t> makeScreenEvent(uint8_t page, uint8_t control, uint8_t event) {
+    const uint8_t frame[7] = {0x65, page, control, event, 0xFF, 0xFF, 0xFF};
+    return std::vector<uint8_t>(frame, frame + sizeof(frame));
+}
+
+// 串口屏赋值命令：name="value" FF FF FF
+inline std::vector<uint8_t> makeScreenCommand(const std::string& text) {
+    std::vector<uint8_t> bytes(text.size() + 3, 0xFF);
+    std::memcpy(bytes.data(), text.data(), text.size());
+    return bytes;
+}
+
+// 在 out 末尾追加 bytes（按总长度分配一次后整块复制）
+inline void append(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes) {
+    std::vector<uint8_t> joined(out.size() + bytes.size());
+    if (!out.empty()) {
+        std::memcpy(joined.data(), out.data(), out.size());
+    }
+    if (!bytes.empty()) {
+        std::memcpy(joined.data() + out.size(), bytes.data(), bytes.size());
+    }
+    out.swap(joined);
+}
+
+#endif // TEST_FRAMES_H
@@ -0,0 +1,105 @@
+// 卡顿分析器测试：超预算时的迭代记录按时间顺序保存环形缓冲区
+#include "test_util.h"
+#include "loop_profiler.h"
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void spin(std::chrono::microseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// 运行 count 次空迭代，最后一次超出预算；超预算记录取自最后一次卡顿，与中途的偶发卡顿无关
+void runIterations(LoopProfiler& profiler, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        profiler.beginIteration();
+        profiler.beginTask(LoopProfiler::TASK_POWER_READ);
+        if (i + 1 == count) {
+            spin(std::chrono::milliseconds(5));
+        }
+        profiler.beginTask(LoopProfiler::TASK_SLEEP);
+        profiler.endIteration();
+    }
+}
+
+// 从打印结果中取出超预算记录的迭代序号
+std::vector<int> stallTraceIndices(const LoopProfiler& profiler) {
+    std::ostringstream out;
+    profiler.dump(out);
+    std::istringstream in(out.str());
+    std::vector<int> indices;
+    std::string line;
+    bool in_trace = false;
+    while (std::getline(in, line)) {
+        if (line.find("最近一次超预算") != std::string::npos) {
+            in_trace = true;
+        } else if (in_trace && line.rfind("  #", 0) == 0) {
+            indices.push_back(std::stoi(line.substr(3)));
+        } else {
+            in_trace = false;
+        }
+    }
+    return indices;
+}
+
+void testNoStallNoTrace() {
+    LoopProfiler profiler(1000.0, 4);
+    profiler.beginIteration();
+    profiler.endIteration();
+    CHECK_EQ(profiler.getStallCount(), 0u);
+    CHECK(stallTraceIndices(profiler).empty());
+}
+
+void testPartialRingInOrder() {
+    LoopProfiler profiler(1.0, 8);
+    runIterations(profiler, 3);
+    CHECK(profiler.getStallCount() >= 1u);
+    CHECK(stallTraceIndices(profiler) == std::vector<int>({0, 1, 2}));
+}
+
+void testWrappedRingInOrder() {
+    // 环形缓冲区已回绕：从最旧的一次开始，以卡顿的那次结束
+    LoopProfiler profiler(1.0, 4);
+    runIterations(profiler, 10);
+    CHECK(stallTraceIndices(profiler) == std::vector<int>({6, 7, 8, 9}));
+
+    runIterations(profiler, 3);
+    CHECK(stallTraceIndices(profiler) == std::vector<int>({9, 10, 11, 12}));
+}
+
+void testExactlyFullRing() {
+    LoopProfiler profiler(1.0, 4);
+    runIterations(profiler, 4);
+    CHECK(stallTraceIndices(profiler) == std::vector<int>({0, 1, 2, 3}));
+}
+
+void testZeroLengthKeepsOneIteration() {
+    LoopProfiler profiler(1.0, 0);
+    runIterations(profiler, 5);
+    CHECK(stallTraceIndices(profiler) == std::vector<int>({4}));
+}
+
+void testZeroBudgetDisablesTrace() {
+    LoopProfiler profiler(0.0, 4);
+    runIterations(profiler, 2);
+    CHECK_EQ(profiler.getStallCount(), 0u);
+    CHECK(stallTraceIndices(profiler).empty());
+}
+
+} // namespace
+
+int main() {
+    CycleClock::calibrate();
+    RUN_TEST(testNoStallNoTrace);
+    RUN_TEST(testPartialRingInOrder);
+    RUN_TEST(testWrappedRingInOrder);
+    RUN_TEST(testExactlyFullRing);
+    RUN_TEST(testZeroLengthKeepsOneIteration);
+    RUN_TEST(testZeroBudgetDisablesTrace);
+    return test_util::finish();
+}
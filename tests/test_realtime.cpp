@@ -0,0 +1,57 @@
+// 实时模式测试：主循环调度抖动的分桶统计
+#include "test_util.h"
+#include "realtime.h"
+
+namespace {
+
+void testBucketsByLatency() {
+    LoopJitterStats stats;
+    // 每个分桶取下边界和上边界前一个值
+    const int64_t samples[] = {0, 49, 50, 99, 100, 249, 250, 499, 500, 999, 1000, 1999, 2000, 4999, 5000, 100000};
+    for (int64_t us : samples) {
+        stats.record(us);
+    }
+    for (size_t i = 0; i < LoopJitterStats::BUCKET_COUNT; ++i) {
+        CHECK_EQ(stats.bucket(i), 2u);
+    }
+    CHECK_EQ(stats.bucket(LoopJitterStats::BUCKET_COUNT), 0u);
+    CHECK_EQ(stats.count(), 16u);
+    CHECK_EQ(stats.minUs(), 0);
+    CHECK_EQ(stats.maxUs(), 100000);
+}
+
+void testNegativeLatencyCountsAsZero() {
+    LoopJitterStats stats;
+    stats.record(120);
+    stats.record(-30);   // 时钟粒度导致提前唤醒
+    CHECK_EQ(stats.bucket(0), 1u);
+    CHECK_EQ(stats.bucket(2), 1u);
+    CHECK_EQ(stats.minUs(), 0);
+    CHECK_EQ(stats.maxUs(), 120);
+}
+
+void testResetClearsBuckets() {
+    LoopJitterStats stats;
+    stats.record(300);
+    stats.record(7000);
+    stats.reset();
+    CHECK_EQ(stats.count(), 0u);
+    CHECK_EQ(stats.maxUs(), 0);
+    for (size_t i = 0; i < LoopJitterStats::BUCKET_COUNT; ++i) {
+        CHECK_EQ(stats.bucket(i), 0u);
+    }
+
+    // 重置后最小值从第一个新样本开始
+    stats.record(800);
+    CHECK_EQ(stats.minUs(), 800);
+    CHECK_EQ(stats.bucket(4), 1u);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testBucketsByLatency);
+    RUN_TEST(testNegativeLatencyCountsAsZero);
+    RUN_TEST(testResetClearsBuckets);
+    return test_util::finish();
+}
@@ -0,0 +1,202 @@
+// 样本处理管线测试：滤波器、标定、参数钳位和批量/峰值回调
+#include "test_util.h"
+#include "sample_pipeline.h"
+#include <limits>
+#include <vector>
+
+namespace {
+
+struct Output {
+    int calls = 0;
+    float current = 0.0f;
+    float power = 0.0f;
+};
+
+SamplePipelineConfig makeConfig(FilterType filter, size_t window, size_t batch_size) {
+    SamplePipelineConfig config;
+    config.filter = filter;
+    config.window = window;
+    config.batch_size = batch_size;
+    return config;
+}
+
+void attach(SamplePipeline& pipeline, Output& output) {
+    pipeline.setOutputCallback([&output](float current, float power) {
+        ++output.calls;
+        output.current = current;
+        output.power = power;
+    });
+}
+
+void testNoneOutputsLatestSample() {
+    SamplePipeline pipeline(makeConfig(FilterType::NONE, 8, 64));
+    Output output;
+    attach(pipeline, output);
+
+    CHECK(!pipeline.flush());   // 没有样本时不输出
+    pipeline.push(1.0f, 10.0f);
+    pipeline.push(2.0f, 20.0f);
+    pipeline.push(3.0f, 30.0f);
+    CHECK_EQ(output.calls, 0);  // 未攒满一批且未 flush，不计算
+    CHECK(pipeline.flush());
+    CHECK_EQ(output.calls, 1);
+    CHECK_NEAR(output.current, 3.0f, 1e-6);
+    CHECK_NEAR(output.power, 30.0f, 1e-6);
+    CHECK(!pipeline.flush());   // 两次 flush 之间没有新样本
+    CHECK_EQ(output.calls, 1);
+}
+
+void testMovingAverageSpansBatches() {
+    SamplePipeline pipeline(makeConfig(FilterType::MOVING_AVERAGE, 4, 2));
+    Output output;
+    attach(pipeline, output);
+
+    // 窗口未满：只平均已有样本
+    pipeline.push(1.0f, 10.0f);
+    pipeline.push(2.0f, 20.0f);
+    pipeline.push(3.0f, 30.0f);
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.current, 2.0f, 1e-6);
+    CHECK_NEAR(output.power, 20.0f, 1e-5);
+
+    // 窗口满后只保留最近4个：3、4、5、6
+    for (int i = 4; i <= 6; ++i) {
+        pipeline.push(static_cast<float>(i), static_cast<float>(i * 10));
+    }
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.current, 4.5f, 1e-6);
+    CHECK_NEAR(output.power, 45.0f, 1e-5);
+
+    // 一批样本比窗口长时只取末尾的窗口长度
+    SamplePipeline wide(makeConfig(FilterType::MOVING_AVERAGE, 2, 8));
+    Output wideOutput;
+    attach(wide, wideOutput);
+    for (int i = 1; i <= 8; ++i) {
+        wide.push(static_cast<float>(i), 0.0f);
+    }
+    CHECK(wide.flush());
+    CHECK_NEAR(wideOutput.current, 7.5f, 1e-6);
+}
+
+void testMedianRejectsOutliers() {
+    SamplePipeline pipeline(makeConfig(FilterType::MEDIAN, 5, 3));
+    Output output;
+    attach(pipeline, output);
+
+    const float power[] = {1.0f, 100.0f, 2.0f, 3.0f, 50.0f};
+    for (float p : power) {
+        pipeline.push(p, p);
+    }
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.power, 3.0f, 1e-6);
+
+    // 窗口滑过后，最早的 1 和 100 被替换
+    pipeline.push(4.0f, 4.0f);
+    pipeline.push(5.0f, 5.0f);
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.power, 4.0f, 1e-6);   // 2、3、50、4、5
+}
+
+void testEmaStartsFromFirstSample() {
+    SamplePipelineConfig config = makeConfig(FilterType::EMA, 8, 1);
+    config.ema_alpha = 0.5f;
+    SamplePipeline pipeline(config);
+    Output output;
+    attach(pipeline, output);
+
+    pipeline.push(4.0f, 40.0f);
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.current, 4.0f, 1e-6);  // 第一个样本直接作为初值
+    pipeline.push(8.0f, 80.0f);
+    pipeline.push(0.0f, 0.0f);
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.current, 3.0f, 1e-6);  // 4 -> 6 -> 3
+    CHECK_NEAR(output.power, 30.0f, 1e-5);
+}
+
+void testCalibrationFeedsFilterPeakAndBatch() {
+    SamplePipelineConfig config = makeConfig(FilterType::MOVING_AVERAGE, 4, 4);
+    config.current_cal.gain = 2.0f;
+    config.current_cal.offset = 1.0f;
+    config.power_cal.gain = 0.5f;
+    config.power_cal.offset = -1.0f;
+    SamplePipeline pipeline(config);
+    Output output;
+    attach(pipeline, output);
+    std::vector<float> peaks;
+    std::vector<float> batch;
+    pipeline.setPeakCallback([&peaks](float peak) { peaks.push_back(peak); });
+    pipeline.setBatchCallback([&batch](const float* power, size_t count) {
+        batch.insert(batch.end(), power, power + count);
+    });
+
+    pipeline.push(1.0f, 2.0f);
+    pipeline.push(2.0f, 10.0f);
+    pipeline.push(3.0f, 4.0f);
+    pipeline.push(4.0f, 6.0f);
+    // 攒满一批立即处理：峰值和批量样本是标定后、未滤波的功率
+    CHECK(peaks == std::vector<float>({4.0f}));
+    CHECK(batch == std::vector<float>({0.0f, 4.0f, 1.0f, 2.0f}));
+    CHECK(pipeline.flush());
+    CHECK_NEAR(output.current, 6.0f, 1e-6);  // (3+5+7+9)/4
+    CHECK_NEAR(output.power, 1.75f, 1e-6);   // (0+4+1+2)/4
+    CHECK_EQ(peaks.size(), 1u);              // flush 时没有剩余样本，不再回调
+}
+
+void testClampsConfig() {
+    SamplePipelineConfig config = makeConfig(FilterType::MOVING_AVERAGE, 0, 0);
+    config.ema_alpha = 0.0f;
+    SamplePipeline zero(config);
+    CHECK_EQ(zero.getConfig().window, 1u);
+    CHECK_EQ(zero.getConfig().batch_size, 1u);
+    CHECK_NEAR(zero.getConfig().ema_alpha, 1.0f, 1e-6);
+
+    // 批量为1时每个样本立即处理
+    int batches = 0;
+    zero.setBatchCallback([&batches](const float*, size_t count) {
+        CHECK_EQ(count, 1u);
+        ++batches;
+    });
+    zero.push(1.0f, 1.0f);
+    zero.push(2.0f, 2.0f);
+    CHECK_EQ(batches, 2);
+
+    config.window = SamplePipelineConfig::MAX_WINDOW + 1;
+    config.ema_alpha = 1.5f;
+    CHECK_EQ(SamplePipeline(config).getConfig().window, SamplePipelineConfig::MAX_WINDOW);
+    CHECK_NEAR(SamplePipeline(config).getConfig().ema_alpha, 1.0f, 1e-6);
+    config.ema_alpha = std::numeric_limits<float>::quiet_NaN();
+    CHECK_NEAR(SamplePipeline(config).getConfig().ema_alpha, 1.0f, 1e-6);
+    config.ema_alpha = 0.3f;
+    CHECK_NEAR(SamplePipeline(config).getConfig().ema_alpha, 0.3f, 1e-6);
+}
+
+void testParsesFilterAndCalibration() {
+    FilterType type = FilterType::NONE;
+    CHECK(SamplePipeline::parseFilterType("median", type) && type == FilterType::MEDIAN);
+    CHECK(SamplePipeline::parseFilterType("ema", type) && type == FilterType::EMA);
+    CHECK(!SamplePipeline::parseFilterType("avg", type));
+    CHECK(type == FilterType::EMA);
+
+    Calibration cal;
+    CHECK(SamplePipeline::parseCalibration("1.5,-0.25", cal));
+    CHECK_NEAR(cal.gain, 1.5f, 1e-6);
+    CHECK_NEAR(cal.offset, -0.25f, 1e-6);
+    CHECK(!SamplePipeline::parseCalibration("1.5", cal));
+    CHECK(!SamplePipeline::parseCalibration("x,1", cal));
+    CHECK(!SamplePipeline::parseCalibration("2,1y", cal));
+    CHECK_NEAR(cal.gain, 1.5f, 1e-6);   // 解析失败不修改参数
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testNoneOutputsLatestSample);
+    RUN_TEST(testMovingAverageSpansBatches);
+    RUN_TEST(testMedianRejectsOutliers);
+    RUN_TEST(testEmaStartsFromFirstSample);
+    RUN_TEST(testCalibrationFeedsFilterPeakAndBatch);
+    RUN_TEST(testClampsConfig);
+    RUN_TEST(testParsesFilterAndCalibration);
+    return test_util::finish();
+}
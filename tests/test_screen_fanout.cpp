@@ -0,0 +1,136 @@
+// 多串口屏广播传输层测试：用内存传输层模拟多块屏幕
+#include "test_util.h"
+#include "test_frames.h"
+#include "memory_transport.h"
+#include "screen_fanout_transport.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+struct Screens {
+    std::vector<MemoryTransport*> ports;
+    std::unique_ptr<ScreenFanoutTransport> fanout;
+    int refreshes = 0;
+
+    Screens(size_t count, size_t capacity) {
+        std::vector<std::unique_ptr<Transport>> transports;
+        for (size_t i = 0; i < count; ++i) {
+            auto port = std::make_unique<MemoryTransport>("screen" + std::to_string(i));
+            ports.push_back(port.get());
+            transports.push_back(std::move(port));
+        }
+        fanout = std::make_unique<ScreenFanoutTransport>(std::move(transports), capacity);
+        fanout->setRefreshCallback([this]() { ++refreshes; });
+    }
+};
+
+int writeCommand(Transport& transport, const std::string& text) {
+    std::vector<uint8_t> bytes = makeScreenCommand(text);
+    return transport.write(bytes.data(), bytes.size());
+}
+
+void testBroadcastsEachCommandToAllScreens() {
+    Screens screens(3, 256);
+    CHECK(screens.fanout->open());
+
+    CHECK_EQ(writeCommand(*screens.fanout, "t2.txt=\"1.500\""), 17);
+    CHECK_EQ(writeCommand(*screens.fanout, "t3.txt=\"12.000\""), 18);
+    std::vector<uint8_t> expected = makeScreenCommand("t2.txt=\"1.500\"");
+    append(expected, makeScreenCommand("t3.txt=\"12.000\""));
+    for (MemoryTransport* port : screens.ports) {
+        CHECK(port->takeTx() == expected);
+    }
+    CHECK_EQ(screens.fanout->getPortStats(0).bytes_written, 35u);
+    CHECK_EQ(screens.refreshes, 0);
+}
+
+void testSlowScreenOnlyDelaysItself() {
+    Screens screens(2, 64);
+    CHECK(screens.fanout->open());
+    screens.ports[1]->setTxCapacity(0);     // 第二块屏幕的发送缓冲区已满
+
+    // 写入超过共享缓冲区容量的命令：快屏全部收到，慢屏积压溢出后跳到最新位置并请求刷新
+    std::vector<uint8_t> fast_expected;
+    for (int i = 0; i < 6; ++i) {
+        std::string cmd = "t2.txt=\"" + std::to_string(i) + ".000\"";
+        CHECK_EQ(writeCommand(*screens.fanout, cmd), 17);
+        append(fast_expected, makeScreenCommand(cmd));
+    }
+    CHECK(screens.ports[0]->takeTx() == fast_expected);
+
+    ScreenFanoutTransport::PortStats slow = screens.fanout->getPortStats(1);
+    CHECK(slow.connected);
+    CHECK(slow.overflows >= 1);
+    CHECK(slow.backlog <= 64);
+    CHECK(slow.bytes_dropped > 0);
+    CHECK(screens.refreshes >= 1);
+    CHECK_EQ(screens.fanout->getPortStats(0).overflows, 0u);
+
+    // 慢屏恢复后从命令边界开始补发积压，最后一条是最新的命令
+    screens.ports[1]->setTxCapacity(SIZE_MAX);
+    screens.fanout->drain();
+    std::vector<uint8_t> slow_tx = screens.ports[1]->takeTx();
+    std::vector<uint8_t> last = makeScreenCommand("t2.txt=\"5.000\"");
+    CHECK(!slow_tx.empty() && slow_tx.size() % last.size() == 0);
+    CHECK(slow_tx.size() >= last.size() && std::equal(last.begin(), last.end(), slow_tx.end() - last.size()));
+    CHECK_EQ(screens.fanout->getPortStats(1).backlog, 0u);
+}
+
+void testEventsFromScreensDoNotInterleave() {
+    Screens screens(2, 256);
+    CHECK(screens.fanout->open());
+
+    // 第一块屏幕只到达半帧（前面有噪声），第二块屏幕到达完整一帧
+    std::vector<uint8_t> first = makeScreenEvent(0x02, 0x05, 0x01);
+    std::vector<uint8_t> second = makeScreenEvent(0x01, 0x02, 0x01);
+    const uint8_t noise = 0x00;
+    screens.ports[0]->injectRx(&noise, 1);
+    screens.ports[0]->injectRx(first.data(), 3);
+    screens.ports[1]->injectRx(second.data(), second.size());
+
+    uint8_t frame[7];
+    CHECK_EQ(screens.fanout->read(frame, sizeof(frame), 10), 7);
+    CHECK(std::vector<uint8_t>(frame, frame + 7) == second);
+    CHECK_EQ(screens.fanout->getLastEventSource(), 1u);
+
+    // 半帧补齐后作为完整一帧读出
+    screens.ports[0]->injectRx(first.data() + 3, first.size() - 3);
+    CHECK_EQ(screens.fanout->read(frame, sizeof(frame), 10), 7);
+    CHECK(std::vector<uint8_t>(frame, frame + 7) == first);
+    CHECK_EQ(screens.fanout->getLastEventSource(), 0u);
+    CHECK_EQ(screens.fanout->getPortStats(0).events, 1u);
+}
+
+void testDisconnectedScreenReconnectsInBackground() {
+    Screens screens(2, 256);
+    CHECK(screens.fanout->open());
+
+    // 第一块屏幕断开：写入仍然成功，只有另一块屏幕收到
+    screens.ports[0]->close();
+    CHECK_EQ(writeCommand(*screens.fanout, "t4.txt=\"9.000\""), 17);
+    CHECK(!screens.fanout->getPortStats(0).connected);
+    CHECK(screens.ports[1]->takeTx() == makeScreenCommand("t4.txt=\"9.000\""));
+
+    // 退避时间到达后重新打开，并请求全量刷新
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    uint8_t byte;
+    CHECK_EQ(screens.fanout->readNonblocking(&byte, 1), 0);
+    CHECK(screens.fanout->getPortStats(0).connected);
+    CHECK_EQ(screens.refreshes, 1);
+
+    // 全部屏幕断开时向协议报告错误
+    screens.ports[0]->close();
+    screens.ports[1]->close();
+    CHECK_EQ(writeCommand(*screens.fanout, "t4.txt=\"9.000\""), -1);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testBroadcastsEachCommandToAllScreens);
+    RUN_TEST(testSlowScreenOnlyDelaysItself);
+    RUN_TEST(testEventsFromScreensDoNotInterleave);
+    RUN_TEST(testDisconnectedScreenReconnectsInBackground);
+    return test_util::finish();
+}
@@ -0,0 +1,242 @@
+// 串口屏发送调度测试：优先级、覆盖、预算、统计，以及内核发送缓冲区写满时的部分写
+#include "test_util.h"
+#include "test_frames.h"
+#include "memory_transport.h"
+#include "screen_tx_scheduler.h"
+#include "serial_screen_protocol.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+using Clock = ScreenTxScheduler::Clock;
+
+Clock::time_point after(Clock::time_point base, int ms) {
+    return base + std::chrono::milliseconds(ms);
+}
+
+std::string take(ScreenTxScheduler& tx, Clock::time_point now) {
+    std::string_view cmd;
+    return tx.next(cmd, now) ? std::string(cmd) : std::string();
+}
+
+void testInteractiveGoesFirst() {
+    ScreenTxScheduler tx(960.0);
+    Clock::time_point t0 = Clock::now();
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", "t2.txt=\"1.000\"", t0);
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t3.txt", "t3.txt=\"2.000\"", t0);
+    tx.enqueue(ScreenTxScheduler::PRIORITY_INTERACTIVE, "t0.txt", "t0.txt=\"9.000\"", after(t0, 1));
+
+    CHECK(take(tx, after(t0, 2)) == "t0.txt=\"9.000\"");
+    CHECK(take(tx, after(t0, 2)) == "t2.txt=\"1.000\"");   // 周期类按入队先后
+    CHECK(take(tx, after(t0, 2)) == "t3.txt=\"2.000\"");
+    CHECK(take(tx, after(t0, 2)).empty());
+    CHECK(!tx.hasPending(ScreenTxScheduler::PRIORITY_PERIODIC));
+}
+
+void testNewValueSupersedesQueuedValue() {
+    ScreenTxScheduler tx(960.0);
+    Clock::time_point t0 = Clock::now();
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", "t2.txt=\"1.000\"", t0);
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t3.txt", "t3.txt=\"5.000\"", after(t0, 5));
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", "t2.txt=\"2.000\"", after(t0, 10));
+
+    // 只发送最新值，排队位置和延迟从旧值入队时算起
+    CHECK(take(tx, after(t0, 20)) == "t2.txt=\"2.000\"");
+    CHECK(take(tx, after(t0, 20)) == "t3.txt=\"5.000\"");
+    CHECK(take(tx, after(t0, 20)).empty());
+    const ScreenTxScheduler::ClassStats& stats = tx.getStats(ScreenTxScheduler::PRIORITY_PERIODIC);
+    CHECK_EQ(stats.queued, 3u);
+    CHECK_EQ(stats.superseded, 1u);
+    CHECK_EQ(stats.sent, 2u);
+    CHECK_NEAR(stats.delay_max_ms, 20.0, 1e-6);
+}
+
+void testPeriodicWaitsForBudget() {
+    // 340 B/s：桶容量为一条最长命令（67字节），每条17字节的命令最多连发3条
+    ScreenTxScheduler tx(340.0);
+    Clock::time_point t0 = Clock::now();
+    const char* keys[] = {"t2.txt", "t3.txt", "t4.txt", "t5.txt"};
+    for (const char* key : keys) {
+        tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, key, std::string(key) + "=\"1.000\"", t0);
+    }
+    CHECK(!take(tx, t0).empty());
+    CHECK(!take(tx, t0).empty());
+    CHECK(!take(tx, t0).empty());
+    CHECK(take(tx, t0).empty());
+    CHECK(tx.hasPending(ScreenTxScheduler::PRIORITY_PERIODIC));
+
+    // 50ms 后补充了17字节的令牌
+    CHECK(take(tx, after(t0, 50)) == "t5.txt=\"1.000\"");
+}
+
+void testInteractiveBorrowsAgainstBudget() {
+    ScreenTxScheduler tx(340.0);
+    Clock::time_point t0 = Clock::now();
+    // 交互类命令不等待令牌，但透支会推迟之后的周期类命令
+    for (int i = 0; i < 8; ++i) {
+        char key[16];
+        char cmd[32];
+        std::snprintf(key, sizeof(key), "t%d.txt", i);
+        std::snprintf(cmd, sizeof(cmd), "%s=\"1.000\"", key);
+        tx.enqueue(ScreenTxScheduler::PRIORITY_INTERACTIVE, key, cmd, t0);
+    }
+    for (int i = 0; i < 8; ++i) {
+        CHECK(!take(tx, t0).empty());
+    }
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t9.txt", "t9.txt=\"1.000\"", t0);
+    CHECK(take(tx, after(t0, 100)).empty());
+    // 透支 136-67=69 字节，还清并攒够17字节约需 254ms
+    CHECK(take(tx, after(t0, 300)) == "t9.txt=\"1.000\"");
+}
+
+void testDropsWhenSlotsFull() {
+    ScreenTxScheduler tx(960.0);
+    Clock::time_point t0 = Clock::now();
+    for (size_t i = 0; i <= ScreenTxScheduler::SLOT_COUNT; ++i) {
+        char key[16];
+        char cmd[32];
+        std::snprintf(key, sizeof(key), "k%zu", i);
+        std::snprintf(cmd, sizeof(cmd), "%s=1", key);
+        tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, key, cmd, t0);
+    }
+    CHECK_EQ(tx.getStats(ScreenTxScheduler::PRIORITY_PERIODIC).dropped, 1u);
+
+    // 断线时清空，之后可以重新入队
+    tx.clear();
+    CHECK(!tx.hasPending(ScreenTxScheduler::PRIORITY_PERIODIC));
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", "t2.txt=\"1.000\"", t0);
+    CHECK(take(tx, after(t0, 100)) == "t2.txt=\"1.000\"");
+}
+
+void testWindowReportsIncrements() {
+    ScreenTxScheduler tx(960.0);
+    Clock::time_point t0 = Clock::now();
+    tx.takeWindow(t0);
+    tx.enqueue(ScreenTxScheduler::PRIORITY_INTERACTIVE, "t0.txt", "t0.txt=\"1.000\"", t0);
+    tx.enqueue(ScreenTxScheduler::PRIORITY_PERIODIC, "t2.txt", "t2.txt=\"1.000\"", t0);
+    take(tx, after(t0, 4));
+    take(tx, after(t0, 10));
+
+    ScreenTxScheduler::Window window = tx.takeWindow(after(t0, 1000));
+    CHECK_NEAR(window.seconds, 1.0, 1e-6);
+    CHECK_EQ(window.classes[ScreenTxScheduler::PRIORITY_INTERACTIVE].sent, 1u);
+    CHECK_EQ(window.classes[ScreenTxScheduler::PRIORITY_INTERACTIVE].bytes, 17u);
+    CHECK_NEAR(window.classes[ScreenTxScheduler::PRIORITY_INTERACTIVE].averageDelayMs(), 4.0, 1e-6);
+    CHECK_NEAR(window.classes[ScreenTxScheduler::PRIORITY_PERIODIC].averageDelayMs(), 10.0, 1e-6);
+
+    window = tx.takeWindow(after(t0, 2000));
+    CHECK_EQ(window.classes[ScreenTxScheduler::PRIORITY_PERIODIC].sent, 0u);
+}
+
+// 把写出的字节按结束符切分，检查每段都是完整的命令
+bool allCommandsComplete(const std::vector<uint8_t>& bytes, size_t& commands) {
+    commands = 0;
+    size_t start = 0;
+    for (size_t i = 0; i + 2 < bytes.size(); ++i) {
+        if (bytes[i] == 0xFF && bytes[i + 1] == 0xFF && bytes[i + 2] == 0xFF) {
+            std::string cmd(bytes.begin() + static_cast<std::ptrdiff_t>(start),
+                            bytes.begin() + static_cast<std::ptrdiff_t>(i));
+            if (cmd.empty() || cmd[0] != 't' || cmd.find("=\"") == std::string::npos || cmd.back() != '"') {
+                return false;
+            }
+            ++commands;
+            start = i + 3;
+            i += 2;
+        }
+    }
+    return start == bytes.size();
+}
+
+void testProtocolKeepsPartialWrites() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport), 115200);
+    CHECK_NEAR(screen.getTxScheduler().getBudget(), 11520.0, 1e-6);
+    CHECK(screen.open());
+    std::vector<uint8_t> sent = memory->takeTx();
+
+    // 内核发送缓冲区只剩10字节：命令写出一部分，其余留待下次
+    memory->setTxCapacity(10);
+    screen.sendFloat("t5.txt", 1.0f);
+    CHECK_EQ(memory->takeTx().size(), 10u);
+    CHECK_EQ(screen.getTxPendingBytes(), 7u);
+    CHECK(screen.isConnected());
+
+    // 设备每轮只取走10字节：先补完上一条命令，新命令排在后面，命令之间不会交错
+    std::vector<uint8_t> stream = makeScreenCommand("t5.txt=\"1.000\"");
+    stream.erase(stream.begin() + 10, stream.end());
+    for (int round = 0; round < 20; ++round) {
+        screen.updateCurrentPower(1.5f, 12.0f);
+        screen.sendPeriodicData();
+        append(stream, memory->takeTx());
+    }
+    CHECK(screen.isConnected());
+    memory->setTxCapacity(SIZE_MAX);
+    screen.sendPeriodicData();
+    append(stream, memory->takeTx());
+    CHECK_EQ(screen.getTxPendingBytes(), 0u);
+
+    size_t commands = 0;
+    CHECK(allCommandsComplete(stream, commands));
+    CHECK(commands >= 3);
+}
+
+void testProtocolDisconnectDropsPendingBytes() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport));
+    CHECK(screen.open());
+    memory->takeTx();
+
+    memory->setTxCapacity(5);
+    screen.sendFloat("t5.txt", 1.0f);
+    CHECK_EQ(screen.getTxPendingBytes(), 12u);
+
+    // 写入错误按断线处理，没写完的字节随之丢弃
+    memory->close();
+    screen.sendPeriodicData();
+    CHECK(!screen.isConnected());
+    CHECK_EQ(screen.getTxPendingBytes(), 0u);
+}
+
+void testExternalTransmitHandsOutCommands() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport), 115200);
+    CHECK(screen.open());
+    memory->takeTx();
+
+    // 外部写出模式：命令不写串口，由写协程逐条取走
+    screen.setExternalTransmit(true);
+    screen.updateCurrentPower(1.5f, 12.0f);
+    screen.sendPeriodicData();
+    CHECK(memory->takeTx().empty());
+
+    std::vector<uint8_t> stream;
+    uint8_t chunk[8];
+    size_t n;
+    while ((n = screen.takeTxPending(chunk, sizeof(chunk))) > 0) {
+        stream.insert(stream.end(), chunk, chunk + n);
+    }
+    CHECK_EQ(screen.getTxPendingBytes(), 0u);
+    size_t commands = 0;
+    CHECK(allCommandsComplete(stream, commands));
+    CHECK(commands >= 2);
+    CHECK(memory->takeTx().empty());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testInteractiveGoesFirst);
+    RUN_TEST(testNewValueSupersedesQueuedValue);
+    RUN_TEST(testPeriodicWaitsForBudget);
+    RUN_TEST(testInteractiveBorrowsAgainstBudget);
+    RUN_TEST(testDropsWhenSlotsFull);
+    RUN_TEST(testWindowReportsIncrements);
+    RUN_TEST(testProtocolKeepsPartialWrites);
+    RUN_TEST(testProtocolDisconnectDropsPendingBytes);
+    RUN_TEST(testExternalTransmitHandsOutCommands);
+    return test_util::finish();
+}
@@ -0,0 +1,163 @@
+// 功率波形流测试：抽取缩放、预算、addt 透传握手
+#include "test_util.h"
+#include "test_frames.h"
+#include "memory_transport.h"
+#include "screen_waveform.h"
+#include "serial_screen_protocol.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// 预算足够大，只要等待几毫秒令牌桶就够一批
+WaveformConfig fastConfig() {
+    WaveformConfig config;
+    config.full_scale = 100.0f;
+    config.height = 200;
+    config.batch_points = 4;
+    config.budget_bytes_per_s = 1e6;
+    config.handshake_timeout_ms = 20;
+    return config;
+}
+
+void waitForBudget() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+void pushSamples(WaveformStream& stream, std::initializer_list<float> samples) {
+    for (float power : samples) {
+        stream.push(power);
+    }
+}
+
+void testDecimatesAndScalesPoints() {
+    WaveformConfig config = fastConfig();
+    config.decimation = 2;
+    WaveformStream stream(config);
+
+    // 每两个样本取平均：25、50、100（满量程）、负值截到0
+    pushSamples(stream, {20.0f, 30.0f, 40.0f, 60.0f, 150.0f, 50.0f, -5.0f, -5.0f});
+    waitForBudget();
+    CHECK(stream.readyToSend());
+
+    char cmd[32];
+    size_t length = stream.beginTransfer(cmd, sizeof(cmd));
+    CHECK(std::string(cmd, length) == "addt 1,0,4");
+    const std::vector<uint8_t>& points = stream.onReady();
+    CHECK(points == std::vector<uint8_t>({50, 100, 200, 0}));
+    CHECK_EQ(stream.getStats().samples, 8u);
+}
+
+void testWaitsForFullBatchAndBudget() {
+    WaveformConfig config = fastConfig();
+    config.budget_bytes_per_s = 1.0;    // 一秒只够1字节
+    WaveformStream stream(config);
+
+    pushSamples(stream, {10.0f, 10.0f, 10.0f});
+    waitForBudget();
+    CHECK(!stream.readyToSend());       // 不够一批
+    stream.push(10.0f);
+    CHECK(!stream.readyToSend());       // 够一批但预算不足
+}
+
+void testDropsOldestWhenBacklogFull() {
+    WaveformStream stream(fastConfig(), 4);
+    pushSamples(stream, {10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f});
+    CHECK_EQ(stream.getStats().points_dropped, 2u);
+
+    waitForBudget();
+    CHECK(stream.readyToSend());
+    char cmd[32];
+    CHECK(stream.beginTransfer(cmd, sizeof(cmd)) > 0);
+    CHECK(stream.onReady() == std::vector<uint8_t>({60, 80, 100, 120}));
+}
+
+void testHandshakeSendsPointsOnce() {
+    WaveformStream stream(fastConfig());
+    pushSamples(stream, {10.0f, 20.0f, 30.0f, 40.0f});
+
+    // 没有进行中的传输：0xFE 不返回任何数据
+    CHECK(stream.onReady().empty());
+
+    waitForBudget();
+    CHECK(stream.readyToSend());
+    char cmd[32];
+    CHECK(stream.beginTransfer(cmd, sizeof(cmd)) > 0);
+    CHECK(stream.busy());
+    CHECK(!stream.readyToSend());
+    CHECK_EQ(stream.onReady().size(), 4u);
+
+    // 重复的 0xFE 不能让同一批点再发一次
+    CHECK(stream.onReady().empty());
+    stream.onDone();
+    CHECK(!stream.busy());
+    CHECK_EQ(stream.getStats().points_sent, 4u);
+    CHECK_EQ(stream.getStats().transfers, 1u);
+
+    // 完成后迟到的 0xFE 同样不返回数据
+    CHECK(stream.onReady().empty());
+}
+
+void testHandshakeTimeoutDropsBatch() {
+    WaveformStream stream(fastConfig());
+    pushSamples(stream, {10.0f, 20.0f, 30.0f, 40.0f});
+    waitForBudget();
+    CHECK(stream.readyToSend());
+    char cmd[32];
+    CHECK(stream.beginTransfer(cmd, sizeof(cmd)) > 0);
+
+    CHECK(!stream.checkTimeout());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(stream.checkTimeout());
+    CHECK(!stream.busy());
+    CHECK_EQ(stream.getStats().timeouts, 1u);
+    CHECK_EQ(stream.getStats().points_dropped, 4u);
+    CHECK(stream.onReady().empty());    // 超时后才到达的 0xFE 不再写点数据
+}
+
+void testProtocolWritesPointsOnlyOnReady() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport));
+    CHECK(screen.open());
+    screen.enableWaveform(fastConfig());
+
+    const float samples[4] = {10.0f, 20.0f, 30.0f, 40.0f};
+    screen.pushWaveformSamples(samples, 4);
+    waitForBudget();
+    memory->takeTx();
+
+    // 定期发送：数值命令之后发出 addt 命令
+    screen.sendPeriodicData();
+    std::vector<uint8_t> tx = memory->takeTx();
+    std::vector<uint8_t> addt = makeScreenCommand("addt 1,0,4");
+    CHECK(tx.size() >= addt.size() && std::equal(addt.begin(), addt.end(), tx.end() - addt.size()));
+    CHECK(screen.getWaveform()->busy());
+
+    const uint8_t ready[4] = {0xFE, 0xFF, 0xFF, 0xFF};
+    const uint8_t done[4] = {0xFD, 0xFF, 0xFF, 0xFF};
+    screen.feed(ready, sizeof(ready));
+    CHECK(memory->takeTx() == std::vector<uint8_t>({20, 40, 60, 80}));
+
+    // 重复的应答不会再写一次点数据
+    screen.feed(ready, sizeof(ready));
+    CHECK(memory->takeTx().empty());
+
+    screen.feed(done, sizeof(done));
+    CHECK(!screen.getWaveform()->busy());
+    screen.feed(ready, sizeof(ready));
+    CHECK(memory->takeTx().empty());
+    CHECK_EQ(screen.getWaveform()->getStats().points_sent, 4u);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testDecimatesAndScalesPoints);
+    RUN_TEST(testWaitsForFullBatchAndBudget);
+    RUN_TEST(testDropsOldestWhenBacklogFull);
+    RUN_TEST(testHandshakeSendsPointsOnce);
+    RUN_TEST(testHandshakeTimeoutDropsBatch);
+    RUN_TEST(testProtocolWritesPointsOnlyOnReady);
+    return test_util::finish();
+}
@@ -0,0 +1,179 @@
+// 串口屏模拟器测试：经伪终端发送的命令、addt 透传应答、脚本按键和格式错误统计
+#include "test_util.h"
+#include "test_frames.h"
+#include "fd_transport.h"
+#include "serial_screen_emulator.h"
+#include "serial_screen_protocol.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+SerialSettings rawSettings() {
+    SerialSettings settings;
+    settings.read_write = true;
+    return settings;
+}
+
+void sendRaw(Transport& port, const std::vector<uint8_t>& bytes) {
+    CHECK_EQ(port.write(bytes.data(), bytes.size()), static_cast<int>(bytes.size()));
+}
+
+// 读取模拟器的应答；超时返回已读到的部分
+std::vector<uint8_t> readReply(Transport& port, size_t n, unsigned timeout_ms = 500) {
+    std::vector<uint8_t> reply(n);
+    int got = port.read(reply.data(), n, timeout_ms);
+    reply.resize(got > 0 ? static_cast<size_t>(got) : 0);
+    return reply;
+}
+
+void testRecordsCommandsFromPty() {
+    SerialScreenEmulator emulator;
+    CHECK(emulator.open());
+    TermiosTransport port(emulator.getSlavePath(), rawSettings());
+    CHECK(port.open());
+
+    std::vector<uint8_t> bytes = makeScreenCommand("t0.txt=\"1.50\"");
+    append(bytes, makeScreenCommand("n0.val=12"));
+    append(bytes, makeScreenCommand("page 0"));
+    sendRaw(port, bytes);
+    for (int i = 0; i < 20 && emulator.getStats().bytes < bytes.size(); ++i) {
+        emulator.poll(20);
+    }
+
+    const SerialScreenEmulator::Stats& stats = emulator.getStats();
+    CHECK_EQ(stats.bytes, static_cast<uint64_t>(bytes.size()));
+    CHECK_EQ(stats.commands, 2u);
+    CHECK_EQ(stats.instructions, 1u);
+    CHECK_EQ(stats.malformed, 0u);
+    CHECK(emulator.getWidgets().at("t0.txt") == "1.50");   // 去掉引号
+    CHECK(emulator.getWidgets().at("n0.val") == "12");
+}
+
+void testRepliesToAddtTransfer() {
+    SerialScreenEmulator emulator;
+    CHECK(emulator.open());
+    TermiosTransport port(emulator.getSlavePath(), rawSettings());
+    CHECK(port.open());
+
+    // addt 命令：应答 FE FF FF FF 进入透传
+    sendRaw(port, makeScreenCommand("addt 1,0,3"));
+    emulator.poll(100);
+    const std::vector<uint8_t> ready = {0xFE, 0xFF, 0xFF, 0xFF};
+    CHECK(readReply(port, 4) == ready);
+
+    // 透传中的点可以是任意字节（包括 FF），收满后应答 FD FF FF FF
+    sendRaw(port, {0x10, 0xFF, 0x00});
+    for (int i = 0; i < 20 && emulator.getStats().waveform_points < 3; ++i) {
+        emulator.poll(20);
+    }
+    const std::vector<uint8_t> done = {0xFD, 0xFF, 0xFF, 0xFF};
+    CHECK(readReply(port, 4) == done);
+    CHECK_EQ(emulator.getStats().waveform_transfers, 1u);
+    CHECK_EQ(emulator.getStats().waveform_points, 3u);
+    CHECK_EQ(emulator.getStats().instructions, 1u);
+
+    // 透传结束后恢复命令解析；点数为0或多余参数的 addt 不应答
+    sendRaw(port, makeScreenCommand("addt 1,0,0"));
+    sendRaw(port, makeScreenCommand("addt 1,0,2,9"));
+    sendRaw(port, makeScreenCommand("t1.txt=\"ok\""));
+    for (int i = 0; i < 20 && emulator.getStats().commands < 1; ++i) {
+        emulator.poll(20);
+    }
+    CHECK(emulator.getWidgets().at("t1.txt") == "ok");
+    CHECK(readReply(port, 4, 50).empty());
+    CHECK_EQ(emulator.getStats().waveform_transfers, 1u);
+}
+
+void testWaveformHandshakeWithProtocol() {
+    SerialScreenEmulator emulator;
+    CHECK(emulator.open());
+    SerialScreenProtocol screen(std::make_unique<TermiosTransport>(emulator.getSlavePath(), rawSettings()));
+    CHECK(screen.open());
+
+    WaveformConfig config;
+    config.full_scale = 100.0f;
+    config.height = 200;
+    config.batch_points = 4;
+    config.budget_bytes_per_s = 1e6;
+    screen.enableWaveform(config);
+    const float power[] = {0.0f, 25.0f, 50.0f, 100.0f};
+    screen.pushWaveformSamples(power, 4);
+
+    // 屏幕端应答 FE 后协议写出点数据，收满后应答 FD，整个握手经由真实的伪终端完成
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (emulator.getStats().waveform_transfers == 0 && std::chrono::steady_clock::now() < deadline) {
+        screen.sendPeriodicData();
+        emulator.poll(5);
+        screen.checkForSerialScreenData();
+    }
+    CHECK_EQ(emulator.getStats().waveform_transfers, 1u);
+    CHECK_EQ(emulator.getStats().waveform_points, 4u);
+    CHECK_EQ(emulator.getStats().malformed, 0u);
+}
+
+void testScriptInjectsEventAndTimesResponse() {
+    SerialScreenEmulator emulator;
+    CHECK(emulator.open());
+    TermiosTransport port(emulator.getSlavePath(), rawSettings());
+    CHECK(port.open());
+
+    ScreenScriptStep step;
+    step.delay_ms = 0;
+    step.page = 0x01;
+    step.control = 0x05;
+    step.event = 0x01;
+    step.expect_widget = "t0.txt";
+    emulator.setScript({step}, false);
+    emulator.poll(0);
+    CHECK_EQ(emulator.getStats().events_injected, 1u);
+    CHECK(readReply(port, 7) == makeScreenEvent(0x01, 0x05, 0x01));
+
+    // 无关控件不算响应，期望控件的赋值结束等待并记录延迟
+    sendRaw(port, makeScreenCommand("t1.txt=\"a\""));
+    sendRaw(port, makeScreenCommand("t0.txt=\"b\""));
+    for (int i = 0; i < 20 && emulator.getStats().commands < 2; ++i) {
+        emulator.poll(20);
+    }
+    const SerialScreenEmulator::Stats& stats = emulator.getStats();
+    CHECK_EQ(stats.responses, 1u);
+    CHECK_EQ(stats.response_timeouts, 0u);
+    CHECK(stats.latency_max_ms >= stats.latency_min_ms);
+
+    // 脚本不循环时只注入一次
+    emulator.poll(0);
+    CHECK_EQ(emulator.getStats().events_injected, 1u);
+}
+
+void testCountsMalformedCommands() {
+    SerialScreenEmulator emulator;   // 不打开伪终端，直接喂入字节
+    std::vector<uint8_t> bytes = makeScreenCommand("");        // 空命令
+    append(bytes, makeScreenCommand("t0.txt=\"abc"));          // 引号不匹配
+    append(bytes, makeScreenCommand("=1"));                    // 缺少控件名
+    append(bytes, makeScreenCommand("t0 x=1"));                // 控件名含空格
+    append(bytes, makeScreenCommand("t0.txt="));               // 缺少值
+    append(bytes, makeScreenCommand("12abc"));                 // 不是指令
+    append(bytes, makeScreenCommand("t0\x01=1"));              // 控制字符
+    emulator.feed(bytes.data(), bytes.size());
+    CHECK_EQ(emulator.getStats().malformed, 7u);
+    CHECK_EQ(emulator.getStats().commands, 0u);
+
+    // 长时间没有结束符的垃圾数据被丢弃，之后的命令仍能解析
+    std::vector<uint8_t> garbage(1100, 'x');
+    emulator.feed(garbage.data(), garbage.size());
+    CHECK_EQ(emulator.getStats().malformed, 8u);
+    std::vector<uint8_t> command = makeScreenCommand("t2.txt=\"ok\"");
+    emulator.feed(command.data(), command.size());
+    CHECK_EQ(emulator.getStats().commands, 1u);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testRecordsCommandsFromPty);
+    RUN_TEST(testRepliesToAddtTransfer);
+    RUN_TEST(testWaveformHandshakeWithProtocol);
+    RUN_TEST(testScriptInjectsEventAndTimesResponse);
+    RUN_TEST(testCountsMalformedCommands);
+    return test_util::finish();
+}
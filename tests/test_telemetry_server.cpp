@@ -0,0 +1,200 @@
+// 遥测服务测试：本地 Unix 套接字订阅者，覆盖批量发送、队列满丢弃最旧记录和卡死断开
+#include "test_util.h"
+#include "telemetry_server.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+std::string socketPath() {
+    return "/tmp/uart_test_telemetry_" + std::to_string(getpid()) + ".sock";
+}
+
+int connectClient(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool readExact(int fd, uint8_t* buffer, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = recv(fd, buffer + got, n - got, 0);
+        if (r <= 0) {
+            return false;
+        }
+        got += static_cast<size_t>(r);
+    }
+    return true;
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+// 读取一个批量帧，返回记录中的功率值（样本）或事件枚举值（按键事件）
+std::vector<float> readFrame(int fd, std::vector<uint8_t>* types = nullptr) {
+    std::vector<float> values;
+    uint8_t header[TELEMETRY_FRAME_HEADER_SIZE];
+    if (!readExact(fd, header, sizeof(header))) {
+        return values;
+    }
+    uint32_t payload = getU32(header);
+    size_t count = static_cast<size_t>(header[4]) | static_cast<size_t>(header[5]) << 8;
+    CHECK_EQ(payload, static_cast<uint32_t>(2 + count * TELEMETRY_RECORD_SIZE));
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t record[TELEMETRY_RECORD_SIZE];
+        if (!readExact(fd, record, sizeof(record))) {
+            break;
+        }
+        if (types) {
+            types->push_back(record[0]);
+        }
+        if (record[0] == TELEMETRY_SAMPLE) {
+            float power;
+            std::memcpy(&power, record + 16, sizeof(float));
+            values.push_back(power);
+        } else {
+            int32_t id;
+            std::memcpy(&id, record + 12, sizeof(id));
+            values.push_back(static_cast<float>(id));
+        }
+    }
+    return values;
+}
+
+void testBatchesRecordsPerClient() {
+    TelemetryServerConfig config;
+    config.unix_path = socketPath();
+    config.max_batch = 3;
+    TelemetryServer server(config);
+    CHECK(server.start());
+
+    // 没有订阅者时发布不入队
+    server.publishSample(1.0f, 1.0f);
+    CHECK_EQ(server.getStats().published, 0u);
+
+    int fd = connectClient(config.unix_path);
+    CHECK(fd >= 0);
+    server.poll();
+    CHECK_EQ(server.getStats().clients, 1u);
+
+    for (int i = 0; i < 4; ++i) {
+        server.publishSample(0.5f, static_cast<float>(i));
+    }
+    server.publishScreenEvent(0x01, 0x02, 0x01, 7);
+    server.poll();
+
+    // 每帧最多3条记录，按发布顺序到达
+    std::vector<uint8_t> types;
+    std::vector<float> first = readFrame(fd, &types);
+    std::vector<float> second = readFrame(fd, &types);
+    CHECK(first == std::vector<float>({0.0f, 1.0f, 2.0f}));
+    CHECK(second == std::vector<float>({3.0f, 7.0f}));
+    CHECK(types.size() == 5 && types[4] == TELEMETRY_SCREEN_EVENT);
+    CHECK_EQ(server.getStats().frames_sent, 2u);
+    CHECK_EQ(server.getStats().bytes_sent, static_cast<uint64_t>(2 * TELEMETRY_FRAME_HEADER_SIZE +
+                                                                 5 * TELEMETRY_RECORD_SIZE));
+
+    // 订阅者关闭后下一次 poll 清理槽位
+    close(fd);
+    server.publishSample(0.5f, 9.0f);
+    server.poll();
+    CHECK_EQ(server.getStats().clients, 0u);
+    server.stop();
+    struct stat st;
+    CHECK(stat(config.unix_path.c_str(), &st) != 0);
+}
+
+void testFullQueueDropsOldest() {
+    TelemetryServerConfig config;
+    config.unix_path = socketPath();
+    config.queue_capacity = 4;
+    TelemetryServer server(config);
+    CHECK(server.start());
+    int fd = connectClient(config.unix_path);
+    CHECK(fd >= 0);
+    server.poll();
+
+    for (int i = 0; i < 6; ++i) {
+        server.publishSample(0.5f, static_cast<float>(i));
+    }
+    CHECK_EQ(server.getStats().dropped, 2u);
+    server.poll();
+    CHECK(readFrame(fd) == std::vector<float>({2.0f, 3.0f, 4.0f, 5.0f}));
+    close(fd);
+}
+
+void testStalledClientIsDisconnected() {
+    TelemetryServerConfig config;
+    config.unix_path = socketPath();
+    config.stall_timeout_ms = 50;
+    TelemetryServer server(config);
+    CHECK(server.start());
+    int fd = connectClient(config.unix_path);
+    CHECK(fd >= 0);
+    server.poll();
+
+    // 订阅者从不读取：套接字缓冲区写满后超过卡死时限即被断开，主循环不会被阻塞
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.getStats().clients > 0 && std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 512; ++i) {
+            server.publishSample(0.5f, static_cast<float>(i));
+        }
+        auto start = std::chrono::steady_clock::now();
+        server.poll();
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK_EQ(server.getStats().clients, 0u);
+    CHECK_EQ(server.getStats().clients_dropped, 1u);
+    close(fd);
+}
+
+void testReplacesOnlyStaleSockets() {
+    TelemetryServerConfig config;
+    config.unix_path = socketPath();
+
+    // 模拟崩溃残留：绑定后直接关闭，套接字文件留在原处
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, config.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+    CHECK(bind(stale, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    close(stale);
+    {
+        TelemetryServer server(config);
+        CHECK(server.start());
+    }
+
+    // 路径上是普通文件：不删除，启动失败
+    std::ofstream(config.unix_path) << "data";
+    TelemetryServer server(config);
+    CHECK(!server.start());
+    struct stat st;
+    CHECK(stat(config.unix_path.c_str(), &st) == 0 && S_ISREG(st.st_mode));
+    unlink(config.unix_path.c_str());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testBatchesRecordsPerClient);
+    RUN_TEST(testFullQueueDropsOldest);
+    RUN_TEST(testStalledClientIsDisconnected);
+    RUN_TEST(testReplacesOnlyStaleSockets);
+    return test_util::finish();
+}
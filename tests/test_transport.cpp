@@ -0,0 +1,144 @@
+// 传输层测试：通过内存传输层和伪终端驱动两个协议，不需要硬件
+#include "test_util.h"
+#include "test_frames.h"
+#include "memory_transport.h"
+#include "fd_transport.h"
+#include "uart_reader.h"
+#include "current_power_protocol.h"
+#include "serial_screen_protocol.h"
+#include <chrono>
+#include <unistd.h>
+
+namespace {
+
+struct PowerSink {
+    int calls = 0;
+    float current = 0.0f;
+    float power = 0.0f;
+};
+
+std::unique_ptr<CurrentPowerProtocol> makePowerProtocol(PowerSink& sink) {
+    auto protocol = std::make_unique<CurrentPowerProtocol>();
+    protocol->setVerbose(false);
+    protocol->setCurrentPowerCallback([&sink](float current, float power) {
+        ++sink.calls;
+        sink.current = current;
+        sink.power = power;
+    });
+    return protocol;
+}
+
+void testReaderOverMemoryTransport() {
+    auto transport = std::make_unique<MemoryTransport>();
+    MemoryTransport* memory = transport.get();
+    UartReader reader(std::move(transport));
+    reader.setVerbose(false);
+    PowerSink sink;
+    reader.addProtocol(makePowerProtocol(sink));
+    CHECK(reader.open());
+
+    // 帧前的噪声字节被丢弃，两帧在一次读取中解码
+    std::vector<uint8_t> bytes = {0x12, 0xAA, 0x34};
+    append(bytes, makePowerFrame(1.5f, 12.0f));
+    append(bytes, makePowerFrame(2.5f, 24.0f));
+    memory->injectRx(bytes.data(), bytes.size());
+
+    CHECK(reader.readAndParseFrame());
+    CHECK_EQ(sink.calls, 2);
+    CHECK_NEAR(sink.current, 2.5, 1e-6);
+    CHECK_NEAR(sink.power, 24.0, 1e-6);
+    CHECK_EQ(reader.getReadStats().frames, 2u);
+    CHECK_EQ(reader.getDemux().getStats().discarded_bytes, 3u);
+
+    // 断开后读取不解码，也不报错
+    memory->close();
+    CHECK(!reader.readAndParseFrame());
+}
+
+void testScreenOverMemoryTransport() {
+    auto transport = std::make_unique<MemoryTransport>("screen");
+    MemoryTransport* memory = transport.get();
+    SerialScreenProtocol screen(std::move(transport));
+    CHECK(screen.open());
+
+    // 直接发送的命令：命令字符串 + FF FF FF
+    screen.sendFloat("t5.txt", 2.999f);
+    CHECK(memory->takeTx() == makeScreenCommand("t5.txt=\"2.999\""));
+
+    // start 按键：事件回调被调用，距离和边长作为交互类命令立即写出
+    int start_events = 0;
+    screen.registerEventCallback(SerialScreenEvent::START_BUTTON, [&start_events]() { ++start_events; });
+    std::vector<uint8_t> event = makeScreenEvent(0x01, 0x02, 0x01);
+    memory->injectRx(event.data(), event.size());
+    screen.checkForSerialScreenData();
+    CHECK_EQ(start_events, 1);
+
+    std::vector<uint8_t> tx = memory->takeTx();
+    std::string sent(tx.begin(), tx.end());
+    CHECK(sent.find("t0.txt=\"") == 0);
+    CHECK(sent.find("t1.txt=\"") != std::string::npos);
+}
+
+void testTermiosReadBoundedWithVmin() {
+    PtyTransport master;
+    CHECK(master.open());
+
+    SerialSettings settings;
+    settings.read_write = true;
+    settings.vmin = 20;
+    TermiosTransport port(master.getSlavePath(), settings);
+    CHECK(port.open());
+
+    // 只到达5字节（不足 VMIN）：读操作在超时后返回已到达的字节，不会一直阻塞
+    const uint8_t partial[5] = {1, 2, 3, 4, 5};
+    CHECK_EQ(master.write(partial, sizeof(partial)), 5);
+    usleep(20000);
+    uint8_t buffer[20];
+    auto start = std::chrono::steady_clock::now();
+    int n = port.read(buffer, sizeof(buffer), 50);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    CHECK(n >= 0 && n <= 5);
+    CHECK(elapsed_ms < 500);
+
+    // 非阻塞读取也不会被 VMIN 挂起
+    start = std::chrono::steady_clock::now();
+    CHECK(port.readNonblocking(buffer, sizeof(buffer)) >= 0);
+    elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    CHECK(elapsed_ms < 100);
+}
+
+void testReaderOverPty() {
+    PtyTransport master;
+    CHECK(master.open());
+
+    SerialSettings settings;
+    settings.read_write = false;
+    settings.vmin = 20;
+    UartReader reader(std::make_unique<TermiosTransport>(master.getSlavePath(), settings));
+    reader.setVerbose(false);
+    reader.setIdleReadTimeout(200);
+    PowerSink sink;
+    reader.addProtocol(makePowerProtocol(sink));
+    CHECK(reader.open());
+
+    std::vector<uint8_t> frame = makePowerFrame(3.25f, 6.5f);
+    CHECK_EQ(master.write(frame.data(), frame.size()), 20);
+    for (int i = 0; i < 10 && sink.calls == 0; ++i) {
+        reader.readAndParseFrame();
+    }
+    CHECK_EQ(sink.calls, 1);
+    CHECK_NEAR(sink.current, 3.25, 1e-6);
+    CHECK(reader.isConnected());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testReaderOverMemoryTransport);
+    RUN_TEST(testScreenOverMemoryTransport);
+    RUN_TEST(testTermiosReadBoundedWithVmin);
+    RUN_TEST(testReaderOverPty);
+    return test_util::finish();
+}
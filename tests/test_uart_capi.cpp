@@ -0,0 +1,161 @@
+// C 接口测试：通过伪终端驱动 libuart 的 C 接口，不需要硬件
+#include "test_util.h"
+#include "test_frames.h"
+#include "uart_capi.h"
+#include "fd_transport.h"
+#include <chrono>
+#include <climits>
+#include <unistd.h>
+
+namespace {
+
+struct Sensor {
+    PtyTransport master;
+    uart_handle* handle = nullptr;
+
+    explicit Sensor(int32_t sequence_mode = UART_SEQ_AUTO) {
+        CHECK(master.open());
+        std::string path = master.getSlavePath();
+        uart_config config;
+        uart_config_init(&config);
+        config.port = path.c_str();
+        config.transport = UART_TRANSPORT_TERMIOS;
+        config.sequence_mode = sequence_mode;
+        handle = uart_open(&config);
+        CHECK(handle != nullptr);
+    }
+    ~Sensor() { uart_close(handle); }
+
+    void send(const std::vector<uint8_t>& bytes) {
+        CHECK_EQ(master.write(bytes.data(), bytes.size()), static_cast<int>(bytes.size()));
+        usleep(20000); // 等待字节经过伪终端到达从端
+    }
+};
+
+long elapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+void testConfigAndOpenErrors() {
+    CHECK_EQ(uart_abi_version(), UART_ABI_VERSION);
+    uart_config config;
+    uart_config_init(&config);
+    CHECK_EQ(config.struct_size, static_cast<uint32_t>(sizeof(uart_config)));
+    CHECK_EQ(config.baud_rate, 9600);
+    CHECK_EQ(config.sequence_mode, UART_SEQ_AUTO);
+    CHECK_EQ(config.queue_capacity, 4096u);
+
+    CHECK(uart_open(nullptr) == nullptr);
+    CHECK(uart_open(&config) == nullptr);      // 未指定串口
+    CHECK(uart_last_error()[0] != '\0');
+    config.port = "/dev/null";
+    config.transport = 7;
+    CHECK(uart_open(&config) == nullptr);
+    config.transport = UART_TRANSPORT_TERMIOS;
+    config.port = "/nonexistent/ttyUSB9";
+    CHECK(uart_open(&config) == nullptr);
+
+    uart_sample sample;
+    CHECK_EQ(uart_read_samples(nullptr, &sample, 1, 0), UART_ERR_INVALID);
+    uart_stats stats;
+    CHECK_EQ(uart_get_stats(nullptr, &stats), UART_ERR_INVALID);
+}
+
+void testReadsSamplesWithTimeout() {
+    Sensor sensor;
+    std::vector<uint8_t> bytes = makePowerFrame(1.5f, 12.0f);
+    append(bytes, makePowerFrame(2.5f, 24.0f));
+    sensor.send(bytes);
+
+    // 取满即返回，不等到超时
+    uart_sample samples[4];
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, 2, 1000), 2);
+    CHECK(elapsedMs(start) < 500);
+    CHECK_NEAR(samples[0].current, 1.5, 1e-6);
+    CHECK_NEAR(samples[1].power, 24.0, 1e-6);
+    CHECK(samples[0].timestamp_ns > 0 && samples[0].timestamp_ns <= samples[1].timestamp_ns);
+    CHECK_EQ(samples[0].flags, 0u);
+
+    // 没有数据：在超时附近返回0
+    start = std::chrono::steady_clock::now();
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, 4, 50), 0);
+    long waited = elapsedMs(start);
+    CHECK(waited >= 40 && waited < 500);
+
+    uart_stats stats;
+    CHECK_EQ(uart_get_stats(sensor.handle, &stats), UART_OK);
+    CHECK_EQ(stats.frames, 2u);
+    CHECK_EQ(stats.bytes, 40u);
+    CHECK_EQ(stats.connected, 1);
+}
+
+void testZeroTimeoutReadsOnlyWhatArrived() {
+    Sensor sensor;
+    uart_sample samples[8];
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, 8, 0), 0);
+    CHECK(elapsedMs(start) < 50);
+
+    // 两帧半：只返回完整的两帧，半帧留到下一次
+    std::vector<uint8_t> bytes = makePowerFrame(1.0f, 1.0f);
+    append(bytes, makePowerFrame(2.0f, 2.0f));
+    std::vector<uint8_t> third = makePowerFrame(3.0f, 3.0f);
+    bytes.insert(bytes.end(), third.begin(), third.begin() + 10);
+    sensor.send(bytes);
+    start = std::chrono::steady_clock::now();
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, 8, 0), 2);
+    CHECK(elapsedMs(start) < 50);
+
+    sensor.send(std::vector<uint8_t>(third.begin() + 10, third.end()));
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, 8, 0), 1);
+    CHECK_NEAR(samples[0].power, 3.0, 1e-6);
+
+    // max 超过 INT_MAX 时按 INT_MAX 处理，返回值不会溢出
+    sensor.send(makePowerFrame(4.0f, 4.0f));
+    CHECK_EQ(uart_read_samples(sensor.handle, samples, static_cast<size_t>(INT_MAX) + 10, 0), 1);
+}
+
+void testQueuesSamplesBeyondMax() {
+    Sensor sensor(UART_SEQ_EXTENDED);
+    std::vector<uint8_t> bytes;
+    for (uint32_t i = 0; i < 3; ++i) {
+        append(bytes, makePowerFrame(1.0f, static_cast<float>(i), 10 + i * 2, i * 10));
+    }
+    sensor.send(bytes);
+
+    // 一次只取一个，其余样本留在队列中按顺序取回
+    uart_sample sample;
+    for (uint32_t i = 0; i < 3; ++i) {
+        CHECK_EQ(uart_read_samples(sensor.handle, &sample, 1, 100), 1);
+        CHECK_NEAR(sample.power, static_cast<double>(i), 1e-6);
+        CHECK(sample.flags & UART_SAMPLE_HAS_SEQUENCE);
+        CHECK_EQ(sample.sequence, 10 + i * 2);
+    }
+    uart_stats stats;
+    CHECK_EQ(uart_get_stats(sensor.handle, &stats), UART_OK);
+    CHECK_EQ(stats.lost_frames, 2u);
+}
+
+void testReportsDisconnect() {
+    Sensor sensor;
+    sensor.master.close();
+    uart_sample sample;
+    CHECK_EQ(uart_read_samples(sensor.handle, &sample, 1, 50), UART_ERR_DISCONNECTED);
+    CHECK(uart_last_error()[0] != '\0');
+    uart_stats stats;
+    CHECK_EQ(uart_get_stats(sensor.handle, &stats), UART_OK);
+    CHECK_EQ(stats.connected, 0);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testConfigAndOpenErrors);
+    RUN_TEST(testReadsSamplesWithTimeout);
+    RUN_TEST(testZeroTimeoutReadsOnlyWhatArrived);
+    RUN_TEST(testQueuesSamplesBeyondMax);
+    RUN_TEST(testReportsDisconnect);
+    return test_util::finish();
+}
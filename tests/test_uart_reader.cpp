@@ -0,0 +1,177 @@
+// 接收读取器测试：按 inputWaiting 选择读取长度、一次读完积压，以及带回差的积压告警
+#include "test_util.h"
+#include "test_frames.h"
+#include "memory_transport.h"
+#include "uart_reader.h"
+#include "current_power_protocol.h"
+#include <vector>
+
+namespace {
+
+// 记录每次读取请求的内存传输层；可以让下一次 inputWaiting() 报告0，模拟数据在查询之后才到达
+class RecordingTransport : public MemoryTransport {
+public:
+    struct Read {
+        size_t n;
+        bool blocking;
+        unsigned int timeout_ms;
+        bool operator==(const Read& other) const {
+            return n == other.n && blocking == other.blocking && timeout_ms == other.timeout_ms;
+        }
+    };
+    std::vector<Read> reads;
+    bool hide_next_waiting = false;
+
+    int read(uint8_t* buffer, size_t n, unsigned int timeout_ms) override {
+        reads.push_back({n, true, timeout_ms});
+        // 基类的阻塞读取转调 readNonblocking，不要重复记录
+        return MemoryTransport::readNonblocking(buffer, n);
+    }
+    int readNonblocking(uint8_t* buffer, size_t n) override {
+        reads.push_back({n, false, 0});
+        return MemoryTransport::readNonblocking(buffer, n);
+    }
+    int inputWaiting() override {
+        if (hide_next_waiting) {
+            hide_next_waiting = false;
+            return 0;
+        }
+        return MemoryTransport::inputWaiting();
+    }
+};
+
+struct Fixture {
+    RecordingTransport* transport;
+    UartReader reader;
+    int frames = 0;
+
+    Fixture() : Fixture(std::make_unique<RecordingTransport>()) {}
+
+    explicit Fixture(std::unique_ptr<RecordingTransport> owned)
+        : transport(owned.get()), reader(std::move(owned)) {
+        reader.setVerbose(false);
+        auto protocol = std::make_unique<CurrentPowerProtocol>();
+        protocol->setVerbose(false);
+        protocol->setCurrentPowerCallback([this](float, float) { ++frames; });
+        reader.addProtocol(std::move(protocol));
+        reader.open();
+        transport->reads.clear();
+    }
+
+    void inject(size_t frame_count) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < frame_count; ++i) {
+            append(bytes, makePowerFrame(1.0f, static_cast<float>(i)));
+        }
+        transport->injectRx(bytes.data(), bytes.size());
+    }
+};
+
+using Read = RecordingTransport::Read;
+
+void testIdleReadWaitsForOneByte() {
+    Fixture f;
+    CHECK(!f.reader.readAndParseFrame(37));
+    CHECK(f.transport->reads == std::vector<Read>({{1, true, 37}}));
+    CHECK_EQ(f.reader.getReadStats().reads, 0u);
+    CHECK_EQ(f.reader.getReadStats().last_backlog, 0u);
+}
+
+void testFirstByteThenRestOfFrame() {
+    // 第一个字节到达时其余部分已在缓冲区：非阻塞读出其余19字节
+    Fixture f;
+    f.inject(1);
+    f.transport->hide_next_waiting = true;
+    CHECK(f.reader.readAndParseFrame(50));
+    CHECK(f.transport->reads == std::vector<Read>({{1, true, 50}, {19, false, 0}}));
+    CHECK_EQ(f.frames, 1);
+
+    // 其余部分还在线路上：按帧大小等待，而不是逐字节读取
+    std::vector<uint8_t> frame = makePowerFrame(2.0f, 4.0f);
+    f.transport->injectRx(frame.data(), 10);
+    f.transport->hide_next_waiting = true;
+    f.transport->reads.clear();
+    CHECK(!f.reader.readAndParseFrame(50));
+    CHECK(f.transport->reads == std::vector<Read>({{1, true, 50}, {19, true, 100}}));
+    f.transport->injectRx(frame.data() + 10, 10);
+    CHECK(f.reader.readAndParseFrame(50));
+    CHECK_EQ(f.frames, 2);
+}
+
+void testBacklogDrainedInOneRead() {
+    Fixture f;
+    f.inject(3);
+    CHECK(f.reader.readAndParseFrame());
+    CHECK(f.transport->reads == std::vector<Read>({{60, false, 0}}));
+    CHECK_EQ(f.frames, 3);
+    const UartReader::ReadStats& stats = f.reader.getReadStats();
+    CHECK_EQ(stats.reads, 1u);
+    CHECK_EQ(stats.bytes, 60u);
+    CHECK_EQ(stats.frames, 3u);
+    CHECK_EQ(stats.drain_reads, 1u);
+    CHECK_EQ(stats.last_backlog, 60u);
+
+    // 积压超过接收缓冲区时每次最多读一个缓冲区
+    f.inject(250);
+    f.transport->reads.clear();
+    CHECK(f.reader.readAndParseFrame());
+    CHECK(f.reader.readAndParseFrame());
+    CHECK(f.transport->reads == std::vector<Read>({{4096, false, 0}, {904, false, 0}}));
+    CHECK_EQ(f.frames, 253);
+    CHECK_EQ(f.reader.getReadStats().backlog_high_water, 5000u);
+
+    // 单帧读取不计为多帧读取
+    f.inject(1);
+    CHECK(f.reader.readAndParseFrame());
+    CHECK_EQ(f.reader.getReadStats().drain_reads, 3u);
+}
+
+void testReadPendingLimitsLength() {
+    Fixture f;
+    f.inject(4);
+    CHECK_EQ(f.reader.readPending(30), 30);
+    CHECK_EQ(f.reader.readPending(0), 0);
+    CHECK_EQ(f.reader.readPending(1000), 50);
+    CHECK(f.transport->reads == std::vector<Read>({{30, false, 0}, {1000, false, 0}}));
+    CHECK_EQ(f.frames, 4);
+}
+
+void testBacklogAlarmHysteresis() {
+    Fixture f;
+    f.reader.setBacklogAlarm(100);
+
+    f.inject(6);                        // 120 字节：超过阈值，告警一次
+    f.reader.readAndParseFrame();
+    CHECK_EQ(f.reader.getReadStats().backlog_alarms, 1u);
+
+    f.inject(3);                        // 60 字节：仍高于阈值的一半，不重新告警
+    f.reader.readAndParseFrame();
+    f.inject(6);
+    f.reader.readAndParseFrame();
+    CHECK_EQ(f.reader.getReadStats().backlog_alarms, 1u);
+
+    f.inject(2);                        // 40 字节：低于一半，解除告警
+    f.reader.readAndParseFrame();
+    f.inject(5);                        // 100 字节：再次达到阈值
+    f.reader.readAndParseFrame();
+    CHECK_EQ(f.reader.getReadStats().backlog_alarms, 2u);
+    CHECK_EQ(f.reader.getReadStats().backlog_high_water, 120u);
+
+    // 空闲读取记为积压0，同样解除告警
+    f.reader.readAndParseFrame(1);
+    f.inject(5);
+    f.reader.readAndParseFrame();
+    CHECK_EQ(f.reader.getReadStats().backlog_alarms, 3u);
+    CHECK_EQ(f.frames, 27);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testIdleReadWaitsForOneByte);
+    RUN_TEST(testFirstByteThenRestOfFrame);
+    RUN_TEST(testBacklogDrainedInOneRead);
+    RUN_TEST(testReadPendingLimitsLength);
+    RUN_TEST(testBacklogAlarmHysteresis);
+    return test_util::finish();
+}
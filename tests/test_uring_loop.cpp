@@ -0,0 +1,153 @@
+// io_uring 事件循环测试：常驻读请求、批量写、缓冲区上限、挂断和端口槽位复用
+#include "test_util.h"
+#include "fd_transport.h"
+#include "uring_loop.h"
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct PtyPair {
+    PtyTransport master;
+    std::unique_ptr<TermiosTransport> slave;
+
+    bool open() {
+        if (!master.open()) {
+            return false;
+        }
+        SerialSettings settings;
+        settings.read_write = true;
+        slave = std::make_unique<TermiosTransport>(master.getSlavePath(), settings);
+        return slave->open();
+    }
+};
+
+// 内核不支持 io_uring（或被 seccomp 禁用）时跳过，由调用者改用 epoll
+bool available(const UringLoop& ring) {
+    if (!ring.isValid()) {
+        std::cout << "io_uring 不可用，跳过" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void runUntil(UringLoop& ring, const std::function<bool()>& done) {
+    for (int i = 0; i < 50 && !done(); ++i) {
+        ring.runOnce(20);
+    }
+}
+
+void testDeliversReadsToHandler() {
+    UringLoop ring(2, 256);
+    if (!available(ring)) {
+        return;
+    }
+    PtyPair pty;
+    CHECK(pty.open());
+
+    std::vector<uint8_t> received;
+    int errors = 0;
+    int port = ring.addPort(pty.slave->getFileDescriptor(),
+        [&received](const uint8_t* data, size_t length) { received.insert(received.end(), data, data + length); },
+        [&errors]() { ++errors; });
+    CHECK(port >= 0);
+
+    // 读请求完成后立即重新投递，连续两次到达的数据都能收到
+    const uint8_t first[] = {0xAA, 0xAA, 0x01};
+    const uint8_t second[] = {0x02, 0x55, 0x55};
+    CHECK_EQ(pty.master.write(first, sizeof(first)), 3);
+    runUntil(ring, [&received]() { return received.size() >= 3; });
+    CHECK_EQ(pty.master.write(second, sizeof(second)), 3);
+    runUntil(ring, [&received]() { return received.size() >= 6; });
+
+    CHECK(received == std::vector<uint8_t>({0xAA, 0xAA, 0x01, 0x02, 0x55, 0x55}));
+    CHECK_EQ(ring.getStats().bytes_read, 6u);
+    CHECK(ring.getStats().read_completions >= 2);
+    CHECK_EQ(errors, 0);
+    ring.removePort(port);
+}
+
+void testBatchesQueuedWrites() {
+    UringLoop ring(2, 64);
+    if (!available(ring)) {
+        return;
+    }
+    PtyPair pty;
+    CHECK(pty.open());
+    int port = ring.addPort(pty.slave->getFileDescriptor(), [](const uint8_t*, size_t) {}, []() {});
+    CHECK(port >= 0);
+
+    // 两条命令在同一次 runOnce 中合并为一个写请求
+    const uint8_t a[] = {'a', 'b', 'c'};
+    const uint8_t b[] = {'d', 'e', 'f'};
+    CHECK_EQ(ring.queueWrite(port, a, sizeof(a)), 3u);
+    CHECK_EQ(ring.queueWrite(port, b, sizeof(b)), 3u);
+    CHECK_EQ(ring.pendingWrite(port), 6u);
+    runUntil(ring, [&ring, port]() { return ring.pendingWrite(port) == 0; });
+    CHECK_EQ(ring.getStats().writes_submitted, 1u);
+    CHECK_EQ(ring.getStats().bytes_written, 6u);
+
+    uint8_t buffer[16];
+    int n = pty.master.read(buffer, 6, 200);
+    CHECK_EQ(n, 6);
+    CHECK(std::vector<uint8_t>(buffer, buffer + 6) == std::vector<uint8_t>({'a', 'b', 'c', 'd', 'e', 'f'}));
+
+    // 发送缓冲区满时只接受放得下的部分
+    std::vector<uint8_t> big(100, 'x');
+    CHECK_EQ(ring.queueWrite(port, big.data(), big.size()), 64u);
+    CHECK_EQ(ring.queueWrite(port, big.data(), big.size()), 0u);
+    ring.removePort(port);
+}
+
+void testHangupReportsErrorAndFreesSlot() {
+    UringLoop ring(1, 64);
+    if (!available(ring)) {
+        return;
+    }
+    auto pty = std::make_unique<PtyPair>();
+    CHECK(pty->open());
+
+    int port = -1;
+    int errors = 0;
+    port = ring.addPort(pty->slave->getFileDescriptor(), [](const uint8_t*, size_t) {},
+        [&ring, &port, &errors]() {
+            ++errors;
+            ring.removePort(port);
+        });
+    CHECK(port >= 0);
+
+    // 只有一个槽位：端口在用时不能再注册
+    PtyPair other;
+    CHECK(other.open());
+    CHECK_EQ(ring.addPort(other.slave->getFileDescriptor(), [](const uint8_t*, size_t) {}, []() {}), -1);
+
+    // 主端关闭后从端读请求以挂断完成：错误回调移除端口，槽位可以复用
+    pty->master.close();
+    runUntil(ring, [&errors]() { return errors > 0; });
+    CHECK_EQ(errors, 1);
+    CHECK(ring.getStats().errors >= 1);
+    CHECK_EQ(ring.queueWrite(port, reinterpret_cast<const uint8_t*>("x"), 1), 0u);
+    int reused = ring.addPort(other.slave->getFileDescriptor(), [](const uint8_t*, size_t) {}, []() {});
+    CHECK_EQ(reused, 0);
+    ring.removePort(reused);
+}
+
+void testRejectsInvalidPorts() {
+    UringLoop ring(1, 64);
+    const uint8_t byte = 0;
+    CHECK_EQ(ring.queueWrite(-1, &byte, 1), 0u);
+    CHECK_EQ(ring.queueWrite(5, &byte, 1), 0u);
+    CHECK_EQ(ring.pendingWrite(5), 0u);
+    CHECK_EQ(ring.addPort(-1, [](const uint8_t*, size_t) {}, []() {}), -1);
+    ring.removePort(3);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testDeliversReadsToHandler);
+    RUN_TEST(testBatchesQueuedWrites);
+    RUN_TEST(testHangupReportsErrorAndFreesSlot);
+    RUN_TEST(testRejectsInvalidPorts);
+    return test_util::finish();
+}
@@ -0,0 +1,70 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// 最小测试工具：每个测试文件编译为一个可执行程序，由 ctest 运行，有检查失败时返回非零。
+// 不依赖第三方测试框架，只需要 CMake 和编译器。
+
+namespace test_util {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const std::string& message) {
+    std::cerr << file << ":" << line << ": 检查失败: " << message << std::endl;
+    ++failures();
+}
+
+// 运行一个测试函数并打印名称
+template<typename F>
+void run(const char* name, F test) {
+    int before = failures();
+    test();
+    std::cout << (failures() == before ? "[通过] " : "[失败] ") << name << std::endl;
+}
+
+inline int finish() {
+    if (failures() > 0) {
+        std::cerr << "共 " << failures() << " 项检查失败" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace test_util
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            test_util::fail(__FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto check_actual_ = (actual); \
+        auto check_expected_ = (expected); \
+        if (!(check_actual_ == check_expected_)) { \
+            test_util::fail(__FILE__, __LINE__, std::string(#actual " == " #expected "，实际值 ") + \
+                            std::to_string(check_actual_) + "，期望值 " + std::to_string(check_expected_)); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double check_actual_ = (actual); \
+        double check_expected_ = (expected); \
+        if (std::fabs(check_actual_ - check_expected_) > (tolerance)) { \
+            test_util::fail(__FILE__, __LINE__, std::string(#actual " ≈ " #expected "，实际值 ") + \
+                            std::to_string(check_actual_) + "，期望值 " + std::to_string(check_expected_)); \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) test_util::run(#test, test)
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,92 @@
+#include "serial_screen_emulator.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <atomic>
+
+// 串口屏模拟器命令行工具
+// 用法: screen_emulator [--link 路径] [--script 脚本文件] [--once] [--duration 秒]
+//                       [--report-interval 秒] [--fail-on-malformed]
+// 未指定脚本时每秒注入一次 start 按键，并以 t0.txt 作为期望响应。
+
+static std::atomic<bool> running(true);
+
+static void handleSignal(int) {
+    running = false;
+}
+
+int main(int argc, char* argv[]) {
+    std::string link_path;
+    std::string script_path;
+    bool repeat = true;
+    double duration_s = 0.0;         // 0 表示一直运行直到收到信号
+    double report_interval_s = 0.0;  // 0 表示只在退出时打印
+    bool fail_on_malformed = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--link" && i + 1 < argc) {
+            link_path = argv[++i];
+        } else if (arg == "--script" && i + 1 < argc) {
+            script_path = argv[++i];
+        } else if (arg == "--once") {
+            repeat = false;
+        } else if (arg == "--duration" && i + 1 < argc) {
+            duration_s = std::atof(argv[++i]);
+        } else if (arg == "--report-interval" && i + 1 < argc) {
+            report_interval_s = std::atof(argv[++i]);
+        } else if (arg == "--fail-on-malformed") {
+            fail_on_malformed = true;
+        } else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<ScreenScriptStep> steps;
+    if (!script_path.empty()) {
+        if (!SerialScreenEmulator::loadScript(script_path, steps)) {
+            return 2;
+        }
+    } else {
+        ScreenScriptStep start;
+        start.expect_widget = "t0.txt";
+        steps.push_back(start);
+    }
+
+    SerialScreenEmulator emulator;
+    if (!emulator.open(link_path)) {
+        return 1;
+    }
+    emulator.setScript(steps, repeat);
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto last_report = start_time;
+    while (running) {
+        emulator.poll(10);
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - start_time).count();
+        if (duration_s > 0.0 && elapsed >= duration_s) {
+            break;
+        }
+        if (report_interval_s > 0.0 &&
+            std::chrono::duration<double>(now - last_report).count() >= report_interval_s) {
+            emulator.printReport(elapsed);
+            last_report = now;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    emulator.printReport(elapsed);
+
+    if (fail_on_malformed && emulator.getStats().malformed > 0) {
+        return 1;
+    }
+    return 0;
+}
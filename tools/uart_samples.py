@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""通过 libuart 的 C 接口批量读取电流功率样本（ctypes 示例）
+
+用法: uart_samples.py 串口 [--lib libuart.so] [--batch 256] [--timeout-ms 100] [--duration 秒] [--termios]
+每次调用 uart_read_samples() 取回一批样本，每秒打印一次样本速率、每次调用的平均样本数和最新样本。
+"""
+
+import argparse
+import ctypes
+import time
+
+
+class UartConfig(ctypes.Structure):
+    _fields_ = [
+        ("struct_size", ctypes.c_uint32),
+        ("port", ctypes.c_char_p),
+        ("baud_rate", ctypes.c_int32),
+        ("transport", ctypes.c_int32),
+        ("sequence_mode", ctypes.c_int32),
+        ("tick_hz", ctypes.c_double),
+        ("queue_capacity", ctypes.c_uint32),
+    ]
+
+
+class UartSample(ctypes.Structure):
+    _fields_ = [
+        ("timestamp_ns", ctypes.c_uint64),
+        ("current", ctypes.c_float),
+        ("power", ctypes.c_float),
+        ("sequence", ctypes.c_uint32),
+        ("flags", ctypes.c_uint32),
+    ]
+
+
+class UartStats(ctypes.Structure):
+    _fields_ = [
+        ("frames", ctypes.c_uint64),
+        ("samples_dropped", ctypes.c_uint64),
+        ("lost_frames", ctypes.c_uint64),
+        ("bytes", ctypes.c_uint64),
+        ("reconnects", ctypes.c_uint64),
+        ("overruns", ctypes.c_int64),
+        ("connected", ctypes.c_int32),
+        ("reserved", ctypes.c_int32),
+    ]
+
+
+UART_ABI_VERSION = 1
+UART_TRANSPORT_TERMIOS = 1
+UART_SAMPLE_HAS_SEQUENCE = 0x1
+
+
+def load(path):
+    lib = ctypes.CDLL(path)
+    lib.uart_abi_version.restype = ctypes.c_int
+    lib.uart_config_init.argtypes = [ctypes.POINTER(UartConfig)]
+    lib.uart_open.argtypes = [ctypes.POINTER(UartConfig)]
+    lib.uart_open.restype = ctypes.c_void_p
+    lib.uart_read_samples.argtypes = [ctypes.c_void_p, ctypes.POINTER(UartSample), ctypes.c_size_t, ctypes.c_int]
+    lib.uart_read_samples.restype = ctypes.c_int
+    lib.uart_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(UartStats)]
+    lib.uart_close.argtypes = [ctypes.c_void_p]
+    lib.uart_last_error.restype = ctypes.c_char_p
+    if lib.uart_abi_version() != UART_ABI_VERSION:
+        raise RuntimeError("libuart ABI 版本不匹配: %d" % lib.uart_abi_version())
+    return lib
+
+
+def main():
+    parser = argparse.ArgumentParser(description="通过 libuart 批量读取电流功率样本")
+    parser.add_argument("port")
+    parser.add_argument("--lib", default="libuart.so")
+    parser.add_argument("--batch", type=int, default=256)
+    parser.add_argument("--timeout-ms", type=int, default=100)
+    parser.add_argument("--duration", type=float, default=0.0, help="运行秒数，0 表示一直运行")
+    parser.add_argument("--termios", action="store_true", help="使用 termios 传输层")
+    args = parser.parse_args()
+
+    lib = load(args.lib)
+    config = UartConfig()
+    lib.uart_config_init(ctypes.byref(config))
+    config.port = args.port.encode()
+    if args.termios:
+        config.transport = UART_TRANSPORT_TERMIOS
+    handle = lib.uart_open(ctypes.byref(config))
+    if not handle:
+        raise SystemExit("打开失败: " + lib.uart_last_error().decode())
+
+    buffer = (UartSample * args.batch)()
+    start = time.monotonic()
+    last_report = start
+    samples = calls = 0
+    latest = None
+    try:
+        while args.duration <= 0 or time.monotonic() - start < args.duration:
+            n = lib.uart_read_samples(handle, buffer, args.batch, args.timeout_ms)
+            calls += 1
+            if n > 0:
+                samples += n
+                latest = buffer[n - 1]
+            now = time.monotonic()
+            if now - last_report >= 1.0:
+                stats = UartStats()
+                lib.uart_get_stats(handle, ctypes.byref(stats))
+                line = "%.0f 样本/s, 每次调用 %.1f 个, 丢帧 %d, 队列丢弃 %d" % (
+                    samples / (now - last_report), samples / calls if calls else 0.0,
+                    stats.lost_frames, stats.samples_dropped)
+                if latest is not None:
+                    line += ", 最新 I=%.3f A P=%.3f W" % (latest.current, latest.power)
+                    if latest.flags & UART_SAMPLE_HAS_SEQUENCE:
+                        line += " 序号=%d" % latest.sequence
+                print(line, flush=True)
+                last_report = now
+                samples = calls = 0
+    except KeyboardInterrupt:
+        pass
+    finally:
+        lib.uart_close(handle)
+
+
+if __name__ == "__main__":
+    main()
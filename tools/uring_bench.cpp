@@ -0,0 +1,265 @@
+#include "uring_loop.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// io_uring 与 epoll 接收路径对比测试（基于伪终端，无需硬件）
+// 用法: uring_bench [--ports N] [--frames N] [--rate 帧/秒] [--mode epoll|uring|both]
+// 每个端口由发送子进程按固定速率写入20字节电流功率帧，本进程分别用 epoll（就绪后读到EAGAIN，
+// 与协程模式的 AsyncPort 相同）和 io_uring（常驻读请求）接收，比较每帧系统调用次数和CPU时间。
+// CPU时间取本进程的 RUSAGE_SELF：包含 io_uring 替接收端执行读操作的 io-wq 内核工作线程
+// （RUSAGE_THREAD 只统计调用线程，会低估 io_uring 的开销），发送端在另一个进程中，不计入。
+
+namespace {
+
+const size_t FRAME_SIZE = 20;
+
+struct PtyPair {
+    int master = -1;
+    int slave = -1;
+};
+
+bool openPtyPair(PtyPair& pair) {
+    pair.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pair.master < 0 || grantpt(pair.master) != 0 || unlockpt(pair.master) != 0) {
+        return false;
+    }
+    const char* name = ptsname(pair.master);
+    if (!name) {
+        return false;
+    }
+    pair.slave = ::open(name, O_RDWR | O_NOCTTY);
+    if (pair.slave < 0) {
+        return false;
+    }
+    struct termios tio;
+    if (tcgetattr(pair.slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(pair.slave, TCSANOW, &tio);
+    }
+    return true;
+}
+
+void closePtyPair(PtyPair& pair) {
+    if (pair.slave >= 0) {
+        ::close(pair.slave);
+    }
+    if (pair.master >= 0) {
+        ::close(pair.master);
+    }
+    pair.master = pair.slave = -1;
+}
+
+// 本进程（接收循环及其 io-wq 工作线程，包括已退出的）累计CPU时间
+double processCpuUs() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec * 1e6 + usage.ru_utime.tv_usec +
+           usage.ru_stime.tv_sec * 1e6 + usage.ru_stime.tv_usec;
+}
+
+// 发送端：按速率向每个端口写帧
+void sendFrames(const std::vector<PtyPair>& pairs, size_t frames, int rate) {
+    uint8_t frame[FRAME_SIZE] = {0xAA, 0xAA};
+    frame[FRAME_SIZE - 2] = 0xFF;
+    frame[FRAME_SIZE - 1] = 0xFF;
+    auto interval = std::chrono::nanoseconds(rate > 0 ? 1000000000LL / rate : 0);
+    auto next = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < frames; ++i) {
+        for (const auto& pair : pairs) {
+            size_t written = 0;
+            while (written < FRAME_SIZE) {
+                ssize_t n = ::write(pair.master, frame + written, FRAME_SIZE - written);
+                if (n > 0) {
+                    written += static_cast<size_t>(n);
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        }
+        if (rate > 0) {
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+// 在子进程中运行发送端，返回子进程号
+pid_t startSender(const std::vector<PtyPair>& pairs, size_t frames, int rate) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        sendFrames(pairs, frames, rate);
+        _exit(0);
+    }
+    return pid;
+}
+
+// 接收结束（或超时）后停止发送子进程
+void stopSender(pid_t pid) {
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+struct Result {
+    uint64_t bytes = 0;
+    uint64_t syscalls = 0;
+    double cpu_us = 0.0;
+    double elapsed_s = 0.0;
+};
+
+Result runEpoll(std::vector<PtyPair>& pairs, size_t frames, int rate) {
+    Result result;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    for (auto& pair : pairs) {
+        int flags = fcntl(pair.slave, F_GETFL, 0);
+        fcntl(pair.slave, F_SETFL, flags | O_NONBLOCK);
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = pair.slave;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, pair.slave, &ev);
+    }
+
+    const uint64_t expected = static_cast<uint64_t>(pairs.size()) * frames * FRAME_SIZE;
+    double cpu_start = processCpuUs();
+    auto start = std::chrono::steady_clock::now();
+    pid_t sender = startSender(pairs, frames, rate);
+
+    std::vector<struct epoll_event> events(pairs.size());
+    uint8_t buffer[4096];
+    while (result.bytes < expected) {
+        int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), 1000);
+        ++result.syscalls;
+        if (n <= 0) {
+            break; // 超时：发送已结束但数据不完整
+        }
+        for (int i = 0; i < n; ++i) {
+            while (true) {
+                ssize_t r = ::read(events[i].data.fd, buffer, sizeof(buffer));
+                ++result.syscalls;
+                if (r <= 0) {
+                    break;
+                }
+                result.bytes += static_cast<uint64_t>(r);
+            }
+        }
+    }
+
+    result.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpu_us = processCpuUs() - cpu_start;
+    stopSender(sender);
+    ::close(epfd);
+    return result;
+}
+
+Result runUring(std::vector<PtyPair>& pairs, size_t frames, int rate) {
+    Result result;
+    UringLoop loop(pairs.size());
+    if (!loop.isValid()) {
+        return result;
+    }
+    bool failed = false;
+    for (auto& pair : pairs) {
+        loop.addPort(pair.slave,
+                     [&result](const uint8_t*, size_t length) { result.bytes += length; },
+                     [&failed]() { failed = true; });
+    }
+
+    const uint64_t expected = static_cast<uint64_t>(pairs.size()) * frames * FRAME_SIZE;
+    double cpu_start = processCpuUs();
+    uint64_t enters_start = loop.getStats().enters;
+    auto start = std::chrono::steady_clock::now();
+    pid_t sender = startSender(pairs, frames, rate);
+
+    while (result.bytes < expected && !failed) {
+        if (loop.runOnce(1000) == 0) {
+            break;
+        }
+    }
+
+    result.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpu_us = processCpuUs() - cpu_start;
+    result.syscalls = loop.getStats().enters - enters_start;
+    stopSender(sender);
+    return result;
+}
+
+void printResult(const char* name, const Result& result, size_t ports, size_t frames) {
+    double total_frames = static_cast<double>(result.bytes) / FRAME_SIZE;
+    double expected = static_cast<double>(ports * frames);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << name << ": 接收 " << static_cast<uint64_t>(total_frames) << "/" << static_cast<uint64_t>(expected)
+              << " 帧, 耗时 " << result.elapsed_s << " s" << std::endl;
+    if (total_frames > 0) {
+        std::cout << "  系统调用/帧: " << result.syscalls / total_frames
+                  << "  CPU/帧: " << result.cpu_us / total_frames << " us"
+                  << "  (系统调用 " << result.syscalls << ", CPU " << result.cpu_us / 1000.0 << " ms)" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t ports = 8;
+    size_t frames = 5000;
+    int rate = 1000;
+    std::string mode = "both";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ports" && i + 1 < argc) {
+            ports = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate = std::atoi(argv[++i]);
+        } else if (arg == "--mode" && i + 1 < argc) {
+            mode = argv[++i];
+        } else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::cout << "端口: " << ports << " 每端口帧数: " << frames << " 速率: " << rate << " 帧/秒/端口" << std::endl;
+
+    for (const char* backend : {"epoll", "uring"}) {
+        if (mode != "both" && mode != backend) {
+            continue;
+        }
+        std::vector<PtyPair> pairs(ports);
+        bool ok = true;
+        for (auto& pair : pairs) {
+            ok = ok && openPtyPair(pair);
+        }
+        if (!ok) {
+            std::cerr << "无法创建伪终端: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        Result result = std::string(backend) == "epoll" ? runEpoll(pairs, frames, rate)
+                                                        : runUring(pairs, frames, rate);
+        printResult(backend, result, ports, frames);
+        for (auto& pair : pairs) {
+            closePtyPair(pair);
+        }
+    }
+    return 0;
+}